@@ -10,10 +10,16 @@
 #include "mbedtls/md.h"
 #include "wManager.h"
 #include "mining.h"
+#include "stratumProxy.h"
+#include "stratumCapture.h"
+#include "metricsServer.h"
+#include "logger.h"
+#include "serialConsole.h"
+#include "taskProfiler.h"
 #include "monitor.h"
 #include "drivers/displays/display.h"
 #include "drivers/storage/SDCard.h"
-#include "ShaTests/nerdSHA_HWTest.h"
+#include "ShaTests/shaBenchmark.h"
 #include "timeconst.h"
 
 #ifdef TOUCH_ENABLE
@@ -21,7 +27,6 @@
 #endif
 
 #include <soc/soc_caps.h>
-//#define HW_SHA256_TEST
 
 //3 seconds WDT
 #define WDT_TIMEOUT 3
@@ -79,10 +84,6 @@ void setup()
   disableCore0WDT();
   //disableCore1WDT();
 
-#ifdef HW_SHA256_TEST
-  while (1) HwShaTest();
-#endif
-
   // Setup the buttons
   #if defined(PIN_BUTTON_1) && !defined(PIN_BUTTON_2) //One button device
     button1.setPressMs(5*SECOND_MS);
@@ -114,6 +115,11 @@ void setup()
   drawLoadingScreen();
   delay(2*SECOND_MS);
 
+  #ifdef SHA_BENCHMARK
+  /******** SHA BENCHMARK, AT BOOT OR ASKED FROM THE CONSOLE *****/
+  sha_benchmark_boot();
+  #endif
+
   /******** SHOW LED INIT STATUS (devices without screen) *****/
   mMonitor.NerdStatus = NM_waitingConfig;
   doLedStuff(0);
@@ -130,6 +136,14 @@ void setup()
   // Higher prio monitor task
   Serial.println("");
   Serial.println("Initiating tasks...");
+  /******** SERIAL LOGS LEAVE THE MINING TASKS *****/
+  logger_setup();
+  #ifdef SERIAL_CONSOLE
+  console_setup();
+  #endif
+  #ifdef TASK_PROFILER
+  profiler_setup();
+  #endif
   static const char monitor_name[] = "(Monitor)";
   #if defined(CONFIG_IDF_TARGET_ESP32)
   // Increased stack for ESP32 classic due to NVS operations  
@@ -138,6 +152,21 @@ void setup()
   BaseType_t res1 = xTaskCreatePinnedToCore(runMonitor, "Monitor", 10000, (void*)monitor_name, 5, NULL,1);
   #endif
 
+  #ifdef STRATUM_PROXY_PORT
+  /******** LOCAL STRATUM PROXY, SERVED BY THE STRATUM TASK *****/
+  proxy_setup(STRATUM_PROXY_PORT);
+  #endif
+
+  #ifdef METRICS_PORT
+  /******** PROMETHEUS /metrics, LOW PRIORITY TASK *****/
+  metrics_setup(METRICS_PORT);
+  #endif
+
+  #ifdef STRATUM_CAPTURE
+  /******** RECORD THE POOL SESSION (SPIFFS: "/spiffs/...", SD card: "/sd/...") *****/
+  capture_setup(STRATUM_CAPTURE);
+  #endif
+
   /******** CREATE STRATUM TASK *****/
   static const char stratum_name[] = "(Stratum)";
  #if defined(CONFIG_IDF_TARGET_ESP32) && !defined(ESP32_2432S028R) && !defined(ESP32_2432S028_2USB)
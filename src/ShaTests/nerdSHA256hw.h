@@ -0,0 +1,281 @@
+#ifndef nerdSHA256hw_H_
+#define nerdSHA256hw_H_
+
+/************************************************************************************
+*   Register level helpers of the SHA engine, shared by the hardware miner task and
+*   the benchmark (ShaTests/shaBenchmark.cpp) so both time the same kernel.
+*
+*   ESP32-S2, S3, C3: the midstate is written back to the H registers and the inner
+*   hash stays in the engine. ESP32: no H registers to write, the whole header goes
+*   through the text registers, words swapped.
+*************************************************************************************/
+
+#include <Arduino.h>
+#include <soc/soc.h>
+#include <sha/sha_dma.h>
+#include <hal/sha_hal.h>
+#include <hal/sha_ll.h>
+
+#if defined(CONFIG_IDF_TARGET_ESP32S2) || defined(CONFIG_IDF_TARGET_ESP32S3) || defined(CONFIG_IDF_TARGET_ESP32C3)
+
+static inline void nerd_sha_ll_fill_text_block_sha256(const void *input_text, uint32_t nonce)
+{
+    uint32_t *data_words = (uint32_t *)input_text;
+    uint32_t *reg_addr_buf = (uint32_t *)(SHA_TEXT_BASE);
+
+    REG_WRITE(&reg_addr_buf[0], data_words[0]);
+    REG_WRITE(&reg_addr_buf[1], data_words[1]);
+    REG_WRITE(&reg_addr_buf[2], data_words[2]);
+#if 0
+    REG_WRITE(&reg_addr_buf[3], nonce);
+    //REG_WRITE(&reg_addr_buf[3], data_words[3]);    
+    REG_WRITE(&reg_addr_buf[4], data_words[4]);
+    REG_WRITE(&reg_addr_buf[5], data_words[5]);
+    REG_WRITE(&reg_addr_buf[6], data_words[6]);
+    REG_WRITE(&reg_addr_buf[7], data_words[7]);
+    REG_WRITE(&reg_addr_buf[8], data_words[8]);
+    REG_WRITE(&reg_addr_buf[9], data_words[9]);
+    REG_WRITE(&reg_addr_buf[10], data_words[10]);
+    REG_WRITE(&reg_addr_buf[11], data_words[11]);
+    REG_WRITE(&reg_addr_buf[12], data_words[12]);
+    REG_WRITE(&reg_addr_buf[13], data_words[13]);
+    REG_WRITE(&reg_addr_buf[14], data_words[14]);
+    REG_WRITE(&reg_addr_buf[15], data_words[15]);
+#else
+    REG_WRITE(&reg_addr_buf[3], nonce);
+    REG_WRITE(&reg_addr_buf[4], 0x00000080);
+    REG_WRITE(&reg_addr_buf[5], 0x00000000);
+    REG_WRITE(&reg_addr_buf[6], 0x00000000);
+    REG_WRITE(&reg_addr_buf[7], 0x00000000);
+    REG_WRITE(&reg_addr_buf[8], 0x00000000);
+    REG_WRITE(&reg_addr_buf[9], 0x00000000);
+    REG_WRITE(&reg_addr_buf[10], 0x00000000);
+    REG_WRITE(&reg_addr_buf[11], 0x00000000);
+    REG_WRITE(&reg_addr_buf[12], 0x00000000);
+    REG_WRITE(&reg_addr_buf[13], 0x00000000);
+    REG_WRITE(&reg_addr_buf[14], 0x00000000);
+    REG_WRITE(&reg_addr_buf[15], 0x80020000);
+#endif
+}
+
+static inline void nerd_sha_ll_fill_text_block_sha256_inter()
+{
+  uint32_t *reg_addr_buf = (uint32_t *)(SHA_TEXT_BASE);
+
+  DPORT_INTERRUPT_DISABLE();
+  REG_WRITE(&reg_addr_buf[0], DPORT_SEQUENCE_REG_READ(SHA_H_BASE + 0 * 4));
+  REG_WRITE(&reg_addr_buf[1], DPORT_SEQUENCE_REG_READ(SHA_H_BASE + 1 * 4));
+  REG_WRITE(&reg_addr_buf[2], DPORT_SEQUENCE_REG_READ(SHA_H_BASE + 2 * 4));
+  REG_WRITE(&reg_addr_buf[3], DPORT_SEQUENCE_REG_READ(SHA_H_BASE + 3 * 4));
+  REG_WRITE(&reg_addr_buf[4], DPORT_SEQUENCE_REG_READ(SHA_H_BASE + 4 * 4));
+  REG_WRITE(&reg_addr_buf[5], DPORT_SEQUENCE_REG_READ(SHA_H_BASE + 5 * 4));
+  REG_WRITE(&reg_addr_buf[6], DPORT_SEQUENCE_REG_READ(SHA_H_BASE + 6 * 4));
+  REG_WRITE(&reg_addr_buf[7], DPORT_SEQUENCE_REG_READ(SHA_H_BASE + 7 * 4));
+  DPORT_INTERRUPT_RESTORE();
+
+  REG_WRITE(&reg_addr_buf[8], 0x00000080);
+  REG_WRITE(&reg_addr_buf[9], 0x00000000);
+  REG_WRITE(&reg_addr_buf[10], 0x00000000);
+  REG_WRITE(&reg_addr_buf[11], 0x00000000);
+  REG_WRITE(&reg_addr_buf[12], 0x00000000);
+  REG_WRITE(&reg_addr_buf[13], 0x00000000);
+  REG_WRITE(&reg_addr_buf[14], 0x00000000);
+  REG_WRITE(&reg_addr_buf[15], 0x00010000);
+}
+
+static inline void nerd_sha_ll_read_digest(void* ptr)
+{
+  DPORT_INTERRUPT_DISABLE();
+  ((uint32_t*)ptr)[0] = DPORT_SEQUENCE_REG_READ(SHA_H_BASE + 0 * 4);
+  ((uint32_t*)ptr)[1] = DPORT_SEQUENCE_REG_READ(SHA_H_BASE + 1 * 4);
+  ((uint32_t*)ptr)[2] = DPORT_SEQUENCE_REG_READ(SHA_H_BASE + 2 * 4);
+  ((uint32_t*)ptr)[3] = DPORT_SEQUENCE_REG_READ(SHA_H_BASE + 3 * 4);
+  ((uint32_t*)ptr)[4] = DPORT_SEQUENCE_REG_READ(SHA_H_BASE + 4 * 4);
+  ((uint32_t*)ptr)[5] = DPORT_SEQUENCE_REG_READ(SHA_H_BASE + 5 * 4);
+  ((uint32_t*)ptr)[6] = DPORT_SEQUENCE_REG_READ(SHA_H_BASE + 6 * 4);  
+  ((uint32_t*)ptr)[7] = DPORT_SEQUENCE_REG_READ(SHA_H_BASE + 7 * 4);
+  DPORT_INTERRUPT_RESTORE();
+}
+
+
+static inline bool nerd_sha_ll_read_digest_if(void* ptr)
+{
+  DPORT_INTERRUPT_DISABLE();
+  uint32_t last = DPORT_SEQUENCE_REG_READ(SHA_H_BASE + 7 * 4);
+  #if 1
+  if ( (uint16_t)(last >> 16) != 0)
+  {
+    DPORT_INTERRUPT_RESTORE();
+    return false;
+  }
+  #endif
+
+  ((uint32_t*)ptr)[7] = last;
+  ((uint32_t*)ptr)[0] = DPORT_SEQUENCE_REG_READ(SHA_H_BASE + 0 * 4);
+  ((uint32_t*)ptr)[1] = DPORT_SEQUENCE_REG_READ(SHA_H_BASE + 1 * 4);
+  ((uint32_t*)ptr)[2] = DPORT_SEQUENCE_REG_READ(SHA_H_BASE + 2 * 4);
+  ((uint32_t*)ptr)[3] = DPORT_SEQUENCE_REG_READ(SHA_H_BASE + 3 * 4);
+  ((uint32_t*)ptr)[4] = DPORT_SEQUENCE_REG_READ(SHA_H_BASE + 4 * 4);
+  ((uint32_t*)ptr)[5] = DPORT_SEQUENCE_REG_READ(SHA_H_BASE + 5 * 4);
+  ((uint32_t*)ptr)[6] = DPORT_SEQUENCE_REG_READ(SHA_H_BASE + 6 * 4);  
+  DPORT_INTERRUPT_RESTORE();
+  return true;
+}
+
+static inline void nerd_sha_ll_write_digest(void *digest_state)
+{
+    uint32_t *digest_state_words = (uint32_t *)digest_state;
+    uint32_t *reg_addr_buf = (uint32_t *)(SHA_H_BASE);
+
+    REG_WRITE(&reg_addr_buf[0], digest_state_words[0]);
+    REG_WRITE(&reg_addr_buf[1], digest_state_words[1]);
+    REG_WRITE(&reg_addr_buf[2], digest_state_words[2]);
+    REG_WRITE(&reg_addr_buf[3], digest_state_words[3]);
+    REG_WRITE(&reg_addr_buf[4], digest_state_words[4]);
+    REG_WRITE(&reg_addr_buf[5], digest_state_words[5]);
+    REG_WRITE(&reg_addr_buf[6], digest_state_words[6]);
+    REG_WRITE(&reg_addr_buf[7], digest_state_words[7]);
+}
+
+static inline void nerd_sha_hal_wait_idle()
+{
+    while (REG_READ(SHA_BUSY_REG))
+    {}
+}
+
+#endif  //#if defined(CONFIG_IDF_TARGET_ESP32S2) || defined(CONFIG_IDF_TARGET_ESP32S3) || defined(CONFIG_IDF_TARGET_ESP32C3)
+
+#if defined(CONFIG_IDF_TARGET_ESP32)
+
+#include <sha/sha_parallel_engine.h>
+
+static inline bool nerd_sha_ll_read_digest_swap_if(void* ptr)
+{
+  DPORT_INTERRUPT_DISABLE();
+  uint32_t fin = DPORT_SEQUENCE_REG_READ(SHA_TEXT_BASE + 7 * 4);
+  if ( (uint32_t)(fin & 0xFFFF) != 0)
+  {
+    DPORT_INTERRUPT_RESTORE();
+    return false;
+  }
+  ((uint32_t*)ptr)[7] = __builtin_bswap32(fin);
+  ((uint32_t*)ptr)[0] = __builtin_bswap32(DPORT_SEQUENCE_REG_READ(SHA_TEXT_BASE + 0 * 4));
+  ((uint32_t*)ptr)[1] = __builtin_bswap32(DPORT_SEQUENCE_REG_READ(SHA_TEXT_BASE + 1 * 4));
+  ((uint32_t*)ptr)[2] = __builtin_bswap32(DPORT_SEQUENCE_REG_READ(SHA_TEXT_BASE + 2 * 4));
+  ((uint32_t*)ptr)[3] = __builtin_bswap32(DPORT_SEQUENCE_REG_READ(SHA_TEXT_BASE + 3 * 4));
+  ((uint32_t*)ptr)[4] = __builtin_bswap32(DPORT_SEQUENCE_REG_READ(SHA_TEXT_BASE + 4 * 4));
+  ((uint32_t*)ptr)[5] = __builtin_bswap32(DPORT_SEQUENCE_REG_READ(SHA_TEXT_BASE + 5 * 4));
+  ((uint32_t*)ptr)[6] = __builtin_bswap32(DPORT_SEQUENCE_REG_READ(SHA_TEXT_BASE + 6 * 4));
+  DPORT_INTERRUPT_RESTORE();
+  return true;
+}
+
+static inline void nerd_sha_ll_read_digest(void* ptr)
+{
+  DPORT_INTERRUPT_DISABLE();
+  ((uint32_t*)ptr)[0] = DPORT_SEQUENCE_REG_READ(SHA_TEXT_BASE + 0 * 4);
+  ((uint32_t*)ptr)[1] = DPORT_SEQUENCE_REG_READ(SHA_TEXT_BASE + 1 * 4);
+  ((uint32_t*)ptr)[2] = DPORT_SEQUENCE_REG_READ(SHA_TEXT_BASE + 2 * 4);
+  ((uint32_t*)ptr)[3] = DPORT_SEQUENCE_REG_READ(SHA_TEXT_BASE + 3 * 4);
+  ((uint32_t*)ptr)[4] = DPORT_SEQUENCE_REG_READ(SHA_TEXT_BASE + 4 * 4);
+  ((uint32_t*)ptr)[5] = DPORT_SEQUENCE_REG_READ(SHA_TEXT_BASE + 5 * 4);
+  ((uint32_t*)ptr)[6] = DPORT_SEQUENCE_REG_READ(SHA_TEXT_BASE + 6 * 4);
+  ((uint32_t*)ptr)[7] = DPORT_SEQUENCE_REG_READ(SHA_TEXT_BASE + 7 * 4);
+  DPORT_INTERRUPT_RESTORE();
+}
+
+static inline void nerd_sha_hal_wait_idle()
+{
+    while (DPORT_REG_READ(SHA_256_BUSY_REG))
+    {}
+}
+
+static inline void nerd_sha_ll_fill_text_block_sha256(const void *input_text)
+{
+    uint32_t *data_words = (uint32_t *)input_text;
+    uint32_t *reg_addr_buf = (uint32_t *)(SHA_TEXT_BASE);
+
+    reg_addr_buf[0]  = data_words[0];
+    reg_addr_buf[1]  = data_words[1];
+    reg_addr_buf[2]  = data_words[2];
+    reg_addr_buf[3]  = data_words[3];
+    reg_addr_buf[4]  = data_words[4];
+    reg_addr_buf[5]  = data_words[5];
+    reg_addr_buf[6]  = data_words[6];
+    reg_addr_buf[7]  = data_words[7];
+    reg_addr_buf[8]  = data_words[8];
+    reg_addr_buf[9]  = data_words[9];
+    reg_addr_buf[10] = data_words[10];
+    reg_addr_buf[11] = data_words[11];
+    reg_addr_buf[12] = data_words[12];
+    reg_addr_buf[13] = data_words[13];
+    reg_addr_buf[14] = data_words[14];
+    reg_addr_buf[15] = data_words[15];
+}
+
+static inline void nerd_sha_ll_fill_text_block_sha256_upper(const void *input_text, uint32_t nonce)
+{
+    uint32_t *data_words = (uint32_t *)input_text;
+    uint32_t *reg_addr_buf = (uint32_t *)(SHA_TEXT_BASE);
+
+    reg_addr_buf[0]  = data_words[0];
+    reg_addr_buf[1]  = data_words[1];
+    reg_addr_buf[2]  = data_words[2];
+    reg_addr_buf[3]  = __builtin_bswap32(nonce);
+#if 1
+    reg_addr_buf[4]  = 0x80000000;
+    reg_addr_buf[5]  = 0x00000000;
+    reg_addr_buf[6]  = 0x00000000;
+    reg_addr_buf[7]  = 0x00000000;
+    reg_addr_buf[8]  = 0x00000000;
+    reg_addr_buf[9]  = 0x00000000;
+    reg_addr_buf[10] = 0x00000000;
+    reg_addr_buf[11] = 0x00000000;
+    reg_addr_buf[12] = 0x00000000;
+    reg_addr_buf[13] = 0x00000000;
+    reg_addr_buf[14] = 0x00000000;
+    reg_addr_buf[15] = 0x00000280;
+#else
+    reg_addr_buf[4]  = data_words[4];
+    reg_addr_buf[5]  = data_words[5];
+    reg_addr_buf[6]  = data_words[6];
+    reg_addr_buf[7]  = data_words[7];
+    reg_addr_buf[8]  = data_words[8];
+    reg_addr_buf[9]  = data_words[9];
+    reg_addr_buf[10] = data_words[10];
+    reg_addr_buf[11] = data_words[11];
+    reg_addr_buf[12] = data_words[12];
+    reg_addr_buf[13] = data_words[13];
+    reg_addr_buf[14] = data_words[14];
+    reg_addr_buf[15] = data_words[15];
+#endif
+}
+
+static inline void nerd_sha_ll_fill_text_block_sha256_double()
+{
+    uint32_t *reg_addr_buf = (uint32_t *)(SHA_TEXT_BASE);
+
+#if 0
+    //No change
+    reg_addr_buf[0]  = data_words[0];
+    reg_addr_buf[1]  = data_words[1];
+    reg_addr_buf[2]  = data_words[2];
+    reg_addr_buf[3]  = data_words[3];
+    reg_addr_buf[4]  = data_words[4];
+    reg_addr_buf[5]  = data_words[5];
+    reg_addr_buf[6]  = data_words[6];
+    reg_addr_buf[7]  = data_words[7];
+#endif
+    reg_addr_buf[8]  = 0x80000000;
+    reg_addr_buf[9]  = 0x00000000;
+    reg_addr_buf[10] = 0x00000000;
+    reg_addr_buf[11] = 0x00000000;
+    reg_addr_buf[12] = 0x00000000;
+    reg_addr_buf[13] = 0x00000000;
+    reg_addr_buf[14] = 0x00000000;
+    reg_addr_buf[15] = 0x00000100;
+}
+
+#endif  //CONFIG_IDF_TARGET_ESP32
+
+#endif /* nerdSHA256hw_H_ */
@@ -0,0 +1,493 @@
+/************************************************************************************
+*   Description:
+
+*   x86 batch versions of nerd_sha256d_baked for the native (host) build.
+    SSE4.1 / AVX2 / AVX-512 kernels hash 4 / 8 / 16 nonces per pass using GCC vector
+    extensions compiled per target, SHA-NI runs the Intel SHA extensions one nonce
+    at a time. The kernel is chosen at runtime from the CPU feature flags.
+
+*************************************************************************************/
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <immintrin.h>
+
+#include "nerdSHA256plus.h"
+#include "nerdSHA256x86.h"
+
+static const uint32_t K[64] = {
+        0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+        0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+        0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+        0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+        0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+        0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+        0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+        0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2
+    };
+
+static const uint32_t IV[8] = { 0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19 };
+
+//Finish a surviving lane with the reference kernel so candidates are bit exact with the ESP32 path
+static inline uint32_t push_candidate(const uint32_t* digest, const uint8_t* dataIn, const uint32_t* bake, uint32_t nonce,
+                                      nerd_sha256d_candidate* candidates, uint32_t max_candidates, uint32_t found)
+{
+    uint8_t block[64];
+    memcpy(block, dataIn, sizeof(block));
+    memcpy(block + 12, &nonce, sizeof(nonce));
+    uint8_t hash[32];
+    if (!nerd_sha256d_baked(digest, block, bake, hash))
+        return found;
+    if (found < max_candidates)
+    {
+        candidates[found].nonce = nonce;
+        memcpy(candidates[found].hash, hash, sizeof(hash));
+    }
+    return found + 1;
+}
+
+/////////////////////////////// Scalar ///////////////////////////////
+
+static uint32_t batch_scalar(const uint32_t* digest, const uint8_t* dataIn, const uint32_t* bake,
+                             uint32_t nonce_start, uint32_t nonce_count,
+                             nerd_sha256d_candidate* candidates, uint32_t max_candidates)
+{
+    uint8_t block[64];
+    uint8_t hash[32];
+    uint32_t found = 0;
+    memcpy(block, dataIn, sizeof(block));
+    for (uint32_t n = 0; n < nonce_count; ++n)
+    {
+        uint32_t nonce = nonce_start + n;
+        memcpy(block + 12, &nonce, sizeof(nonce));
+        if (nerd_sha256d_baked(digest, block, bake, hash))
+        {
+            if (found < max_candidates)
+            {
+                candidates[found].nonce = nonce;
+                memcpy(candidates[found].hash, hash, sizeof(hash));
+            }
+            found++;
+        }
+    }
+    return found;
+}
+
+/////////////////////////// SIMD (N lanes) ///////////////////////////
+
+typedef uint32_t v4u  __attribute__((vector_size(16)));
+typedef uint32_t v8u  __attribute__((vector_size(32)));
+typedef uint32_t v16u __attribute__((vector_size(64)));
+
+#define VROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+#define VS0(x) (VROTR(x, 7) ^ VROTR(x, 18) ^ ((x) >> 3))
+#define VS1(x) (VROTR(x, 17) ^ VROTR(x, 19) ^ ((x) >> 10))
+#define VS2(x) (VROTR(x, 2) ^ VROTR(x, 13) ^ VROTR(x, 22))
+#define VS3(x) (VROTR(x, 6) ^ VROTR(x, 11) ^ VROTR(x, 25))
+#define VF0(x, y, z) (((x) & (y)) | ((z) & ((x) | (y))))
+#define VF1(x, y, z) ((z) ^ ((x) & ((y) ^ (z))))
+
+#define VROUND(t, w)                                  \
+    {                                                 \
+        V t1 = h + VS3(e) + VF1(e, f, g) + K[t] + (w); \
+        V t2 = VS2(a) + VF0(a, b, c);                 \
+        h = g; g = f; f = e; e = d + t1;              \
+        d = c; c = b; b = a; a = t1 + t2;             \
+    }
+
+//Shared body, always inlined into the per-target wrappers below so it is compiled
+//with the instruction set of the caller
+template <typename V, int LANES>
+static inline __attribute__((always_inline))
+uint32_t batch_simd(const uint32_t* digest, const uint8_t* dataIn, const uint32_t* bake,
+                    uint32_t nonce_start, uint32_t nonce_count,
+                    nerd_sha256d_candidate* candidates, uint32_t max_candidates)
+{
+    const V zero = {};
+    V lane = zero;
+    for (int i = 0; i < LANES; ++i)
+        lane[i] = i;
+
+    uint32_t found = 0;
+    uint32_t n = 0;
+    for (; n + LANES <= nonce_count; n += LANES)
+    {
+        V W[64];
+        V nonce = lane + (nonce_start + n);
+        //W3 is the only message word depending on the nonce
+        W[3] = (nonce << 24) | ((nonce << 8) & 0x00FF0000) | ((nonce >> 8) & 0x0000FF00) | (nonce >> 24);
+        W[16] = zero + bake[3];
+        W[17] = zero + bake[4];
+        //W18..W63 with the constant W0..W15 folded in (W4 = 0x80000000, W5..W14 = 0, W15 = 640)
+        W[18] = VS1(W[16]) + VS0(W[3]) + bake[2];
+        W[19] = VS1(W[17]) + W[3] + (((0x80000000u >> 7) | (0x80000000u << 25)) ^ ((0x80000000u >> 18) | (0x80000000u << 14)) ^ (0x80000000u >> 3));
+        W[20] = VS1(W[18]) + 0x80000000u;
+        W[21] = VS1(W[19]);
+        W[22] = VS1(W[20]) + 640u;
+        W[23] = VS1(W[21]) + W[16];
+        W[24] = VS1(W[22]) + W[17];
+        W[25] = VS1(W[23]) + W[18];
+        W[26] = VS1(W[24]) + W[19];
+        W[27] = VS1(W[25]) + W[20];
+        W[28] = VS1(W[26]) + W[21];
+        W[29] = VS1(W[27]) + W[22];
+        W[30] = VS1(W[28]) + W[23] + ((640u >> 7 | 640u << 25) ^ (640u >> 18 | 640u << 14) ^ (640u >> 3));
+        W[31] = VS1(W[29]) + W[24] + VS0(W[16]) + 640u;
+        #pragma GCC unroll 32
+        for (int t = 32; t < 64; ++t)
+            W[t] = VS1(W[t - 2]) + W[t - 7] + VS0(W[t - 15]) + W[t - 16];
+
+        //State after rounds 0..2 comes from the bake, round 3 is half precomputed
+        const uint32_t* s = bake + 5;
+        V a = zero + s[5], b = zero + s[6], c = zero + s[7], d = zero + s[0];
+        V e = zero + s[1], f = zero + s[2], g = zero + s[3], h = zero + s[4];
+        {
+            V t1 = W[3] + bake[13];
+            h = g; g = f; f = e; e = d + t1;
+            d = c; c = b; b = a; a = t1 + bake[14];
+        }
+        #pragma GCC unroll 8
+        for (int t = 4; t < 16; ++t)
+        {
+            V w = zero;
+            if (t == 4) w = zero + 0x80000000u;
+            if (t == 15) w = zero + 640u;
+            VROUND(t, w);
+        }
+        #pragma GCC unroll 48
+        for (int t = 16; t < 64; ++t)
+            VROUND(t, W[t]);
+
+        //Second hash, its block is the first digest plus constant padding
+        V X[64];
+        X[0] = a + digest[0]; X[1] = b + digest[1]; X[2] = c + digest[2]; X[3] = d + digest[3];
+        X[4] = e + digest[4]; X[5] = f + digest[5]; X[6] = g + digest[6]; X[7] = h + digest[7];
+        X[8] = zero + 0x80000000u;
+        X[9] = X[10] = X[11] = X[12] = X[13] = X[14] = zero;
+        X[15] = zero + 256u;
+        #pragma GCC unroll 45
+        for (int t = 16; t < 61; ++t)
+            X[t] = VS1(X[t - 2]) + X[t - 7] + VS0(X[t - 15]) + X[t - 16];
+
+        a = zero + IV[0]; b = zero + IV[1]; c = zero + IV[2]; d = zero + IV[3];
+        e = zero + IV[4]; f = zero + IV[5]; g = zero + IV[6]; h = zero + IV[7];
+        #pragma GCC unroll 60
+        for (int t = 0; t < 60; ++t)
+            VROUND(t, X[t]);
+
+        //Round 60 early reject: new e ends up as H7, the last 16 bits must be zero
+        V e60 = d + h + VS3(e) + VF1(e, f, g) + K[60] + X[60];
+        auto hit = ((e60 + IV[7]) & 0xFFFF) == 0;
+
+        uint64_t any = 0;
+        for (int i = 0; i < LANES / 2; ++i)
+            any |= ((const uint64_t*)&hit)[i];
+        if (any)
+        {
+            for (int i = 0; i < LANES; ++i)
+                if (hit[i])
+                    found = push_candidate(digest, dataIn, bake, nonce_start + n + i, candidates, max_candidates, found);
+        }
+    }
+
+    //Tail
+    if (n < nonce_count)
+    {
+        uint32_t left = nonce_count - n;
+        uint32_t room = found < max_candidates ? max_candidates - found : 0;
+        found += batch_scalar(digest, dataIn, bake, nonce_start + n, left, candidates + (room ? found : 0), room);
+    }
+    return found;
+}
+
+__attribute__((target("sse4.1")))
+static uint32_t batch_sse41(const uint32_t* digest, const uint8_t* dataIn, const uint32_t* bake,
+                            uint32_t nonce_start, uint32_t nonce_count,
+                            nerd_sha256d_candidate* candidates, uint32_t max_candidates)
+{
+    return batch_simd<v4u, 4>(digest, dataIn, bake, nonce_start, nonce_count, candidates, max_candidates);
+}
+
+__attribute__((target("avx2")))
+static uint32_t batch_avx2(const uint32_t* digest, const uint8_t* dataIn, const uint32_t* bake,
+                           uint32_t nonce_start, uint32_t nonce_count,
+                           nerd_sha256d_candidate* candidates, uint32_t max_candidates)
+{
+    return batch_simd<v8u, 8>(digest, dataIn, bake, nonce_start, nonce_count, candidates, max_candidates);
+}
+
+__attribute__((target("avx512f")))
+static uint32_t batch_avx512(const uint32_t* digest, const uint8_t* dataIn, const uint32_t* bake,
+                             uint32_t nonce_start, uint32_t nonce_count,
+                             nerd_sha256d_candidate* candidates, uint32_t max_candidates)
+{
+    return batch_simd<v16u, 16>(digest, dataIn, bake, nonce_start, nonce_count, candidates, max_candidates);
+}
+
+////////////////////////////// SHA-NI ////////////////////////////////
+
+#define SHANI_QROUND(s0, s1, msg, k)                                  \
+    {                                                                 \
+        __m128i m = _mm_add_epi32(msg, _mm_loadu_si128((const __m128i*)(k))); \
+        s1 = _mm_sha256rnds2_epu32(s1, s0, m);                        \
+        m = _mm_shuffle_epi32(m, 0x0E);                               \
+        s0 = _mm_sha256rnds2_epu32(s0, s1, m);                        \
+    }
+
+//M[g & 3] holds W[4g .. 4g+3], schedule the next group in place
+#define SHANI_SCHEDULE(M, g)                                                                          \
+    M[(g) & 3] = _mm_sha256msg2_epu32(                                                                \
+        _mm_add_epi32(_mm_sha256msg1_epu32(M[(g) & 3], M[((g) + 1) & 3]),                              \
+                      _mm_alignr_epi8(M[((g) + 3) & 3], M[((g) + 2) & 3], 4)),                         \
+        M[((g) + 3) & 3])
+
+__attribute__((target("sha,sse4.1")))
+static inline void shani_load_state(const uint32_t* h, __m128i& abef, __m128i& cdgh)
+{
+    __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&h[0]), 0xB1); // CDAB
+    cdgh = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&h[4]), 0x1B);        // EFGH
+    abef = _mm_alignr_epi8(tmp, cdgh, 8);
+    cdgh = _mm_blend_epi16(cdgh, tmp, 0xF0);
+}
+
+__attribute__((target("sha,sse4.1")))
+static uint32_t batch_shani(const uint32_t* digest, const uint8_t* dataIn, const uint32_t* bake,
+                            uint32_t nonce_start, uint32_t nonce_count,
+                            nerd_sha256d_candidate* candidates, uint32_t max_candidates)
+{
+    __m128i mid_abef, mid_cdgh, iv_abef, iv_cdgh;
+    shani_load_state(digest, mid_abef, mid_cdgh);
+    shani_load_state(IV, iv_abef, iv_cdgh);
+
+    const __m128i w4_7 = _mm_set_epi32(0, 0, 0, 0x80000000);
+    const __m128i w8_11 = _mm_setzero_si128();
+    const __m128i w12_15 = _mm_set_epi32(640, 0, 0, 0);
+    const __m128i x8_11 = _mm_set_epi32(0, 0, 0, 0x80000000);
+    const __m128i x12_15 = _mm_set_epi32(256, 0, 0, 0);
+
+    uint32_t found = 0;
+    for (uint32_t n = 0; n < nonce_count; ++n)
+    {
+        uint32_t nonce = nonce_start + n;
+        __m128i M[4];
+        M[0] = _mm_set_epi32(__builtin_bswap32(nonce), bake[2], bake[1], bake[0]);
+        M[1] = w4_7; M[2] = w8_11; M[3] = w12_15;
+
+        __m128i s0 = mid_abef, s1 = mid_cdgh;
+        SHANI_QROUND(s0, s1, M[0], &K[0]);
+        SHANI_QROUND(s0, s1, M[1], &K[4]);
+        SHANI_QROUND(s0, s1, M[2], &K[8]);
+        SHANI_QROUND(s0, s1, M[3], &K[12]);
+        #pragma GCC unroll 12
+        for (int g = 4; g < 16; ++g)
+        {
+            SHANI_SCHEDULE(M, g);
+            SHANI_QROUND(s0, s1, M[g & 3], &K[g * 4]);
+        }
+        s0 = _mm_add_epi32(s0, mid_abef);
+        s1 = _mm_add_epi32(s1, mid_cdgh);
+
+        //Back to H0..H7 order, it is the message of the second hash
+        __m128i tmp = _mm_shuffle_epi32(s0, 0x1B);  // FEBA
+        s1 = _mm_shuffle_epi32(s1, 0xB1);           // DCHG
+        M[0] = _mm_blend_epi16(tmp, s1, 0xF0);      // DCBA
+        M[1] = _mm_alignr_epi8(s1, tmp, 8);         // HGFE
+        M[2] = x8_11; M[3] = x12_15;
+
+        s0 = iv_abef; s1 = iv_cdgh;
+        SHANI_QROUND(s0, s1, M[0], &K[0]);
+        SHANI_QROUND(s0, s1, M[1], &K[4]);
+        SHANI_QROUND(s0, s1, M[2], &K[8]);
+        SHANI_QROUND(s0, s1, M[3], &K[12]);
+        #pragma GCC unroll 11
+        for (int g = 4; g < 15; ++g)
+        {
+            SHANI_SCHEDULE(M, g);
+            SHANI_QROUND(s0, s1, M[g & 3], &K[g * 4]);
+        }
+        //Rounds 60/61 only: F of the new ABEF is e60, which becomes H7
+        SHANI_SCHEDULE(M, 15);
+        __m128i m = _mm_add_epi32(M[3], _mm_loadu_si128((const __m128i*)&K[60]));
+        __m128i r = _mm_sha256rnds2_epu32(s1, s0, m);
+        if (((uint32_t)_mm_cvtsi128_si32(r) + IV[7]) & 0xFFFF)
+            continue;
+        found = push_candidate(digest, dataIn, bake, nonce, candidates, max_candidates, found);
+    }
+    return found;
+}
+
+///////////////////////////// Dispatch ///////////////////////////////
+
+typedef uint32_t (*batch_fn)(const uint32_t*, const uint8_t*, const uint32_t*, uint32_t, uint32_t, nerd_sha256d_candidate*, uint32_t);
+
+static const batch_fn s_kernels[NERD_SHA_KERNEL_COUNT] = { batch_scalar, batch_sse41, batch_avx2, batch_avx512, batch_shani };
+static const char* const s_kernel_names[NERD_SHA_KERNEL_COUNT] = { "scalar", "sse4.1 x4", "avx2 x8", "avx512 x16", "sha-ni" };
+static const int s_kernel_lanes[NERD_SHA_KERNEL_COUNT] = { 1, 4, 8, 16, 1 };
+static nerd_sha_kernel s_selected = NERD_SHA_KERNEL_AUTO;
+
+bool nerd_sha_kernel_supported(nerd_sha_kernel kernel)
+{
+    __builtin_cpu_init();
+    switch (kernel)
+    {
+        case NERD_SHA_KERNEL_SCALAR: return true;
+        case NERD_SHA_KERNEL_SSE41:  return __builtin_cpu_supports("sse4.1");
+        case NERD_SHA_KERNEL_AVX2:   return __builtin_cpu_supports("avx2");
+        case NERD_SHA_KERNEL_AVX512: return __builtin_cpu_supports("avx512f");
+        #if defined(__GNUC__) && __GNUC__ >= 11
+        case NERD_SHA_KERNEL_SHANI:  return __builtin_cpu_supports("sha") && __builtin_cpu_supports("sse4.1");
+        #else
+        case NERD_SHA_KERNEL_SHANI:
+        {
+            unsigned int eax, ebx, ecx, edx;
+            __asm__ __volatile__("cpuid" : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx) : "a"(7), "c"(0));
+            return (ebx & (1u << 29)) && __builtin_cpu_supports("sse4.1");
+        }
+        #endif
+        default: return false;
+    }
+}
+
+const char* nerd_sha_kernel_name(nerd_sha_kernel kernel)
+{
+    if (kernel < 0 || kernel >= NERD_SHA_KERNEL_COUNT)
+        return "auto";
+    return s_kernel_names[kernel];
+}
+
+static double kernel_mhs(nerd_sha_kernel kernel, const uint32_t* midstate, const uint8_t* dataIn, const uint32_t* bake,
+                         uint32_t nonce_start, uint32_t nonce_count, nerd_sha256d_candidate* candidates, uint32_t max_candidates, uint32_t* found)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    uint32_t n = s_kernels[kernel](midstate, dataIn, bake, nonce_start, nonce_count, candidates, max_candidates);
+    auto t1 = std::chrono::steady_clock::now();
+    if (found)
+        *found = n;
+    double secs = std::chrono::duration<double>(t1 - t0).count();
+    return secs > 0.0 ? (double)nonce_count / secs / 1e6 : 0.0;
+}
+
+//Genesis block header, its nonce 0x7C2BAC1D must show up as a candidate in every kernel
+static const uint32_t s_genesis_nonce = 0x7C2BAC1D;
+
+static void genesis_job(uint32_t* midstate, uint8_t* block, uint32_t* bake)
+{
+    static const uint8_t header[80] = {
+        0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x3b, 0xa3, 0xed, 0xfd, 0x7a, 0x7b, 0x12, 0xb2, 0x7a, 0xc7, 0x2c, 0x3e,
+        0x67, 0x76, 0x8f, 0x61, 0x7f, 0xc8, 0x1b, 0xc3, 0x88, 0x8a, 0x51, 0x32, 0x3a, 0x9f, 0xb8, 0xaa,
+        0x4b, 0x1e, 0x5e, 0x4a, 0x29, 0xab, 0x5f, 0x49, 0xff, 0xff, 0x00, 0x1d, 0x1d, 0xac, 0x2b, 0x7c,
+    };
+    memset(block, 0, 128);
+    memcpy(block, header, sizeof(header));
+    block[80] = 0x80;
+    block[126] = 0x02;
+    block[127] = 0x80;
+    nerd_mids(midstate, block);
+    nerd_sha256_bake(midstate, block + 64, bake);
+}
+
+nerd_sha_kernel nerd_sha_kernel_select(nerd_sha_kernel kernel)
+{
+    if (kernel != NERD_SHA_KERNEL_AUTO && nerd_sha_kernel_supported(kernel))
+    {
+        s_selected = kernel;
+        return s_selected;
+    }
+    //Feature flags alone don't tell which one wins (SHA-NI vs AVX-512 depends on the core),
+    //so time a short run of every supported kernel and keep the fastest
+    uint32_t midstate[8];
+    uint32_t bake[16];
+    uint8_t block[128];
+    nerd_sha256d_candidate candidates[8];
+    genesis_job(midstate, block, bake);
+
+    double best = 0.0;
+    s_selected = NERD_SHA_KERNEL_SCALAR;
+    for (int k = NERD_SHA_KERNEL_SCALAR; k < NERD_SHA_KERNEL_COUNT; ++k)
+    {
+        if (!nerd_sha_kernel_supported((nerd_sha_kernel)k))
+            continue;
+        double mhs = kernel_mhs((nerd_sha_kernel)k, midstate, block + 64, bake, 0, 64 * 1024, candidates, 8, NULL);
+        if (mhs > best)
+        {
+            best = mhs;
+            s_selected = (nerd_sha_kernel)k;
+        }
+    }
+    return s_selected;
+}
+
+uint32_t nerd_sha256d_baked_batch_kernel(nerd_sha_kernel kernel,
+                                         const uint32_t* digest, const uint8_t* dataIn, const uint32_t* bake,
+                                         uint32_t nonce_start, uint32_t nonce_count,
+                                         nerd_sha256d_candidate* candidates, uint32_t max_candidates)
+{
+    if (kernel < 0 || kernel >= NERD_SHA_KERNEL_COUNT)
+        kernel = NERD_SHA_KERNEL_SCALAR;
+    return s_kernels[kernel](digest, dataIn, bake, nonce_start, nonce_count, candidates, max_candidates);
+}
+
+uint32_t nerd_sha256d_baked_batch(const uint32_t* digest, const uint8_t* dataIn, const uint32_t* bake,
+                                  uint32_t nonce_start, uint32_t nonce_count,
+                                  nerd_sha256d_candidate* candidates, uint32_t max_candidates)
+{
+    if (s_selected == NERD_SHA_KERNEL_AUTO)
+        nerd_sha_kernel_select(NERD_SHA_KERNEL_AUTO);
+    return s_kernels[s_selected](digest, dataIn, bake, nonce_start, nonce_count, candidates, max_candidates);
+}
+
+//////////////////////////// Benchmark ///////////////////////////////
+
+bool nerd_sha256d_batch_benchmark(uint32_t nonces_per_kernel)
+{
+    uint32_t midstate[8];
+    uint32_t bake[16];
+    uint8_t block[128];
+    genesis_job(midstate, block, bake);
+
+    const uint32_t nonce_start = s_genesis_nonce - nonces_per_kernel / 2;
+    nerd_sha256d_candidate reference[256];
+    nerd_sha256d_candidate candidates[256];
+    uint32_t ref_found = batch_scalar(midstate, block + 64, bake, nonce_start, nonces_per_kernel, reference, 256);
+    bool genesis_found = false;
+    for (uint32_t i = 0; i < ref_found && i < 256; ++i)
+        genesis_found |= reference[i].nonce == s_genesis_nonce && reference[i].hash[31] == 0 && reference[i].hash[26] == 0x19;
+    bool all_ok = genesis_found;
+
+    double scalar_mhs = 0.0;
+    printf("| kernel       | lanes | supported |      MH/s | speedup | check |\n");
+    printf("|--------------|-------|-----------|-----------|---------|-------|\n");
+    for (int k = 0; k < NERD_SHA_KERNEL_COUNT; ++k)
+    {
+        nerd_sha_kernel kernel = (nerd_sha_kernel)k;
+        if (!nerd_sha_kernel_supported(kernel))
+        {
+            printf("| %-12s | %5d | %-9s | %9s | %7s | %5s |\n", s_kernel_names[k], s_kernel_lanes[k], "no", "-", "-", "-");
+            continue;
+        }
+        uint32_t found = 0;
+        double mhs = kernel_mhs(kernel, midstate, block + 64, bake, nonce_start, nonces_per_kernel, candidates, 256, &found);
+        if (kernel == NERD_SHA_KERNEL_SCALAR)
+            scalar_mhs = mhs;
+
+        bool ok = (found == ref_found);
+        for (uint32_t i = 0; ok && i < found && i < 256; ++i)
+            ok = candidates[i].nonce == reference[i].nonce && memcmp(candidates[i].hash, reference[i].hash, 32) == 0;
+        all_ok &= ok;
+
+        printf("| %-12s | %5d | %-9s | %9.2f | %6.2fx | %5s |\n", s_kernel_names[k], s_kernel_lanes[k], "yes",
+               mhs, scalar_mhs > 0.0 ? mhs / scalar_mhs : 0.0, ok ? "ok" : "FAIL");
+    }
+    printf("Candidates (16 bit) over %u nonces: %u, genesis nonce %s, auto kernel: %s\n", nonces_per_kernel, ref_found,
+           genesis_found ? "found" : "MISSING",
+           nerd_sha_kernel_name(nerd_sha_kernel_select(NERD_SHA_KERNEL_AUTO)));
+    return all_ok;
+}
+
+#endif // x86
@@ -0,0 +1,60 @@
+/************************************************************************************
+*   Description:
+
+*   Batch sha256d kernels for x86 host builds (native simulator / regression tool).
+
+    Every kernel takes the same inputs as nerd_sha256d_baked (midstate digest, second
+    64 byte block and the 15 bake words from nerd_sha256_bake) and hashes a run of
+    consecutive nonces. Lanes are rejected at round 60 of the second hash exactly like
+    the ESP32 kernel, surviving nonces are finished with nerd_sha256d_baked.
+
+*************************************************************************************/
+#ifndef nerdSHA256x86_H_
+#define nerdSHA256x86_H_
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+    NERD_SHA_KERNEL_AUTO = -1,
+    NERD_SHA_KERNEL_SCALAR = 0,
+    NERD_SHA_KERNEL_SSE41,      // 4 lanes
+    NERD_SHA_KERNEL_AVX2,       // 8 lanes
+    NERD_SHA_KERNEL_AVX512,     // 16 lanes
+    NERD_SHA_KERNEL_SHANI,      // 1 lane, Intel SHA extensions
+    NERD_SHA_KERNEL_COUNT
+} nerd_sha_kernel;
+
+typedef struct {
+    uint32_t nonce;
+    uint8_t hash[32];
+} nerd_sha256d_candidate;
+
+/* Returns true if the running CPU can execute the given kernel */
+bool nerd_sha_kernel_supported(nerd_sha_kernel kernel);
+const char* nerd_sha_kernel_name(nerd_sha_kernel kernel);
+
+/* Kernel used by nerd_sha256d_baked_batch, NERD_SHA_KERNEL_AUTO times the supported ones and keeps the fastest */
+nerd_sha_kernel nerd_sha_kernel_select(nerd_sha_kernel kernel);
+
+/* Hash nonce_start .. nonce_start+nonce_count-1, the nonce is placed at dataIn+12 like the
+   ESP32 workers do. Hashes whose last 16 bits are zero are written to candidates.
+   Returns the number of candidates found (can exceed max_candidates, extra ones are dropped) */
+uint32_t nerd_sha256d_baked_batch(const uint32_t* digest, const uint8_t* dataIn, const uint32_t* bake,
+                                  uint32_t nonce_start, uint32_t nonce_count,
+                                  nerd_sha256d_candidate* candidates, uint32_t max_candidates);
+
+uint32_t nerd_sha256d_baked_batch_kernel(nerd_sha_kernel kernel,
+                                         const uint32_t* digest, const uint8_t* dataIn, const uint32_t* bake,
+                                         uint32_t nonce_start, uint32_t nonce_count,
+                                         nerd_sha256d_candidate* candidates, uint32_t max_candidates);
+
+/* Cross-checks every supported kernel against the scalar one and prints a MH/s table */
+bool nerd_sha256d_batch_benchmark(uint32_t nonces_per_kernel);
+
+#endif // x86
+
+#endif /* nerdSHA256x86_H_ */
@@ -1,5 +0,0 @@
-#ifdef HW_SHA256_TEST
-
-IRAM_ATTR void HwShaTest();
-
-#endif
\ No newline at end of file
@@ -0,0 +1,543 @@
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include <atomic>
+#include <esp_attr.h>
+#include "ShaTests/shaBenchmark.h"
+
+#ifdef SHA_BENCHMARK
+
+#include "mbedtls/sha256.h"
+#include "ShaTests/nerdSHA256plus.h"
+#include "ShaTests/nerdSHA256hw.h"
+#include "drivers/displays/display.h"
+#include "version.h"
+
+#if defined(CONFIG_IDF_TARGET_ESP32S3) || defined(CONFIG_IDF_TARGET_ESP32C3)
+#define BENCH_DMA
+#include <soc/lldesc.h>
+#include <hal/gdma_types.h>
+#include <esp_crypto_shared_gdma.h>
+#endif
+
+#define BENCH_CHUNK             1024        //Nonces between two looks at the stop flag
+#define BENCH_STACK             6000
+#define BENCH_PRIORITY          1           //Software miners
+#define BENCH_REQUEST_MAGIC     0x42454E43  //"BENC", set by the console before restarting
+#define BENCH_SECONDS_MAX       60
+#define BENCH_WIFI_CONNECT_ms   15000
+#define BENCH_WIFI_ms           2           //Between two datagrams
+#define BENCH_DATAGRAM_SIZE     1024
+#define BENCH_DISCARD_PORT      9
+#define BENCH_DISPLAY_ms        100         //Monitor task refresh
+#define BENCH_ROWS              64
+
+//Header of the old HW_SHA256_TEST, padded for its second block. Earlier single core
+//numbers of it: mbedtls 16 KH/s (S3) 9.5 KH/s (ESP32), nerd_sha256d 39 KH/s, baked
+//42 KH/s, engine 162 KH/s (S3) 200 KH/s (ESP32), DMA 50 KH/s (S3)
+static const uint8_t s_test_header[128] =
+{
+  0x00, 0x00, 0x00, 0x22, 0x99, 0x44, 0xbb, 0xff, 0xbb, 0x00, 0x00, 0x77, 0x44, 0xcc, 0x11, 0x77,
+  0x88, 0x55, 0xbb, 0x44, 0x55, 0x00, 0x77, 0x88, 0x99, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0xbb, 0xbb, 0x66, 0x11, 0x88, 0x33, 0x44, 0x99, 0xcc, 0x33, 0xff, 0x22,
+  0x11, 0xaa, 0x77, 0xee, 0xbb, 0x66, 0xee, 0xcc, 0xee, 0x66, 0xee, 0xdd, 0x77, 0x55, 0x22, 0x22,
+  0xcc, 0xcc, 0x66, 0xee, 0x22, 0xdd, 0x99, 0x66, 0x66, 0x88, 0x00, 0x11, 0x2e, 0x33, 0x41, 0x19,
+
+  0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x80
+};
+
+//sha256d of the header with its own nonce
+static const uint8_t s_test_hash[32] =
+{
+  0x6f, 0xa4, 0x64, 0xb0, 0x07, 0xf2, 0xd5, 0x77, 0xed, 0xfa, 0x5d, 0xfe, 0x9d, 0xfc, 0x3f, 0x92,
+  0x09, 0xf3, 0x6d, 0x1a, 0x67, 0x11, 0xd3, 0x14, 0xea, 0x68, 0xcc, 0xdd, 0x03, 0x00, 0x00, 0x00
+};
+
+//What the engines start from, prepared like JobPrepareHeader does
+typedef struct {
+  uint8_t header[128];
+  uint32_t midstate[8];
+  uint32_t bake[16];
+  nerdSHA256_context context;
+#if defined(CONFIG_IDF_TARGET_ESP32S2) || defined(CONFIG_IDF_TARGET_ESP32S3) || defined(CONFIG_IDF_TARGET_ESP32C3)
+  uint32_t hw_midstate[8];
+#endif
+#if defined(CONFIG_IDF_TARGET_ESP32)
+  uint8_t header_swap[128];
+#endif
+} bench_job;
+
+//Hashes count nonces from nonce_start, returns how many passed the 16 bit filter,
+//the hash of the last one in hash
+typedef uint32_t (*bench_hash)(bench_job& job, uint32_t nonce_start, uint32_t count, uint8_t* hash);
+
+typedef struct {
+  const char* name;
+  bench_hash hash;
+} bench_engine;
+
+typedef struct {
+  const bench_engine* engine;
+  bench_job job;
+  uint32_t nonce;
+  uint64_t hashes;
+  uint32_t elapsed_us;
+  std::atomic<bool> done;
+} bench_runner;
+
+typedef struct {
+  uint8_t engine;
+  uint8_t tasks;
+  bool wifi;
+  bool display;
+  uint32_t elapsed_ms;
+  uint64_t hashes;
+  double khs;
+} bench_row;
+
+static RTC_NOINIT_ATTR uint32_t s_bench_request;
+static RTC_NOINIT_ATTR uint32_t s_bench_seconds;
+
+static bench_job s_job;
+static bench_runner s_runners[portNUM_PROCESSORS];
+static bench_row s_rows[BENCH_ROWS];
+static int s_row_count = 0;
+static std::atomic<bool> s_bench_stop{false};
+static std::atomic<bool> s_load_stop{false};
+static std::atomic<int> s_loads{0};
+
+static uint32_t BenchSwBaked(bench_job& job, uint32_t nonce_start, uint32_t count, uint8_t* hash)
+{
+  uint32_t found = 0;
+  uint8_t result[32];
+  for (uint32_t n = nonce_start; n != nonce_start + count; ++n)
+  {
+    ((uint32_t*)(job.header+64+12))[0] = n;
+    if (nerd_sha256d_baked(job.midstate, job.header+64, job.bake, result))
+    {
+      memcpy(hash, result, sizeof(result));
+      found++;
+    }
+  }
+  return found;
+}
+
+static uint32_t BenchSwPlain(bench_job& job, uint32_t nonce_start, uint32_t count, uint8_t* hash)
+{
+  uint32_t found = 0;
+  uint8_t result[32];
+  for (uint32_t n = nonce_start; n != nonce_start + count; ++n)
+  {
+    ((uint32_t*)(job.header+64+12))[0] = n;
+    if (nerd_sha256d(&job.context, job.header+64, result))
+    {
+      memcpy(hash, result, sizeof(result));
+      found++;
+    }
+  }
+  return found;
+}
+
+static uint32_t BenchMbedtls(bench_job& job, uint32_t nonce_start, uint32_t count, uint8_t* hash)
+{
+  uint32_t found = 0;
+  uint8_t inter[32];
+  uint8_t result[32];
+  mbedtls_sha256_context ctx;
+  mbedtls_sha256_init(&ctx);
+  for (uint32_t n = nonce_start; n != nonce_start + count; ++n)
+  {
+    ((uint32_t*)(job.header+64+12))[0] = n;
+    mbedtls_sha256_starts_ret(&ctx, 0);
+    mbedtls_sha256_update_ret(&ctx, job.header, 80);
+    mbedtls_sha256_finish_ret(&ctx, inter);
+    mbedtls_sha256_starts_ret(&ctx, 0);
+    mbedtls_sha256_update_ret(&ctx, inter, sizeof(inter));
+    mbedtls_sha256_finish_ret(&ctx, result);
+    if (result[30] == 0 && result[31] == 0)
+    {
+      memcpy(hash, result, sizeof(result));
+      found++;
+    }
+  }
+  mbedtls_sha256_free(&ctx);
+  return found;
+}
+
+#if defined(CONFIG_IDF_TARGET_ESP32S2) || defined(CONFIG_IDF_TARGET_ESP32S3) || defined(CONFIG_IDF_TARGET_ESP32C3)
+//Same sequence as minerWorkerHw
+static uint32_t BenchHwS3(bench_job& job, uint32_t nonce_start, uint32_t count, uint8_t* hash)
+{
+  uint32_t found = 0;
+  esp_sha_acquire_hardware();
+  REG_WRITE(SHA_MODE_REG, SHA2_256);
+  for (uint32_t n = nonce_start; n != nonce_start + count; ++n)
+  {
+    nerd_sha_ll_write_digest(job.hw_midstate);
+    nerd_sha_ll_fill_text_block_sha256(job.header+64, n);
+    REG_WRITE(SHA_CONTINUE_REG, 1);
+    sha_ll_load(SHA2_256);
+    nerd_sha_hal_wait_idle();
+    nerd_sha_ll_fill_text_block_sha256_inter();
+    REG_WRITE(SHA_START_REG, 1);
+    sha_ll_load(SHA2_256);
+    nerd_sha_hal_wait_idle();
+    if (nerd_sha_ll_read_digest_if(hash))
+      found++;
+  }
+  esp_sha_release_hardware();
+  return found;
+}
+#endif
+
+#if defined(CONFIG_IDF_TARGET_ESP32)
+//Same sequence as minerWorkerHw
+static uint32_t BenchHwEsp32(bench_job& job, uint32_t nonce_start, uint32_t count, uint8_t* hash)
+{
+  uint32_t found = 0;
+  esp_sha_lock_engine(SHA2_256);
+  for (uint32_t n = nonce_start; n != nonce_start + count; ++n)
+  {
+    nerd_sha_ll_fill_text_block_sha256(job.header_swap);
+    sha_ll_start_block(SHA2_256);
+    nerd_sha_hal_wait_idle();
+    nerd_sha_ll_fill_text_block_sha256_upper(job.header_swap+64, n);
+    sha_ll_continue_block(SHA2_256);
+    nerd_sha_hal_wait_idle();
+    sha_ll_load(SHA2_256);
+    nerd_sha_hal_wait_idle();
+    nerd_sha_ll_fill_text_block_sha256_double();
+    sha_ll_start_block(SHA2_256);
+    nerd_sha_hal_wait_idle();
+    sha_ll_load(SHA2_256);
+    if (nerd_sha_ll_read_digest_swap_if(hash))
+      found++;
+  }
+  esp_sha_unlock_engine(SHA2_256);
+  return found;
+}
+#endif
+
+#ifdef BENCH_DMA
+//Both blocks of the header, then the inner hash padded to a block. Shared by the
+//tasks, only written with the engine acquired.
+static DMA_ATTR uint8_t s_dma_header[128];
+static DMA_ATTR uint8_t s_dma_inter[64];
+static DRAM_ATTR lldesc_t s_dma_descr_header;
+static DRAM_ATTR lldesc_t s_dma_descr_nonce;
+static DRAM_ATTR lldesc_t s_dma_descr_inter;
+
+static void BenchDmaSetup(void)
+{
+  memset(&s_dma_descr_header, 0, sizeof(lldesc_t));
+  memset(&s_dma_descr_nonce, 0, sizeof(lldesc_t));
+  memset(&s_dma_descr_inter, 0, sizeof(lldesc_t));
+
+  s_dma_descr_nonce.length = 64;
+  s_dma_descr_nonce.size = 64;
+  s_dma_descr_nonce.owner = 1;
+  s_dma_descr_nonce.eof = 1;
+  s_dma_descr_nonce.buf = s_dma_header+64;
+
+  s_dma_descr_header.length = 64;
+  s_dma_descr_header.size = 64;
+  s_dma_descr_header.owner = 1;
+  s_dma_descr_header.eof = 0;
+  s_dma_descr_header.buf = s_dma_header;
+  s_dma_descr_header.empty = (uint32_t)(&s_dma_descr_nonce);
+
+  memset(s_dma_inter, 0, sizeof(s_dma_inter));
+  s_dma_inter[32] = 0x80;
+  s_dma_inter[62] = 0x01;
+  s_dma_descr_inter.length = 64;
+  s_dma_descr_inter.size = 64;
+  s_dma_descr_inter.owner = 1;
+  s_dma_descr_inter.eof = 1;
+  s_dma_descr_inter.buf = s_dma_inter;
+}
+
+static uint32_t BenchDma(bench_job& job, uint32_t nonce_start, uint32_t count, uint8_t* hash)
+{
+  uint32_t found = 0;
+  uint8_t result[32];
+  esp_sha_acquire_hardware();
+  memcpy(s_dma_header, job.header, sizeof(s_dma_header));
+  for (uint32_t n = nonce_start; n != nonce_start + count; ++n)
+  {
+    ((uint32_t*)(s_dma_header+64+12))[0] = n;
+    esp_crypto_shared_gdma_start(&s_dma_descr_header, NULL, GDMA_TRIG_PERIPH_SHA);
+    sha_hal_hash_dma(SHA2_256, 2, true);
+    sha_hal_wait_idle();
+    sha_hal_read_digest(SHA2_256, s_dma_inter);
+
+    esp_crypto_shared_gdma_start(&s_dma_descr_inter, NULL, GDMA_TRIG_PERIPH_SHA);
+    sha_hal_hash_dma(SHA2_256, 1, true);
+    sha_hal_wait_idle();
+    sha_hal_read_digest(SHA2_256, result);
+    if (result[30] == 0 && result[31] == 0)
+    {
+      memcpy(hash, result, sizeof(result));
+      found++;
+    }
+  }
+  esp_sha_release_hardware();
+  return found;
+}
+#endif
+
+static const bench_engine s_engines[] = {
+  { "sw_baked", BenchSwBaked },
+  { "sw_plain", BenchSwPlain },
+  { "mbedtls", BenchMbedtls },
+#if defined(CONFIG_IDF_TARGET_ESP32S2) || defined(CONFIG_IDF_TARGET_ESP32S3) || defined(CONFIG_IDF_TARGET_ESP32C3)
+  { "hw_s3", BenchHwS3 },
+#endif
+#if defined(CONFIG_IDF_TARGET_ESP32)
+  { "hw_esp32", BenchHwEsp32 },
+#endif
+#ifdef BENCH_DMA
+  { "dma", BenchDma },
+#endif
+};
+
+#define BENCH_ENGINES   (sizeof(s_engines) / sizeof(s_engines[0]))
+
+static void BenchPrepare(void)
+{
+  bench_job& job = s_job;
+  memcpy(job.header, s_test_header, sizeof(job.header));
+  nerd_mids(job.midstate, job.header);
+  nerd_sha256_bake(job.midstate, job.header+64, job.bake);
+  memcpy(job.context.digest, job.midstate, sizeof(job.midstate));
+#if defined(CONFIG_IDF_TARGET_ESP32S2) || defined(CONFIG_IDF_TARGET_ESP32S3) || defined(CONFIG_IDF_TARGET_ESP32C3)
+  esp_sha_acquire_hardware();
+  sha_hal_hash_block(SHA2_256, job.header, 64/4, true);
+  sha_hal_read_digest(SHA2_256, job.hw_midstate);
+  esp_sha_release_hardware();
+#endif
+#if defined(CONFIG_IDF_TARGET_ESP32)
+  for (int i = 0; i < 32; ++i)
+    ((uint32_t*)job.header_swap)[i] = __builtin_bswap32(((const uint32_t*)job.header)[i]);
+#endif
+#ifdef BENCH_DMA
+  BenchDmaSetup();
+#endif
+}
+
+//Hashes the nonce of the test header, it must come out as the known hash
+static bool BenchCheck(const bench_engine& engine)
+{
+  static bench_job job;
+  uint8_t hash[32];
+  memset(hash, 0xFF, sizeof(hash));
+  job = s_job;
+  uint32_t nonce = ((const uint32_t*)(s_test_header+64+12))[0];
+  return engine.hash(job, nonce, 1, hash) == 1 && memcmp(hash, s_test_hash, sizeof(hash)) == 0;
+}
+
+static void BenchTask(void* param)
+{
+  bench_runner* runner = (bench_runner*)param;
+  uint8_t hash[32];
+  uint32_t start_us = micros();
+  while (!s_bench_stop.load(std::memory_order_relaxed))
+  {
+    runner->engine->hash(runner->job, runner->nonce, BENCH_CHUNK, hash);
+    runner->nonce += BENCH_CHUNK;
+    runner->hashes += BENCH_CHUNK;
+  }
+  runner->elapsed_us = micros() - start_us;
+  runner->done = true;
+  vTaskDelete(NULL);
+}
+
+static void BenchRun(int engine, int tasks, bool wifi, bool display, uint32_t seconds)
+{
+  s_bench_stop = false;
+  for (int i = 0; i < tasks; ++i)
+  {
+    bench_runner& runner = s_runners[i];
+    runner.engine = &s_engines[engine];
+    runner.job = s_job;
+    runner.nonce = (uint32_t)i << 28;
+    runner.hashes = 0;
+    runner.elapsed_us = 0;
+    runner.done = false;
+    //A single task goes where the miners have the most room, the last core
+    int core = tasks == 1 ? portNUM_PROCESSORS - 1 : i;
+    xTaskCreatePinnedToCore(BenchTask, "Bench", BENCH_STACK, &runner, BENCH_PRIORITY, NULL, core);
+  }
+  delay(seconds * 1000);
+  s_bench_stop = true;
+
+  bench_row row = {};
+  row.engine = engine;
+  row.tasks = tasks;
+  row.wifi = wifi;
+  row.display = display;
+  for (int i = 0; i < tasks; ++i)
+  {
+    bench_runner& runner = s_runners[i];
+    while (!runner.done)
+      delay(10);
+    if (runner.elapsed_us == 0)
+      continue;
+    row.hashes += runner.hashes;
+    row.khs += (double)runner.hashes * 1000.0 / runner.elapsed_us;
+    if (runner.elapsed_us / 1000 > row.elapsed_ms)
+      row.elapsed_ms = runner.elapsed_us / 1000;
+  }
+  Serial.printf("[BENCH] %-8s %d task%s wifi %-3s display %-3s %8.2f KH/s\n", s_engines[engine].name, tasks, tasks > 1 ? "s" : " ",
+                wifi ? "on" : "off", display ? "on" : "off", row.khs);
+  if (s_row_count < BENCH_ROWS)
+    s_rows[s_row_count++] = row;
+}
+
+static void BenchWifiTask(void* param)
+{
+  static uint8_t datagram[BENCH_DATAGRAM_SIZE];
+  WiFiUDP udp;
+  IPAddress gateway = WiFi.gatewayIP();
+  while (!s_load_stop)
+  {
+    udp.beginPacket(gateway, BENCH_DISCARD_PORT);
+    udp.write(datagram, sizeof(datagram));
+    udp.endPacket();
+    vTaskDelay(BENCH_WIFI_ms / portTICK_PERIOD_MS);
+  }
+  s_loads--;
+  vTaskDelete(NULL);
+}
+
+static void BenchDisplayTask(void* param)
+{
+  while (!s_load_stop)
+  {
+    drawLoadingScreen();
+    vTaskDelay(BENCH_DISPLAY_ms / portTICK_PERIOD_MS);
+  }
+  s_loads--;
+  vTaskDelete(NULL);
+}
+
+static void BenchLoadsStart(bool wifi, bool display)
+{
+  s_load_stop = false;
+  if (wifi)
+  {
+    s_loads++;
+    xTaskCreate(BenchWifiTask, "BenchWifi", 4096, NULL, 2, NULL);
+  }
+  if (display)
+  {
+    //Where and how the monitor task draws
+    s_loads++;
+    xTaskCreatePinnedToCore(BenchDisplayTask, "BenchDisplay", 8192, NULL, 5, NULL, portNUM_PROCESSORS - 1);
+  }
+}
+
+static void BenchLoadsStop(void)
+{
+  s_load_stop = true;
+  while (s_loads > 0)
+    delay(10);
+}
+
+static bool BenchWifiConnect(void)
+{
+  //Credentials saved by the WiFi manager
+  WiFi.mode(WIFI_STA);
+  WiFi.begin();
+  uint32_t start = millis();
+  while (WiFi.status() != WL_CONNECTED && millis() - start < BENCH_WIFI_CONNECT_ms)
+    delay(100);
+  return WiFi.status() == WL_CONNECTED;
+}
+
+static void BenchPrintTable(uint32_t seconds, const bool* checks)
+{
+  uint32_t mhz = getCpuFrequencyMhz();
+  Serial.printf("[BENCH] results, %s rev %d, %d cores, %u MHz, firmware %s, %us per run\n", ESP.getChipModel(), (int)ESP.getChipRevision(),
+                (int)portNUM_PROCESSORS, (unsigned)mhz, CURRENT_VERSION, (unsigned)seconds);
+  Serial.println("chip,firmware,mhz,engine,tasks,wifi,display,seconds,hashes,khs,check");
+  for (int i = 0; i < s_row_count; ++i)
+  {
+    const bench_row& row = s_rows[i];
+    Serial.printf("%s,%s,%u,%s,%d,%s,%s,%.2f,%llu,%.2f,%s\n", ESP.getChipModel(), CURRENT_VERSION, (unsigned)mhz, s_engines[row.engine].name,
+                  (int)row.tasks, row.wifi ? "on" : "off", row.display ? "on" : "off", row.elapsed_ms / 1000.0,
+                  (unsigned long long)row.hashes, row.khs, checks[row.engine] ? "ok" : "fail");
+  }
+  Serial.println("[BENCH] end");
+}
+
+static void BenchRunAll(uint32_t seconds)
+{
+  bool checks[BENCH_ENGINES];
+  bool screen = currentDisplayDriver && currentDisplayDriver->screenWidth > 0;
+  s_row_count = 0;
+
+  Serial.printf("[BENCH] %d engines, %us per run\n", (int)BENCH_ENGINES, (unsigned)seconds);
+  BenchPrepare();
+  for (int e = 0; e < (int)BENCH_ENGINES; ++e)
+  {
+    checks[e] = BenchCheck(s_engines[e]);
+    if (!checks[e])
+      Serial.printf("[BENCH] %s: wrong hash of the test header\n", s_engines[e].name);
+  }
+
+  for (int wifi = 0; wifi < 2; ++wifi)
+  {
+    if (wifi && !BenchWifiConnect())
+    {
+      Serial.println("[BENCH] Not connected to the saved access point, no runs with WiFi");
+      break;
+    }
+    for (int display = 0; display < (screen ? 2 : 1); ++display)
+    {
+      BenchLoadsStart(wifi, display);
+      for (int tasks = 1; tasks <= portNUM_PROCESSORS && tasks <= 2; ++tasks)
+        for (int e = 0; e < (int)BENCH_ENGINES; ++e)
+          BenchRun(e, tasks, wifi, display, seconds);
+      BenchLoadsStop();
+    }
+  }
+  WiFi.disconnect(true);
+
+  BenchPrintTable(seconds, checks);
+}
+
+void sha_benchmark_boot(void)
+{
+  //RTC memory survives esp_restart, not a power cycle
+  bool requested = s_bench_request == BENCH_REQUEST_MAGIC;
+  uint32_t seconds = requested ? s_bench_seconds : SHA_BENCHMARK_SECONDS;
+  s_bench_request = 0;
+#ifndef SHA_BENCHMARK_BOOT
+  if (!requested)
+    return;
+#endif
+  if (seconds == 0 || seconds > BENCH_SECONDS_MAX)
+    seconds = SHA_BENCHMARK_SECONDS;
+  BenchRunAll(seconds);
+}
+
+void sha_benchmark_command(const char* args)
+{
+  uint32_t seconds = *args ? (uint32_t)atoi(args) : SHA_BENCHMARK_SECONDS;
+  if (seconds == 0 || seconds > BENCH_SECONDS_MAX)
+  {
+    Serial.printf("bench [seconds]: 1 to %d seconds per run\n", BENCH_SECONDS_MAX);
+    return;
+  }
+  //The miners would share the cores, the benchmark runs alone before they start
+  Serial.printf("[BENCH] Restarting into the benchmark, %us per run\n", (unsigned)seconds);
+  s_bench_seconds = seconds;
+  s_bench_request = BENCH_REQUEST_MAGIC;
+  Serial.flush();
+  delay(100);
+  esp_restart();
+}
+
+#endif // SHA_BENCHMARK
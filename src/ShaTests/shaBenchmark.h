@@ -0,0 +1,49 @@
+#ifndef SHA_BENCHMARK_H
+#define SHA_BENCHMARK_H
+
+#include <Arduino.h>
+
+/************************************************************************************
+*   Benchmark of the sha256d engines of the board, before the miner starts.
+*
+*   Each engine the chip has hashes the nonces of a test header for
+*   SHA_BENCHMARK_SECONDS per run:
+*
+*     sw_baked   nerd_sha256d_baked, the software miner
+*     sw_plain   nerd_sha256d
+*     mbedtls    mbedtls_sha256 of the whole header, twice
+*     hw_s3      SHA engine, midstate written back (S2, S3, C3), the hardware miner
+*     hw_esp32   SHA engine, whole header (ESP32), the hardware miner
+*     dma        SHA engine fed by GDMA (S3, C3)
+*
+*   with one task pinned to core 1 and with one task on each core, each with the
+*   radio off and associated to the saved access point sending UDP to the gateway,
+*   and with the screen idle and redrawn like the monitor task does. Before its runs
+*   an engine hashes the nonce of a known header, "check" says whether it matched.
+*
+*   The table comes out as CSV between "[BENCH]" markers, one line per run with the
+*   chip, the firmware and the CPU clock so the boards and versions can be compared.
+*   The normal boot goes on afterwards.
+*
+*   Runs from the serial console "bench [seconds]", which restarts into it, and on
+*   every boot when also built with -D SHA_BENCHMARK_BOOT.
+*
+*   Build with -D SHA_BENCHMARK
+*************************************************************************************/
+
+#ifdef SHA_BENCHMARK
+
+#ifndef SHA_BENCHMARK_SECONDS
+#define SHA_BENCHMARK_SECONDS   3
+#endif
+
+//setup(), after the display is up and before the WiFi manager: runs the benchmark
+//when built with SHA_BENCHMARK_BOOT or asked by "bench"
+void sha_benchmark_boot(void);
+
+//Serial console "bench [seconds]"
+void sha_benchmark_command(const char* args);
+
+#endif // SHA_BENCHMARK
+
+#endif // SHA_BENCHMARK_H
@@ -0,0 +1,236 @@
+#include <string.h>
+#include "chachapoly.h"
+
+//////////////////////////// ChaCha20 ///////////////////////////////
+
+static inline uint32_t Load32(const uint8_t* p)
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline void Store32(uint8_t* p, uint32_t v)
+{
+  p[0] = v;
+  p[1] = v >> 8;
+  p[2] = v >> 16;
+  p[3] = v >> 24;
+}
+
+#define ROTL32(v, n) (((v) << (n)) | ((v) >> (32 - (n))))
+#define QUARTERROUND(a, b, c, d) \
+  a += b; d ^= a; d = ROTL32(d, 16); \
+  c += d; b ^= c; b = ROTL32(b, 12); \
+  a += b; d ^= a; d = ROTL32(d, 8);  \
+  c += d; b ^= c; b = ROTL32(b, 7);
+
+static void ChaChaBlock(uint8_t out[64], const uint8_t key[32], uint32_t counter, const uint8_t nonce[12])
+{
+  uint32_t state[16], x[16];
+  state[0] = 0x61707865;
+  state[1] = 0x3320646e;
+  state[2] = 0x79622d32;
+  state[3] = 0x6b206574;
+  for (int i = 0; i < 8; ++i)
+    state[4 + i] = Load32(key + 4*i);
+  state[12] = counter;
+  for (int i = 0; i < 3; ++i)
+    state[13 + i] = Load32(nonce + 4*i);
+
+  memcpy(x, state, sizeof(x));
+  for (int i = 0; i < 10; ++i)
+  {
+    QUARTERROUND(x[0], x[4], x[8],  x[12]);
+    QUARTERROUND(x[1], x[5], x[9],  x[13]);
+    QUARTERROUND(x[2], x[6], x[10], x[14]);
+    QUARTERROUND(x[3], x[7], x[11], x[15]);
+    QUARTERROUND(x[0], x[5], x[10], x[15]);
+    QUARTERROUND(x[1], x[6], x[11], x[12]);
+    QUARTERROUND(x[2], x[7], x[8],  x[13]);
+    QUARTERROUND(x[3], x[4], x[9],  x[14]);
+  }
+  for (int i = 0; i < 16; ++i)
+    Store32(out + 4*i, x[i] + state[i]);
+}
+
+//Keystream from block 1 on, block 0 keys Poly1305
+static void ChaChaXor(const uint8_t key[32], const uint8_t nonce[12], const uint8_t* in, size_t len, uint8_t* out)
+{
+  uint8_t block[64];
+  uint32_t counter = 1;
+  while (len > 0)
+  {
+    ChaChaBlock(block, key, counter++, nonce);
+    size_t n = len < 64 ? len : 64;
+    for (size_t i = 0; i < n; ++i)
+      out[i] = in[i] ^ block[i];
+    in += n;
+    out += n;
+    len -= n;
+  }
+}
+
+//////////////////////////// Poly1305 ///////////////////////////////
+
+typedef struct {
+  uint32_t r[5], h[5], pad[4];
+  uint8_t buffer[16];
+  size_t used;
+} poly1305_state;
+
+static void PolyInit(poly1305_state &st, const uint8_t key[32])
+{
+  st.r[0] = (Load32(key + 0)) & 0x3ffffff;
+  st.r[1] = (Load32(key + 3) >> 2) & 0x3ffff03;
+  st.r[2] = (Load32(key + 6) >> 4) & 0x3ffc0ff;
+  st.r[3] = (Load32(key + 9) >> 6) & 0x3f03fff;
+  st.r[4] = (Load32(key + 12) >> 8) & 0x00fffff;
+  memset(st.h, 0, sizeof(st.h));
+  for (int i = 0; i < 4; ++i)
+    st.pad[i] = Load32(key + 16 + 4*i);
+  st.used = 0;
+}
+
+static void PolyBlock(poly1305_state &st, const uint8_t* m, uint32_t hibit)
+{
+  const uint32_t r0 = st.r[0], r1 = st.r[1], r2 = st.r[2], r3 = st.r[3], r4 = st.r[4];
+  const uint32_t s1 = r1 * 5, s2 = r2 * 5, s3 = r3 * 5, s4 = r4 * 5;
+  uint32_t h0 = st.h[0], h1 = st.h[1], h2 = st.h[2], h3 = st.h[3], h4 = st.h[4];
+
+  h0 += (Load32(m + 0)) & 0x3ffffff;
+  h1 += (Load32(m + 3) >> 2) & 0x3ffffff;
+  h2 += (Load32(m + 6) >> 4) & 0x3ffffff;
+  h3 += (Load32(m + 9) >> 6) & 0x3ffffff;
+  h4 += (Load32(m + 12) >> 8) | hibit;
+
+  uint64_t d0 = (uint64_t)h0 * r0 + (uint64_t)h1 * s4 + (uint64_t)h2 * s3 + (uint64_t)h3 * s2 + (uint64_t)h4 * s1;
+  uint64_t d1 = (uint64_t)h0 * r1 + (uint64_t)h1 * r0 + (uint64_t)h2 * s4 + (uint64_t)h3 * s3 + (uint64_t)h4 * s2;
+  uint64_t d2 = (uint64_t)h0 * r2 + (uint64_t)h1 * r1 + (uint64_t)h2 * r0 + (uint64_t)h3 * s4 + (uint64_t)h4 * s3;
+  uint64_t d3 = (uint64_t)h0 * r3 + (uint64_t)h1 * r2 + (uint64_t)h2 * r1 + (uint64_t)h3 * r0 + (uint64_t)h4 * s4;
+  uint64_t d4 = (uint64_t)h0 * r4 + (uint64_t)h1 * r3 + (uint64_t)h2 * r2 + (uint64_t)h3 * r1 + (uint64_t)h4 * r0;
+
+  uint32_t c;
+  c = (uint32_t)(d0 >> 26); h0 = (uint32_t)d0 & 0x3ffffff;
+  d1 += c; c = (uint32_t)(d1 >> 26); h1 = (uint32_t)d1 & 0x3ffffff;
+  d2 += c; c = (uint32_t)(d2 >> 26); h2 = (uint32_t)d2 & 0x3ffffff;
+  d3 += c; c = (uint32_t)(d3 >> 26); h3 = (uint32_t)d3 & 0x3ffffff;
+  d4 += c; c = (uint32_t)(d4 >> 26); h4 = (uint32_t)d4 & 0x3ffffff;
+  h0 += c * 5; c = h0 >> 26; h0 &= 0x3ffffff;
+  h1 += c;
+
+  st.h[0] = h0; st.h[1] = h1; st.h[2] = h2; st.h[3] = h3; st.h[4] = h4;
+}
+
+static void PolyUpdate(poly1305_state &st, const uint8_t* m, size_t len)
+{
+  while (len > 0)
+  {
+    size_t n = 16 - st.used;
+    if (n > len)
+      n = len;
+    memcpy(st.buffer + st.used, m, n);
+    st.used += n;
+    m += n;
+    len -= n;
+    if (st.used == 16)
+    {
+      PolyBlock(st, st.buffer, 1 << 24);
+      st.used = 0;
+    }
+  }
+}
+
+//AEAD inputs are zero padded to whole blocks
+static void PolyPad16(poly1305_state &st)
+{
+  static const uint8_t zeros[16] = { 0 };
+  if (st.used > 0)
+    PolyUpdate(st, zeros, 16 - st.used);
+}
+
+static void PolyFinish(poly1305_state &st, uint8_t tag[16])
+{
+  if (st.used > 0)
+  {
+    st.buffer[st.used++] = 1;
+    memset(st.buffer + st.used, 0, 16 - st.used);
+    PolyBlock(st, st.buffer, 0);
+  }
+
+  uint32_t h0 = st.h[0], h1 = st.h[1], h2 = st.h[2], h3 = st.h[3], h4 = st.h[4], c;
+  c = h1 >> 26; h1 &= 0x3ffffff;
+  h2 += c; c = h2 >> 26; h2 &= 0x3ffffff;
+  h3 += c; c = h3 >> 26; h3 &= 0x3ffffff;
+  h4 += c; c = h4 >> 26; h4 &= 0x3ffffff;
+  h0 += c * 5; c = h0 >> 26; h0 &= 0x3ffffff;
+  h1 += c;
+
+  //h - p, kept if it didn't go negative
+  uint32_t g0 = h0 + 5; c = g0 >> 26; g0 &= 0x3ffffff;
+  uint32_t g1 = h1 + c; c = g1 >> 26; g1 &= 0x3ffffff;
+  uint32_t g2 = h2 + c; c = g2 >> 26; g2 &= 0x3ffffff;
+  uint32_t g3 = h3 + c; c = g3 >> 26; g3 &= 0x3ffffff;
+  uint32_t g4 = h4 + c - (1 << 26);
+  uint32_t mask = (g4 >> 31) - 1;
+  h0 = (h0 & ~mask) | (g0 & mask);
+  h1 = (h1 & ~mask) | (g1 & mask);
+  h2 = (h2 & ~mask) | (g2 & mask);
+  h3 = (h3 & ~mask) | (g3 & mask);
+  h4 = (h4 & ~mask) | (g4 & mask);
+
+  h0 = h0 | (h1 << 26);
+  h1 = (h1 >> 6) | (h2 << 20);
+  h2 = (h2 >> 12) | (h3 << 14);
+  h3 = (h3 >> 18) | (h4 << 8);
+
+  uint64_t f;
+  f = (uint64_t)h0 + st.pad[0];             Store32(tag + 0, (uint32_t)f);
+  f = (uint64_t)h1 + st.pad[1] + (f >> 32); Store32(tag + 4, (uint32_t)f);
+  f = (uint64_t)h2 + st.pad[2] + (f >> 32); Store32(tag + 8, (uint32_t)f);
+  f = (uint64_t)h3 + st.pad[3] + (f >> 32); Store32(tag + 12, (uint32_t)f);
+}
+
+static void AeadTag(uint8_t tag[16], const uint8_t key[32], const uint8_t nonce[12], const uint8_t* ad, size_t ad_len,
+                    const uint8_t* ciphertext, size_t len)
+{
+  uint8_t block[64];
+  ChaChaBlock(block, key, 0, nonce);
+  poly1305_state st;
+  PolyInit(st, block);
+  memset(block, 0, sizeof(block));
+
+  PolyUpdate(st, ad, ad_len);
+  PolyPad16(st);
+  PolyUpdate(st, ciphertext, len);
+  PolyPad16(st);
+  uint8_t lengths[16];
+  Store32(lengths, (uint32_t)ad_len);
+  Store32(lengths + 4, 0);
+  Store32(lengths + 8, (uint32_t)len);
+  Store32(lengths + 12, 0);
+  PolyUpdate(st, lengths, 16);
+  PolyFinish(st, tag);
+}
+
+void chachapoly_seal(const uint8_t key[32], const uint8_t nonce[12], const uint8_t* ad, size_t ad_len,
+                     const uint8_t* in, size_t len, uint8_t* out)
+{
+  ChaChaXor(key, nonce, in, len, out);
+  AeadTag(out + len, key, nonce, ad, ad_len, out, len);
+}
+
+bool chachapoly_open(const uint8_t key[32], const uint8_t nonce[12], const uint8_t* ad, size_t ad_len,
+                     const uint8_t* in, size_t len, uint8_t* out)
+{
+  if (len < CHACHAPOLY_TAG_SIZE)
+    return false;
+  len -= CHACHAPOLY_TAG_SIZE;
+  uint8_t tag[16];
+  AeadTag(tag, key, nonce, ad, ad_len, in, len);
+  uint8_t diff = 0;
+  for (int i = 0; i < 16; ++i)
+    diff |= tag[i] ^ in[len + i];
+  if (diff != 0)
+    return false;
+  ChaChaXor(key, nonce, in, len, out);
+  return true;
+}
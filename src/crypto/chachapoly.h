@@ -0,0 +1,22 @@
+/************************************************************************************
+*   ChaCha20-Poly1305 AEAD (RFC 8439), the cipher of the Stratum V2 Noise channel.
+*
+*   Portable C, 32 bit friendly (Poly1305 in 26 bit limbs). The tag is written
+*   after the ciphertext: seal produces len + 16 bytes, open takes them back.
+*************************************************************************************/
+#ifndef CHACHAPOLY_H_
+#define CHACHAPOLY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CHACHAPOLY_TAG_SIZE 16
+
+void chachapoly_seal(const uint8_t key[32], const uint8_t nonce[12], const uint8_t* ad, size_t ad_len,
+                     const uint8_t* in, size_t len, uint8_t* out);
+
+//false (and out untouched) when the tag doesn't match
+bool chachapoly_open(const uint8_t key[32], const uint8_t nonce[12], const uint8_t* ad, size_t ad_len,
+                     const uint8_t* in, size_t len, uint8_t* out);
+
+#endif // CHACHAPOLY_H_
@@ -0,0 +1,718 @@
+#include <string.h>
+#include "mbedtls/sha256.h"
+#include "secp256k1.h"
+
+//256 bit numbers as 8 little endian 32 bit limbs
+typedef struct { uint32_t v[8]; } fe;     //mod p
+typedef struct { uint32_t v[8]; } sc;     //mod n
+typedef struct { fe x, y; } ge;           //Affine point
+typedef struct { fe x, y, z; bool infinity; } gej;  //Jacobian point
+
+static const fe FE_P = {{ 0xFFFFFC2F, 0xFFFFFFFE, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF }};
+static const fe FE_P_MINUS_2 = {{ 0xFFFFFC2D, 0xFFFFFFFE, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF }};
+static const fe FE_SQRT_EXP = {{ 0xBFFFFF0C, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x3FFFFFFF }};  //(p+1)/4
+static const fe FE_HALF = {{ 0x7FFFFE18, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x7FFFFFFF }};      //1/2
+static const fe FE_MINUS_3_SQRT = {{ 0x1CD5F852, 0x7D8D27AE, 0xDA14ECD4, 0xC61F6D15, 0xA797962C, 0x233770C2, 0x3507F1DF, 0x0A2D2BA9 }};  //(-3)^((p+1)/4)
+static const sc SC_N = {{ 0xD0364141, 0xBFD25E8C, 0xAF48A03B, 0xBAAEDCE6, 0xFFFFFFFE, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF }};
+static const ge G = {
+  {{ 0x16F81798, 0x59F2815B, 0x2DCE28D9, 0x029BFCDB, 0xCE870B07, 0x55A06295, 0xF9DCBBAC, 0x79BE667E }},
+  {{ 0xFB10D4B8, 0x9C47D08F, 0xA6855419, 0xFD17B448, 0x0E1108A8, 0x5DA4FBFC, 0x26A3C465, 0x483ADA77 }}
+};
+
+//////////////////////////// 256 bit helpers ///////////////////////////////
+
+static uint32_t bn_add(uint32_t* r, const uint32_t* a, const uint32_t* b)
+{
+  uint64_t c = 0;
+  for (int i = 0; i < 8; ++i)
+  {
+    c += (uint64_t)a[i] + b[i];
+    r[i] = (uint32_t)c;
+    c >>= 32;
+  }
+  return (uint32_t)c;
+}
+
+static uint32_t bn_sub(uint32_t* r, const uint32_t* a, const uint32_t* b)
+{
+  int64_t c = 0;
+  for (int i = 0; i < 8; ++i)
+  {
+    c += (int64_t)a[i] - b[i];
+    r[i] = (uint32_t)c;
+    c >>= 32;
+  }
+  return (uint32_t)(c & 1);
+}
+
+static int bn_cmp(const uint32_t* a, const uint32_t* b)
+{
+  for (int i = 7; i >= 0; --i)
+    if (a[i] != b[i])
+      return a[i] < b[i] ? -1 : 1;
+  return 0;
+}
+
+static bool bn_is_zero(const uint32_t* a)
+{
+  uint32_t z = 0;
+  for (int i = 0; i < 8; ++i)
+    z |= a[i];
+  return z == 0;
+}
+
+static void bn_set_bytes(uint32_t* r, const uint8_t* be32)
+{
+  for (int i = 0; i < 8; ++i)
+    r[i] = ((uint32_t)be32[28 - 4*i] << 24) | ((uint32_t)be32[29 - 4*i] << 16) | ((uint32_t)be32[30 - 4*i] << 8) | be32[31 - 4*i];
+}
+
+static void bn_get_bytes(uint8_t* be32, const uint32_t* a)
+{
+  for (int i = 0; i < 8; ++i)
+  {
+    be32[28 - 4*i] = a[i] >> 24;
+    be32[29 - 4*i] = a[i] >> 16;
+    be32[30 - 4*i] = a[i] >> 8;
+    be32[31 - 4*i] = a[i];
+  }
+}
+
+//////////////////////////// Field mod p ///////////////////////////////
+
+static void fe_set_int(fe &r, uint32_t a)
+{
+  memset(&r, 0, sizeof(r));
+  r.v[0] = a;
+}
+
+//Big endian bytes, reduced mod p
+static void fe_set_bytes(fe &r, const uint8_t* be32)
+{
+  bn_set_bytes(r.v, be32);
+  if (bn_cmp(r.v, FE_P.v) >= 0)
+    bn_sub(r.v, r.v, FE_P.v);
+}
+
+static bool fe_is_zero(const fe &a) { return bn_is_zero(a.v); }
+static bool fe_equal(const fe &a, const fe &b) { return bn_cmp(a.v, b.v) == 0; }
+static bool fe_is_odd(const fe &a) { return a.v[0] & 1; }
+
+static void fe_add(fe &r, const fe &a, const fe &b)
+{
+  uint32_t carry = bn_add(r.v, a.v, b.v);
+  if (carry || bn_cmp(r.v, FE_P.v) >= 0)
+    bn_sub(r.v, r.v, FE_P.v);
+}
+
+static void fe_sub(fe &r, const fe &a, const fe &b)
+{
+  if (bn_sub(r.v, a.v, b.v))
+    bn_add(r.v, r.v, FE_P.v);
+}
+
+static void fe_neg(fe &r, const fe &a)
+{
+  fe zero;
+  fe_set_int(zero, 0);
+  fe_sub(r, zero, a);
+}
+
+//p = 2^256 - 0x1000003D1: the upper half folds back as hi * 0x3D1 + (hi << 32)
+static void fe_mul(fe &r, const fe &a, const fe &b)
+{
+  uint32_t t[16] = { 0 };
+  for (int i = 0; i < 8; ++i)
+  {
+    uint64_t c = 0;
+    for (int j = 0; j < 8; ++j)
+    {
+      c += (uint64_t)a.v[i] * b.v[j] + t[i + j];
+      t[i + j] = (uint32_t)c;
+      c >>= 32;
+    }
+    t[i + 8] = (uint32_t)c;
+  }
+
+  uint32_t m[8];
+  uint64_t c = 0;
+  for (int i = 0; i < 8; ++i)
+  {
+    c += (uint64_t)t[i] + (uint64_t)t[8 + i] * 0x3D1;
+    if (i > 0)
+      c += t[7 + i];
+    m[i] = (uint32_t)c;
+    c >>= 32;
+  }
+  c += t[15];
+
+  uint64_t d = (uint64_t)m[0] + c * 0x3D1;
+  r.v[0] = (uint32_t)d;
+  d >>= 32;
+  d += (uint64_t)m[1] + c;
+  r.v[1] = (uint32_t)d;
+  d >>= 32;
+  for (int i = 2; i < 8; ++i)
+  {
+    d += m[i];
+    r.v[i] = (uint32_t)d;
+    d >>= 32;
+  }
+  if (d)
+  {
+    //Wrapped, what is left is small
+    uint32_t fold[8] = { 0x3D1, 1, 0, 0, 0, 0, 0, 0 };
+    bn_add(r.v, r.v, fold);
+  }
+  if (bn_cmp(r.v, FE_P.v) >= 0)
+    bn_sub(r.v, r.v, FE_P.v);
+}
+
+static void fe_sqr(fe &r, const fe &a) { fe_mul(r, a, a); }
+
+static void fe_pow(fe &r, const fe &a, const fe &exponent)
+{
+  fe result;
+  fe_set_int(result, 1);
+  for (int bit = 255; bit >= 0; --bit)
+  {
+    fe_sqr(result, result);
+    if ((exponent.v[bit / 32] >> (bit % 32)) & 1)
+      fe_mul(result, result, a);
+  }
+  r = result;
+}
+
+static void fe_inv(fe &r, const fe &a) { fe_pow(r, a, FE_P_MINUS_2); }
+
+//p = 3 mod 4, a^((p+1)/4) is a root when there is one
+static bool fe_sqrt(fe &r, const fe &a)
+{
+  fe root, check;
+  fe_pow(root, a, FE_SQRT_EXP);
+  fe_sqr(check, root);
+  r = root;
+  return fe_equal(check, a);
+}
+
+static void fe_div(fe &r, const fe &a, const fe &b)
+{
+  fe inv;
+  fe_inv(inv, b);
+  fe_mul(r, a, inv);
+}
+
+//x^3 + 7
+static void fe_curve_rhs(fe &r, const fe &x)
+{
+  fe x3, seven;
+  fe_sqr(x3, x);
+  fe_mul(x3, x3, x);
+  fe_set_int(seven, 7);
+  fe_add(r, x3, seven);
+}
+
+static bool fe_is_valid_x(const fe &x)
+{
+  fe rhs, y;
+  fe_curve_rhs(rhs, x);
+  return fe_sqrt(y, rhs);
+}
+
+//////////////////////////// Scalars mod n ///////////////////////////////
+
+//Big endian bytes, false when >= n
+static bool sc_set_bytes(sc &r, const uint8_t* be32)
+{
+  bn_set_bytes(r.v, be32);
+  return bn_cmp(r.v, SC_N.v) < 0;
+}
+
+static void sc_reduce(sc &r, const uint8_t* be32)
+{
+  if (!sc_set_bytes(r, be32))
+    bn_sub(r.v, r.v, SC_N.v);
+}
+
+static void sc_add(sc &r, const sc &a, const sc &b)
+{
+  uint32_t carry = bn_add(r.v, a.v, b.v);
+  if (carry || bn_cmp(r.v, SC_N.v) >= 0)
+    bn_sub(r.v, r.v, SC_N.v);
+}
+
+static void sc_neg(sc &r, const sc &a)
+{
+  if (bn_is_zero(a.v))
+    r = a;
+  else
+    bn_sub(r.v, SC_N.v, a.v);
+}
+
+//Shift and add, only used a couple of times per signature
+static void sc_mul(sc &r, const sc &a, const sc &b)
+{
+  sc result;
+  memset(&result, 0, sizeof(result));
+  for (int bit = 255; bit >= 0; --bit)
+  {
+    sc_add(result, result, result);
+    if ((b.v[bit / 32] >> (bit % 32)) & 1)
+      sc_add(result, result, a);
+  }
+  r = result;
+}
+
+//////////////////////////// Points ///////////////////////////////
+
+static void gej_set_ge(gej &r, const ge &a)
+{
+  r.x = a.x;
+  r.y = a.y;
+  fe_set_int(r.z, 1);
+  r.infinity = false;
+}
+
+static void gej_double(gej &r, const gej &a)
+{
+  if (a.infinity || fe_is_zero(a.y))
+  {
+    r.infinity = true;
+    return;
+  }
+  //dbl-2009-l
+  fe A, B, C, D, E, F, t;
+  fe_sqr(A, a.x);
+  fe_sqr(B, a.y);
+  fe_sqr(C, B);
+  fe_add(t, a.x, B);
+  fe_sqr(t, t);
+  fe_sub(t, t, A);
+  fe_sub(t, t, C);
+  fe_add(D, t, t);
+  fe_add(E, A, A);
+  fe_add(E, E, A);
+  fe_sqr(F, E);
+  fe z3;
+  fe_mul(z3, a.y, a.z);
+  fe_add(r.z, z3, z3);
+  fe x3;
+  fe_sub(x3, F, D);
+  fe_sub(x3, x3, D);
+  fe_sub(t, D, x3);
+  fe_mul(t, E, t);
+  fe_add(C, C, C);
+  fe_add(C, C, C);
+  fe_add(C, C, C);
+  fe_sub(r.y, t, C);
+  r.x = x3;
+  r.infinity = false;
+}
+
+static void gej_add(gej &r, const gej &a, const gej &b)
+{
+  if (a.infinity)
+  {
+    r = b;
+    return;
+  }
+  if (b.infinity)
+  {
+    r = a;
+    return;
+  }
+  //add-2007-bl
+  fe z1z1, z2z2, u1, u2, s1, s2, h, rr, t;
+  fe_sqr(z1z1, a.z);
+  fe_sqr(z2z2, b.z);
+  fe_mul(u1, a.x, z2z2);
+  fe_mul(u2, b.x, z1z1);
+  fe_mul(s1, a.y, b.z);
+  fe_mul(s1, s1, z2z2);
+  fe_mul(s2, b.y, a.z);
+  fe_mul(s2, s2, z1z1);
+  fe_sub(h, u2, u1);
+  fe_sub(rr, s2, s1);
+  if (fe_is_zero(h))
+  {
+    if (fe_is_zero(rr))
+      gej_double(r, a);
+    else
+      r.infinity = true;
+    return;
+  }
+  fe i, j, v;
+  fe_add(i, h, h);
+  fe_sqr(i, i);
+  fe_mul(j, h, i);
+  fe_add(rr, rr, rr);
+  fe_mul(v, u1, i);
+  fe x3, y3, z3;
+  fe_sqr(x3, rr);
+  fe_sub(x3, x3, j);
+  fe_sub(x3, x3, v);
+  fe_sub(x3, x3, v);
+  fe_sub(t, v, x3);
+  fe_mul(y3, rr, t);
+  fe_mul(t, s1, j);
+  fe_add(t, t, t);
+  fe_sub(y3, y3, t);
+  fe_add(z3, a.z, b.z);
+  fe_sqr(z3, z3);
+  fe_sub(z3, z3, z1z1);
+  fe_sub(z3, z3, z2z2);
+  fe_mul(z3, z3, h);
+  r.x = x3;
+  r.y = y3;
+  r.z = z3;
+  r.infinity = false;
+}
+
+//Same double and add sequence whatever the scalar bits are
+static void gej_mul(gej &r, const ge &p, const sc &k)
+{
+  gej result, base, sum;
+  result.infinity = true;
+  gej_set_ge(base, p);
+  for (int bit = 255; bit >= 0; --bit)
+  {
+    gej_double(result, result);
+    gej_add(sum, result, base);
+    if ((k.v[bit / 32] >> (bit % 32)) & 1)
+      result = sum;
+  }
+  r = result;
+}
+
+static bool gej_to_ge(ge &r, const gej &a)
+{
+  if (a.infinity)
+    return false;
+  fe zi, zi2, zi3;
+  fe_inv(zi, a.z);
+  fe_sqr(zi2, zi);
+  fe_mul(zi3, zi2, zi);
+  fe_mul(r.x, a.x, zi2);
+  fe_mul(r.y, a.y, zi3);
+  return true;
+}
+
+//Point with this x and an even y
+static bool ge_lift_x(ge &r, const fe &x)
+{
+  fe rhs;
+  fe_curve_rhs(rhs, x);
+  if (!fe_sqrt(r.y, rhs))
+    return false;
+  r.x = x;
+  if (fe_is_odd(r.y))
+    fe_neg(r.y, r.y);
+  return true;
+}
+
+static bool ge_from_seckey(ge &r, sc &k, const uint8_t* seckey)
+{
+  if (!sc_set_bytes(k, seckey) || bn_is_zero(k.v))
+    return false;
+  gej p;
+  gej_mul(p, G, k);
+  return gej_to_ge(r, p);
+}
+
+//////////////////////////// Hashes ///////////////////////////////
+
+void secp256k1_tagged_hash(uint8_t out32[32], const char* tag, const uint8_t* data, size_t len)
+{
+  uint8_t tag_hash[32];
+  mbedtls_sha256_ret((const unsigned char*)tag, strlen(tag), tag_hash, 0);
+  mbedtls_sha256_context ctx;
+  mbedtls_sha256_init(&ctx);
+  mbedtls_sha256_starts_ret(&ctx, 0);
+  mbedtls_sha256_update_ret(&ctx, tag_hash, 32);
+  mbedtls_sha256_update_ret(&ctx, tag_hash, 32);
+  mbedtls_sha256_update_ret(&ctx, data, len);
+  mbedtls_sha256_finish_ret(&ctx, out32);
+  mbedtls_sha256_free(&ctx);
+}
+
+//////////////////////////// Keys ///////////////////////////////
+
+bool secp256k1_pubkey_xonly(uint8_t xonly[32], const uint8_t seckey[32])
+{
+  ge p;
+  sc k;
+  if (!ge_from_seckey(p, k, seckey))
+    return false;
+  bn_get_bytes(xonly, p.x.v);
+  return true;
+}
+
+//////////////////////////// ElligatorSwift (BIP324) ///////////////////////////////
+
+static void XSwiftEC(fe &x, const fe &u_in, const fe &t_in)
+{
+  fe u = u_in, t = t_in, one, seven, u3, t2, s;
+  fe_set_int(one, 1);
+  fe_set_int(seven, 7);
+  if (fe_is_zero(u))
+    u = one;
+  if (fe_is_zero(t))
+    t = one;
+  fe_sqr(u3, u);
+  fe_mul(u3, u3, u);
+  fe_sqr(t2, t);
+  fe_add(s, u3, t2);
+  fe_add(s, s, seven);
+  if (fe_is_zero(s))
+  {
+    fe_add(t, t, t);
+    fe_sqr(t2, t);
+  }
+
+  //X = (u^3 + 7 - t^2) / 2t, Y = (X + t) / (sqrt(-3) u)
+  fe X, Y, num, den;
+  fe_add(num, u3, seven);
+  fe_sub(num, num, t2);
+  fe_add(den, t, t);
+  fe_div(X, num, den);
+  fe_add(num, X, t);
+  fe_mul(den, FE_MINUS_3_SQRT, u);
+  fe_div(Y, num, den);
+
+  //u + 4Y^2, (-X/Y - u)/2, (X/Y - u)/2: the first one on the curve
+  fe_sqr(x, Y);
+  fe_add(x, x, x);
+  fe_add(x, x, x);
+  fe_add(x, x, u);
+  if (fe_is_valid_x(x))
+    return;
+  fe xy;
+  fe_div(xy, X, Y);
+  fe_neg(x, xy);
+  fe_sub(x, x, u);
+  fe_mul(x, x, FE_HALF);
+  if (fe_is_valid_x(x))
+    return;
+  fe_sub(x, xy, u);
+  fe_mul(x, x, FE_HALF);
+}
+
+//One of the t for which XSwiftEC(u, t) = x, false when this u/case has none
+static bool XSwiftECInv(fe &t, const fe &x, const fe &u, int c)
+{
+  fe v, s, w, seven, u2, u3, tmp;
+  fe_set_int(seven, 7);
+  fe_sqr(u2, u);
+  fe_mul(u3, u2, u);
+  if ((c & 2) == 0)
+  {
+    //-x - u must not be on the curve
+    fe_add(tmp, x, u);
+    fe_neg(tmp, tmp);
+    if (fe_is_valid_x(tmp))
+      return false;
+    v = x;
+    //s = -(u^3 + 7) / (u^2 + uv + v^2)
+    fe den, uv, v2;
+    fe_mul(uv, u, v);
+    fe_sqr(v2, v);
+    fe_add(den, u2, uv);
+    fe_add(den, den, v2);
+    if (fe_is_zero(den))
+      return false;
+    fe_add(tmp, u3, seven);
+    fe_neg(tmp, tmp);
+    fe_div(s, tmp, den);
+  } else
+  {
+    fe_sub(s, x, u);
+    if (fe_is_zero(s))
+      return false;
+    //r = sqrt(-s (4 (u^3 + 7) + 3 s u^2))
+    fe a, b, r;
+    fe_add(a, u3, seven);
+    fe_add(a, a, a);
+    fe_add(a, a, a);
+    fe_mul(b, s, u2);
+    fe_add(tmp, b, b);
+    fe_add(b, tmp, b);
+    fe_add(a, a, b);
+    fe_mul(a, a, s);
+    fe_neg(a, a);
+    if (!fe_sqrt(r, a))
+      return false;
+    if ((c & 1) && fe_is_zero(r))
+      return false;
+    if (c & 1)
+      fe_neg(r, r);
+    //v = (r/s - u) / 2
+    fe_div(v, r, s);
+    fe_sub(v, v, u);
+    fe_mul(v, v, FE_HALF);
+  }
+  if (!fe_sqrt(w, s))
+    return false;
+
+  //t = +-w (u (1 -+ sqrt(-3)) / 2 + v)
+  fe one, k;
+  fe_set_int(one, 1);
+  if (c & 1)
+    fe_add(k, one, FE_MINUS_3_SQRT);
+  else
+    fe_sub(k, one, FE_MINUS_3_SQRT);
+  fe_mul(k, k, u);
+  fe_mul(k, k, FE_HALF);
+  fe_add(k, k, v);
+  fe_mul(t, w, k);
+  if ((c & 5) == 0 || (c & 5) == 5)
+    fe_neg(t, t);
+  return true;
+}
+
+bool secp256k1_ellswift_create(uint8_t ell64[64], const uint8_t seckey[32], const uint8_t rnd32[32])
+{
+  ge p;
+  sc k;
+  if (!ge_from_seckey(p, k, seckey))
+    return false;
+
+  //Candidate u and case from SHA256(rnd32 || counter), about 1 in 4 works
+  uint8_t seed[36];
+  memcpy(seed, rnd32, 32);
+  for (uint32_t counter = 0; counter < 1024; ++counter)
+  {
+    uint8_t h[32];
+    memcpy(seed + 32, &counter, 4);
+    mbedtls_sha256_ret(seed, sizeof(seed), h, 0);
+    int c = h[31] & 7;
+    h[31] &= 0xF8;
+    fe u, t, check;
+    fe_set_bytes(u, h);
+    if (fe_is_zero(u) || !XSwiftECInv(t, p.x, u, c))
+      continue;
+    XSwiftEC(check, u, t);
+    if (!fe_equal(check, p.x))
+      continue;
+    bn_get_bytes(ell64, u.v);
+    bn_get_bytes(ell64 + 32, t.v);
+    return true;
+  }
+  return false;
+}
+
+void secp256k1_ellswift_decode(uint8_t x[32], const uint8_t ell64[64])
+{
+  fe u, t, r;
+  fe_set_bytes(u, ell64);
+  fe_set_bytes(t, ell64 + 32);
+  XSwiftEC(r, u, t);
+  bn_get_bytes(x, r.v);
+}
+
+bool secp256k1_ellswift_xdh(uint8_t out32[32], const uint8_t ell_a64[64], const uint8_t ell_b64[64], const uint8_t seckey[32], bool party_b)
+{
+  sc k;
+  if (!sc_set_bytes(k, seckey) || bn_is_zero(k.v))
+    return false;
+  uint8_t x[32];
+  fe fx;
+  ge theirs;
+  secp256k1_ellswift_decode(x, party_b ? ell_a64 : ell_b64);
+  fe_set_bytes(fx, x);
+  if (!ge_lift_x(theirs, fx))
+    return false;
+
+  //x(k P) does not depend on the sign of P
+  gej shared;
+  ge affine;
+  gej_mul(shared, theirs, k);
+  if (!gej_to_ge(affine, shared))
+    return false;
+
+  uint8_t data[64 + 64 + 32];
+  memcpy(data, ell_a64, 64);
+  memcpy(data + 64, ell_b64, 64);
+  bn_get_bytes(data + 128, affine.x.v);
+  secp256k1_tagged_hash(out32, "bip324_ellswift_xonly_ecdh", data, sizeof(data));
+  memset(data + 128, 0, 32);
+  return true;
+}
+
+//////////////////////////// Schnorr (BIP340) ///////////////////////////////
+
+static void SchnorrChallenge(sc &e, const uint8_t* r32, const uint8_t* xonly, const uint8_t* msg32)
+{
+  uint8_t data[96], h[32];
+  memcpy(data, r32, 32);
+  memcpy(data + 32, xonly, 32);
+  memcpy(data + 64, msg32, 32);
+  secp256k1_tagged_hash(h, "BIP0340/challenge", data, sizeof(data));
+  sc_reduce(e, h);
+}
+
+bool secp256k1_schnorr_sign(uint8_t sig64[64], const uint8_t msg32[32], const uint8_t seckey[32], const uint8_t aux32[32])
+{
+  ge p;
+  sc d;
+  if (!ge_from_seckey(p, d, seckey))
+    return false;
+  if (fe_is_odd(p.y))
+    sc_neg(d, d);
+  uint8_t px[32], t[32], h[32];
+  bn_get_bytes(px, p.x.v);
+  bn_get_bytes(t, d.v);
+  secp256k1_tagged_hash(h, "BIP0340/aux", aux32, 32);
+  for (int i = 0; i < 32; ++i)
+    t[i] ^= h[i];
+
+  uint8_t data[96];
+  memcpy(data, t, 32);
+  memcpy(data + 32, px, 32);
+  memcpy(data + 64, msg32, 32);
+  secp256k1_tagged_hash(h, "BIP0340/nonce", data, sizeof(data));
+  sc k;
+  sc_reduce(k, h);
+  if (bn_is_zero(k.v))
+    return false;
+  gej rj;
+  ge r;
+  gej_mul(rj, G, k);
+  gej_to_ge(r, rj);
+  if (fe_is_odd(r.y))
+    sc_neg(k, k);
+  bn_get_bytes(sig64, r.x.v);
+
+  sc e, s;
+  SchnorrChallenge(e, sig64, px, msg32);
+  sc_mul(s, e, d);
+  sc_add(s, s, k);
+  bn_get_bytes(sig64 + 32, s.v);
+  return true;
+}
+
+bool secp256k1_schnorr_verify(const uint8_t sig64[64], const uint8_t msg32[32], const uint8_t xonly[32])
+{
+  fe px, rx;
+  ge p;
+  bn_set_bytes(px.v, xonly);
+  if (bn_cmp(px.v, FE_P.v) >= 0 || !ge_lift_x(p, px))
+    return false;
+  bn_set_bytes(rx.v, sig64);
+  if (bn_cmp(rx.v, FE_P.v) >= 0)
+    return false;
+  sc s, e;
+  if (!sc_set_bytes(s, sig64 + 32))
+    return false;
+
+  //R = sG - eP
+  SchnorrChallenge(e, sig64, xonly, msg32);
+  sc_neg(e, e);
+  gej sg, ep, rj;
+  gej_mul(sg, G, s);
+  gej_mul(ep, p, e);
+  gej_add(rj, sg, ep);
+  ge r;
+  if (!gej_to_ge(r, rj) || fe_is_odd(r.y))
+    return false;
+  return fe_equal(r.x, rx);
+}
@@ -0,0 +1,38 @@
+/************************************************************************************
+*   Minimal secp256k1 for the Stratum V2 Noise handshake.
+*
+*   Keys on the wire are ElligatorSwift encodings (BIP324, 64 bytes) and the shared
+*   secret is the BIP324 x-only ECDH hash. The pool certificate is a BIP340 Schnorr
+*   signature from the authority key. Plain 32 bit limbs, no tables: a handshake
+*   costs a few scalar multiplications, once per connection.
+*
+*   Scalar multiplication runs the same double and add sequence for every key, but
+*   the field code is not hardened against timing or power analysis.
+*************************************************************************************/
+#ifndef SECP256K1_H_
+#define SECP256K1_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+//x-only public key (BIP340) of a 32 byte big endian secret key, false if the key is 0 or >= n
+bool secp256k1_pubkey_xonly(uint8_t xonly[32], const uint8_t seckey[32]);
+
+//ElligatorSwift encoding of the public key, rnd32 picks one of the many encodings
+bool secp256k1_ellswift_create(uint8_t ell64[64], const uint8_t seckey[32], const uint8_t rnd32[32]);
+
+//x coordinate of an ElligatorSwift encoded key (every 64 byte string decodes to a point)
+void secp256k1_ellswift_decode(uint8_t x[32], const uint8_t ell64[64]);
+
+//BIP324 ECDH: tagged hash of both encodings and the shared x. ell_a is the initiator
+//key, ell_b the responder one, party_b tells which of them seckey belongs to.
+bool secp256k1_ellswift_xdh(uint8_t out32[32], const uint8_t ell_a64[64], const uint8_t ell_b64[64], const uint8_t seckey[32], bool party_b);
+
+//BIP340 Schnorr signatures over a 32 byte message
+bool secp256k1_schnorr_sign(uint8_t sig64[64], const uint8_t msg32[32], const uint8_t seckey[32], const uint8_t aux32[32]);
+bool secp256k1_schnorr_verify(const uint8_t sig64[64], const uint8_t msg32[32], const uint8_t xonly[32]);
+
+//SHA256(SHA256(tag) || SHA256(tag) || data)
+void secp256k1_tagged_hash(uint8_t out32[32], const char* tag, const uint8_t* data, size_t len);
+
+#endif // SECP256K1_H_
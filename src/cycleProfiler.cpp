@@ -0,0 +1,100 @@
+#include <Arduino.h>
+#include <atomic>
+#include <mutex>
+#include "cycleProfiler.h"
+#include "logger.h"
+
+#ifdef CYCLE_PROFILER
+
+enum {
+  NETWORK_QUIET = 0,
+  NETWORK_TRAFFIC,
+  NETWORK_STATES
+};
+
+typedef struct {
+  uint64_t cycles;
+  uint64_t hashes;
+  uint32_t batches;
+  uint32_t min;           //Cycles per hash of the best batch
+  uint32_t max;
+} cycles_slot;
+
+static const char* const s_kernel_names[CYCLES_KERNELS] = { "sw_baked", "hw_s3", "hw_esp32" };
+static const char* const s_network_names[NETWORK_STATES] = { "quiet", "traffic" };
+
+static cycles_slot s_slots[CYCLES_KERNELS][CYCLES_CORES][NETWORK_STATES];
+static std::mutex s_cycles_mutex;
+static std::atomic<uint32_t> s_traffic{0};
+
+uint32_t cycles_traffic(void)
+{
+  return s_traffic.load(std::memory_order_relaxed);
+}
+
+void cycles_traffic_mark(void)
+{
+  s_traffic.fetch_add(1, std::memory_order_relaxed);
+}
+
+void cycles_add(int kernel, uint32_t cycles, uint32_t hashes, uint32_t traffic)
+{
+  if (hashes == 0)
+    return;
+  int core = xPortGetCoreID();
+  if (core < 0 || core >= CYCLES_CORES)
+    core = CYCLES_CORES - 1;
+  int network = (cycles_traffic() != traffic) ? NETWORK_TRAFFIC : NETWORK_QUIET;
+  uint32_t per_hash = cycles / hashes;
+
+  std::lock_guard<std::mutex> lock(s_cycles_mutex);
+  cycles_slot& slot = s_slots[kernel][core][network];
+  if (slot.batches == 0 || per_hash < slot.min)
+    slot.min = per_hash;
+  if (per_hash > slot.max)
+    slot.max = per_hash;
+  slot.cycles += cycles;
+  slot.hashes += hashes;
+  slot.batches++;
+}
+
+void cycles_command(const char* args)
+{
+  if (strcmp(args, "reset") == 0)
+  {
+    std::lock_guard<std::mutex> lock(s_cycles_mutex);
+    memset(s_slots, 0, sizeof(s_slots));
+    Serial.println("[CYCLES] reset");
+    return;
+  }
+
+  static cycles_slot slots[CYCLES_KERNELS][CYCLES_CORES][NETWORK_STATES];
+  {
+    std::lock_guard<std::mutex> lock(s_cycles_mutex);
+    memcpy(slots, s_slots, sizeof(slots));
+  }
+#ifdef NERDMINER_HOST
+  uint32_t mhz = 0;
+#else
+  uint32_t mhz = getCpuFrequencyMhz();
+#endif
+  //The logger waits, the table comes out in one piece
+  logger_hold(true);
+  Serial.printf("[CYCLES] cycles per hash of the miner batches, CPU %u MHz\n", (unsigned)mhz);
+  Serial.println("kernel,core,network,batches,hashes,avg,min,max,khs_at_min");
+  for (int k = 0; k < CYCLES_KERNELS; ++k)
+    for (int c = 0; c < CYCLES_CORES; ++c)
+      for (int n = 0; n < NETWORK_STATES; ++n)
+      {
+        const cycles_slot& slot = slots[k][c][n];
+        if (slot.batches == 0)
+          continue;
+        Serial.printf("%s,%d,%s,%u,%llu,%.1f,%u,%u,%.2f\n", s_kernel_names[k], c, s_network_names[n], (unsigned)slot.batches,
+                      (unsigned long long)slot.hashes, (double)slot.cycles / slot.hashes, (unsigned)slot.min, (unsigned)slot.max,
+                      slot.min ? mhz * 1000.0 / slot.min : 0.0);
+      }
+  Serial.println("[CYCLES] end");
+  logger_hold(false);
+}
+
+#endif // CYCLE_PROFILER
@@ -0,0 +1,82 @@
+#ifndef CYCLE_PROFILER_H
+#define CYCLE_PROFILER_H
+
+#include <Arduino.h>
+
+/************************************************************************************
+*   Cycles per hash of the SHA kernels, instrumentation only.
+*
+*   CYCLES_BEGIN / CYCLES_END read the CPU cycle counter (CCOUNT on Xtensa, the
+*   machine performance counter on the C3) around each batch of nonces a miner task
+*   hashes, and add the cycles to the kernel, the core and the network state of the
+*   batch: "traffic" when the stratum task woke up on pool data meanwhile (our
+*   submits and keepalives get an answer), "quiet" otherwise. The radio still keeps
+*   the access point association in quiet batches.
+*
+*   The average includes whatever preempted the miner during the batch, the best
+*   batch (min) is the kernel alone: compare that one between builds, a change in
+*   the SHA code shows up as a cycle delta rather than a noisy hashrate.
+*
+*   Serial console "cycles [reset]". The host build reads the TSC, its cycles are
+*   not CPU clocks when the frequency scales.
+*
+*   Build with -D CYCLE_PROFILER
+*************************************************************************************/
+
+#ifdef CYCLE_PROFILER
+
+#ifdef NERDMINER_HOST
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#else
+#include <hal/cpu_hal.h>
+#endif
+
+enum {
+  CYCLES_SW_BAKED = 0,    //nerd_sha256d_baked
+  CYCLES_HW_S3,           //SHA engine, midstate written back (S2, S3, C3)
+  CYCLES_HW_ESP32,        //SHA engine, whole header (ESP32)
+  CYCLES_KERNELS
+};
+
+#define CYCLES_CORES    2
+
+static inline uint32_t cycles_now(void)
+{
+#ifndef NERDMINER_HOST
+  return cpu_hal_get_cycle_count();
+#elif defined(__x86_64__) || defined(__i386__)
+  return (uint32_t)__rdtsc();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)(ts.tv_sec * 1000000000ull + ts.tv_nsec);
+#endif
+}
+
+//Marker of the batches that saw pool traffic
+uint32_t cycles_traffic(void);
+//Stratum task, pool data to read
+void cycles_traffic_mark(void);
+
+//Miner tasks, after each batch
+void cycles_add(int kernel, uint32_t cycles, uint32_t hashes, uint32_t traffic);
+
+//Serial console "cycles [reset]"
+void cycles_command(const char* args);
+
+#define CYCLES_BEGIN(var)                   uint32_t var = cycles_now(); uint32_t var##_marker = cycles_traffic()
+#define CYCLES_END(kernel, var, hashes)     cycles_add(kernel, cycles_now() - var, hashes, var##_marker)
+#define CYCLES_TRAFFIC()                    cycles_traffic_mark()
+
+#else
+
+#define CYCLES_BEGIN(var)                   do {} while (0)
+#define CYCLES_END(kernel, var, hashes)     do {} while (0)
+#define CYCLES_TRAFFIC()                    do {} while (0)
+
+#endif // CYCLE_PROFILER
+
+#endif // CYCLE_PROFILER_H
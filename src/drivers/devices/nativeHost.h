@@ -0,0 +1,7 @@
+#ifndef _NATIVE_HOST_H
+#define _NATIVE_HOST_H
+
+//Linux/x86 host build (pio run -e native), stats are printed to stdout
+#define NO_DISPLAY
+
+#endif
@@ -8,6 +8,7 @@
 #include "media/Free_Fonts.h"
 #include "version.h"
 #include "monitor.h"
+#include "logger.h"
 #include "OpenFontRender.h"
 #include "rotation.h"
 
@@ -124,8 +125,8 @@ void dongleDisplay_MinerScreen(unsigned long mElapsed)
   mining_data data = getMiningData(mElapsed);
 
   // Print background screen
-  Serial.printf(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
-                data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
+  LOG_I(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
+        data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
 
   background.pushImage(0, 0, MinerWidth, MinerHeight, MinerScreen);
   RESET_SCREEN();
@@ -11,7 +11,9 @@
 #include "media/Free_Fonts.h"
 #include "version.h"
 #include "monitor.h"
+#include "logger.h"
 #include "OpenFontRender.h"
+#include "historyChart.h"
 #include <SPI.h>
 #include "rotation.h"
 #include "drivers/storage/nvMemory.h"
@@ -286,8 +288,8 @@ void esp32_2432S028R_MinerScreen(unsigned long mElapsed)
   // Delete sprite to free the memory heap
   background.deleteSprite();  
 
-  Serial.printf(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
-                data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str()); 
+  LOG_I(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
+        data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str()); 
    
   #ifdef DEBUG_MEMORY
     // Print heap
@@ -348,8 +350,8 @@ void esp32_2432S028R_ClockScreen(unsigned long mElapsed)
   // Delete sprite to free the memory heap
   background.deleteSprite();   
 
-  Serial.printf(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
-                data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
+  LOG_I(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
+        data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
 
   #ifdef DEBUG_MEMORY
   // Print heap
@@ -440,8 +442,8 @@ void esp32_2432S028R_GlobalHashScreen(unsigned long mElapsed)
   // Delete sprite to free the memory heap
   background.deleteSprite();   
 
-  Serial.printf(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
-                data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
+  LOG_I(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
+        data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
 
   #ifdef DEBUG_MEMORY
   // Print heap
@@ -500,8 +502,8 @@ void esp32_2432S028R_BTCprice(unsigned long mElapsed)
   // Delete sprite to free the memory heap
   background.deleteSprite();   
 
-  Serial.printf(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
-                data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
+  LOG_I(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
+        data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
 
   #ifdef DEBUG_MEMORY
   // Print heap
@@ -509,6 +511,24 @@ void esp32_2432S028R_BTCprice(unsigned long mElapsed)
   #endif
 }
 
+#ifdef HISTORY_CHART
+history_chart hashrateChart;
+
+void esp32_2432S028R_HashrateHistory(unsigned long mElapsed)
+{
+  printPoolData();
+
+  // Straight on the screen, no sprite: the columns move once a minute
+  if (hasChangedScreen)
+  {
+    tft.fillRect(0, 0, 320, 170, TFT_BLACK);
+    history_chart_init(hashrateChart, HISTORY_MINUTE, 320, 160);
+  }
+  history_chart_draw(hashrateChart, tft, 0, 5, TFT_ORANGE, TFT_BLACK, hasChangedScreen);
+  hasChangedScreen = false;
+}
+#endif
+
 void esp32_2432S028R_LoadingScreen(void)
 {
   tft.fillScreen(TFT_BLACK);
@@ -613,7 +633,11 @@ void esp32_2432S028R_DoLedStuff(unsigned long frame)
 
 }
 
-CyclicScreenFunction esp32_2432S028RCyclicScreens[] = {esp32_2432S028R_MinerScreen, esp32_2432S028R_ClockScreen, esp32_2432S028R_GlobalHashScreen, esp32_2432S028R_BTCprice};
+CyclicScreenFunction esp32_2432S028RCyclicScreens[] = {esp32_2432S028R_MinerScreen, esp32_2432S028R_ClockScreen, esp32_2432S028R_GlobalHashScreen, esp32_2432S028R_BTCprice
+#ifdef HISTORY_CHART
+  , esp32_2432S028R_HashrateHistory
+#endif
+};
 
 DisplayDriver esp32_2432S028RDriver = {
     esp32_2432S028R_Init,
@@ -0,0 +1,102 @@
+#include "historyChart.h"
+
+#ifdef HISTORY_CHART
+
+void history_chart_init(history_chart &chart, int archive, uint16_t width, uint16_t height)
+{
+  chart.archive = archive;
+  chart.width = width > HISTORY_CHART_WIDTH ? HISTORY_CHART_WIDTH : width;
+  chart.height = height;
+  chart.count = 0;
+  chart.scrolled = 0;
+  chart.scale = 0.0;
+  memset(chart.columns, 0, sizeof(chart.columns));
+}
+
+static uint8_t HistoryChartColumn(const history_chart &chart, const history_sample &sample)
+{
+  int bars = chart.height - HISTORY_CHART_LABELS;
+  int column = (int)(history_khs(sample) * bars / chart.scale + 0.5);
+  return column > bars ? bars : column;
+}
+
+// Columns of the samples since the last frame, false when there were none
+static bool HistoryChartUpdate(history_chart &chart)
+{
+  const history_archive &archive = history_get(chart.archive);
+  uint32_t added = archive.count - chart.count;
+  if (added == 0)
+    return false;
+  uint32_t shown = archive.count < chart.width ? archive.count : chart.width;
+
+  bool rescale = chart.count == 0 || added >= chart.width || chart.scrolled + added >= chart.width;
+  for (uint32_t n = 0; n < added && n < shown && !rescale; ++n)
+    rescale = history_khs(history_sample_at(archive, n)) > chart.scale;
+
+  if (rescale)
+  {
+    double top = 0.0;
+    for (uint32_t n = 0; n < shown; ++n)
+    {
+      double khs = history_khs(history_sample_at(archive, n));
+      if (khs > top)
+        top = khs;
+    }
+    // Some room over the highest sample, the next ones don't rescale right away
+    chart.scale = top > 0.0 ? top * 1.2 : 1.0;
+    chart.scrolled = 0;
+    memset(chart.columns, 0, sizeof(chart.columns));
+    for (uint32_t n = 0; n < shown; ++n)
+      chart.columns[chart.width - 1 - n] = HistoryChartColumn(chart, history_sample_at(archive, n));
+  }
+  else
+  {
+    memmove(chart.columns, chart.columns + added, chart.width - added);
+    for (uint32_t n = 0; n < added; ++n)
+      chart.columns[chart.width - 1 - n] = n < shown ? HistoryChartColumn(chart, history_sample_at(archive, n)) : 0;
+    chart.scrolled += added;
+  }
+  chart.count = archive.count;
+  return true;
+}
+
+bool history_chart_draw(history_chart &chart, TFT_eSPI &gfx, int32_t x, int32_t y, uint16_t color, uint16_t bg, bool force)
+{
+  if (!HistoryChartUpdate(chart) && !force)
+    return false;
+
+  // Labels: time span of the chart and hashrate of a full column
+  const history_archive &archive = history_get(chart.archive);
+  uint32_t span_min = chart.width * archive.seconds / 60;
+  char label[24];
+  gfx.fillRect(x, y, chart.width, HISTORY_CHART_LABELS, bg);
+  gfx.setTextFont(1);
+  gfx.setTextSize(1);
+  gfx.setTextColor(color, bg);
+  gfx.setTextDatum(TL_DATUM);
+  if (span_min >= 120)
+    snprintf(label, sizeof(label), "Hashrate %uh", (unsigned)(span_min / 60));
+  else
+    snprintf(label, sizeof(label), "Hashrate %umin", (unsigned)span_min);
+  gfx.drawString(label, x, y);
+  gfx.setTextDatum(TR_DATUM);
+  if (chart.scale >= 1000.0)
+    snprintf(label, sizeof(label), "%.2f MH/s", chart.scale / 1000.0);
+  else
+    snprintf(label, sizeof(label), "%.1f KH/s", chart.scale);
+  gfx.drawString(label, x + chart.width - 1, y);
+
+  int bars = chart.height - HISTORY_CHART_LABELS;
+  int32_t bottom = y + chart.height;
+  for (int i = 0; i < chart.width; ++i)
+  {
+    int column = chart.columns[i];
+    if (column < bars)
+      gfx.drawFastVLine(x + i, bottom - bars, bars - column, bg);
+    if (column > 0)
+      gfx.drawFastVLine(x + i, bottom - column, column, color);
+  }
+  return true;
+}
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef HISTORYCHART_H_
+#define HISTORYCHART_H_
+
+#include "displayDriver.h"
+#include "hashrateHistory.h"
+
+// Hashrate chart of the TFT_eSPI screens, one column per sample of a history archive.
+// The column heights are kept between frames: a new sample shifts them by one and only
+// the new column is computed, all of them are again when a sample tops the scale or a
+// whole chart has scrolled since the scale was set (an old peak is gone).
+#if defined(HASHRATE_HISTORY) && (defined(T_HMI_DISPLAY) || defined(ESP32_2432S028R) || defined(ESP32_2432S028_2USB))
+#define HISTORY_CHART
+
+#include <TFT_eSPI.h>
+
+#define HISTORY_CHART_WIDTH   320   // Widest chart
+#define HISTORY_CHART_LABELS  10    // Label row over the columns
+
+typedef struct
+{
+  int archive;
+  uint16_t width;
+  uint16_t height;                  // Columns and label row
+  uint32_t count;                   // Archive samples the columns show
+  uint32_t scrolled;                // Samples since the scale was set
+  double scale;                     // KH/s of a full column
+  uint8_t columns[HISTORY_CHART_WIDTH]; // Heights, the newest on the right
+} history_chart;
+
+void history_chart_init(history_chart &chart, int archive, uint16_t width, uint16_t height);
+
+// Draws on the screen or a sprite, every pixel of the chart area is written: no
+// clearing first, no flicker on the screen. False when there was no new sample.
+bool history_chart_draw(history_chart &chart, TFT_eSPI &gfx, int32_t x, int32_t y, uint16_t color, uint16_t bg, bool force);
+
+#endif
+
+#endif // HISTORYCHART_H_
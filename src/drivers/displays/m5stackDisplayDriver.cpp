@@ -8,6 +8,7 @@
 
 #include "Free_Fonts.h"
 #include "monitor.h"
+#include "logger.h"
 #include "drivers/storage/storage.h"
 #include "wManager.h"
 
@@ -53,9 +54,9 @@ void m5stackDisplay_NoScreen(unsigned long mElapsed)
   mining_data data = getMiningData(mElapsed);
 
   // Print hashrate to serial
-  Serial.printf(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
-                data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
-  //Serial.printf(">>> Temperature: %s\n", data.temp.c_str());
+  LOG_I(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
+        data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
+  //LOG_I(">>> Temperature: %s\n", data.temp.c_str());
 
   M5.Lcd.setTextColor(WHITE);
   M5.Lcd.setFreeFont(FMB9);
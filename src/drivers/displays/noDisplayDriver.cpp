@@ -4,6 +4,7 @@
 
 #include <Arduino.h>
 #include "monitor.h"
+#include "logger.h"
 #include "wManager.h"
 
 extern monitor_data mMonitor;
@@ -30,17 +31,17 @@ void noDisplay_NoScreen(unsigned long mElapsed)
   mining_data data = getMiningData(mElapsed);
 
   // Print hashrate to serial
-  Serial.printf(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
-                data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
+  LOG_I(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
+        data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
 
   // Print extended data to serial for no display devices
-  Serial.printf(">>> Valid blocks: %s\n", data.valids.c_str());
-  Serial.printf(">>> Block templates: %s\n", data.templates.c_str());
-  Serial.printf(">>> Best difficulty: %s\n", data.bestDiff.c_str());
-  Serial.printf(">>> 32Bit shares: %s\n", data.completedShares.c_str());
-  Serial.printf(">>> Temperature: %s\n", data.temp.c_str());
-  Serial.printf(">>> Total MHashes: %s\n", data.totalMHashes.c_str());
-  Serial.printf(">>> Time mining: %s\n", data.timeMining.c_str());
+  LOG_I(">>> Valid blocks: %s\n", data.valids.c_str());
+  LOG_I(">>> Block templates: %s\n", data.templates.c_str());
+  LOG_I(">>> Best difficulty: %s\n", data.bestDiff.c_str());
+  LOG_I(">>> 32Bit shares: %s\n", data.completedShares.c_str());
+  LOG_I(">>> Temperature: %s\n", data.temp.c_str());
+  LOG_I(">>> Total MHashes: %s\n", data.totalMHashes.c_str());
+  LOG_I(">>> Time mining: %s\n", data.timeMining.c_str());
 }
 void noDisplay_LoadingScreen(void)
 {
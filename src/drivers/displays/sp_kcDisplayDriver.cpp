@@ -8,6 +8,7 @@
 #include "media/Free_Fonts.h"
 #include "version.h"
 #include "monitor.h"
+#include "logger.h"
 #include "OpenFontRender.h"
 #include "rotation.h"
 
@@ -56,7 +57,7 @@ void sp_kcDisplay_MinerScreen(unsigned long mElapsed)
   // Print background screen
   background.pushImage(0, 0, MinerWidth, MinerHeight, MinerScreen);
 
-  Serial.printf(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
+  LOG_I(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
                 data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
 
     //Hashrate
@@ -93,7 +94,7 @@ void sp_kcDisplay_ClockScreen(unsigned long mElapsed)
     // Print background screen
     background.pushImage(0, 0, minerClockWidth, minerClockHeight, minerClockScreen);
 
-    // Serial.printf(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
+    // LOG_I(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
     //             data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
 
     render.setCursor(0, 0);
@@ -11,7 +11,9 @@
 #include "media/Free_Fonts.h"
 #include "version.h"
 #include "monitor.h"
+#include "logger.h"
 #include "OpenFontRender.h"
+#include "historyChart.h"
 #ifdef TOUCH_ENABLE
 #include "TouchHandler.h"
 #endif
@@ -38,7 +40,14 @@ extern monitor_data mMonitor;
 extern pool_data pData;
 extern DisplayDriver *currentDisplayDriver;
 
+#ifdef HISTORY_CHART
+history_chart hashrateChart;
+
+// Third lower screen, the hashrate of the last hours
+void toggleBottomScreen() { lowerScreen = lowerScreen % 3 + 1; }
+#else
 void toggleBottomScreen() { lowerScreen = 3 - lowerScreen; }
+#endif
 
 
 uint32_t readAdcVoltage(int pin) {
@@ -71,6 +80,9 @@ void t_hmiDisplay_Init(void)
   tft.setSwapBytes(true);                 // Swap the colour byte order when rendering
   background.createSprite(WIDTH,HEIGHT); // Background Sprite
   background.setSwapBytes(true);
+#ifdef HISTORY_CHART
+  history_chart_init(hashrateChart, HISTORY_MINUTE, WIDTH, 66);
+#endif
   render.setDrawer(background);  // Link drawing object to background instance (so font will be rendered on background)
   render.setLineSpaceRatio(0.9); 
   // Load the font and check it can be read OK
@@ -143,7 +155,7 @@ void printMemPoolFees(unsigned long mElapsed)
     // XXX -- remove when bitmap is done
     background.fillRect( 105, 170,  110, 20, TFT_BLACK);
     
-    String st = data.btcPrice;
+    String st(data.btcPrice);
     if (st.length()) st.remove(st.length()-1);
     render.drawString(st.c_str(),  125, 170,  TFT_WHITE);
   }
@@ -157,12 +169,21 @@ void printMemPoolFees(unsigned long mElapsed)
   // printBatteryVoltage();
 }
 
+#ifdef HISTORY_CHART
+void printHashrateChart()
+{
+  // The background is composed again every frame, the chart is drawn whole
+  background.fillRect(0, 170, 320, 4, TFT_BLACK);
+  history_chart_draw(hashrateChart, background, 0, 174, TFT_ORANGE, TFT_BLACK, true);
+}
+#endif
+
 void t_hmiDisplay_MinerScreen(unsigned long mElapsed)
 {
   mining_data data = getMiningData(mElapsed);
   background.pushImage(0, 0, MinerWidth, 170, MinerScreen);
-  Serial.printf(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
-                data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
+  LOG_I(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
+        data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
    // Hashrate
   render.setFontSize(35);
   render.setCursor(19, 118);
@@ -199,6 +220,11 @@ void t_hmiDisplay_MinerScreen(unsigned long mElapsed)
   render.setFontSize(10);
   render.rdrawString(data.currentTime.c_str(), 286, 1, TFT_BLACK);
 
+#ifdef HISTORY_CHART
+  if (lowerScreen == 3)
+    printHashrateChart();
+  else
+#endif
   if (lowerScreen == 1)
     printPoolData();
   else
@@ -215,8 +241,8 @@ void t_hmiDisplay_ClockScreen(unsigned long mElapsed)
   // Print background screen
   background.pushImage(0, 0, minerClockWidth, 170 /*minerClockHeight*/, minerClockScreen);
 
-  Serial.printf(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
-                data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
+  LOG_I(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
+        data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
 
   // Hashrate
   render.setFontSize(25);
@@ -241,6 +267,11 @@ void t_hmiDisplay_ClockScreen(unsigned long mElapsed)
   background.setTextColor(0xDEDB, TFT_BLACK);
 
   background.drawString(data.currentTime.c_str(), 130, 50, GFXFF);
+#ifdef HISTORY_CHART
+  if (lowerScreen == 3)
+    printHashrateChart();
+  else
+#endif
   if (lowerScreen == 1)
     printMemPoolFees(mElapsed);
   else
@@ -256,8 +287,8 @@ void t_hmiDisplay_GlobalHashScreen(unsigned long mElapsed)
   // Print background screen
   background.pushImage(0, 0, globalHashWidth, 170 /* globalHashHeight */, globalHashScreen);
 
-  Serial.printf(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
-                data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
+  LOG_I(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
+        data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
 
   // Print BTC Price
   background.setFreeFont(FSSB9);
@@ -304,6 +335,11 @@ void t_hmiDisplay_GlobalHashScreen(unsigned long mElapsed)
   background.setTextColor(TFT_BLACK);
   background.drawString(data.remainingBlocks.c_str(), 72, 159, FONT2);
 
+#ifdef HISTORY_CHART
+  if (lowerScreen == 3)
+    printHashrateChart();
+  else
+#endif
   if (lowerScreen == 1)
     printMemPoolFees(mElapsed);
   else
@@ -321,8 +357,8 @@ void t_hmiDisplay_BTCprice(unsigned long mElapsed)
   // Print background screen
   background.pushImage(0, 0, priceScreenWidth, 170 /*priceScreenHeight*/, priceScreen);
 
-  Serial.printf(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
-                data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
+  LOG_I(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
+        data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
 
   // Hashrate
   render.setFontSize(25);
@@ -348,6 +384,11 @@ void t_hmiDisplay_BTCprice(unsigned long mElapsed)
   background.setTextSize(1);
   background.setTextColor(0xDEDB, TFT_BLACK);
   background.drawString(data.btcPrice.c_str(), 300, 58, GFXFF);
+#ifdef HISTORY_CHART
+  if (lowerScreen == 3)
+    printHashrateChart();
+  else
+#endif
   if (lowerScreen == 1)
     printPoolData();
   else
@@ -11,6 +11,7 @@
 #include <lvgl.h>
 
 #include "monitor.h"
+#include "logger.h"
 #include "drivers/storage/storage.h"
 #include "wManager.h"
 #include "ui.h"
@@ -302,9 +303,9 @@ void wt32Display_NoScreen(unsigned long mElapsed)
   mining_data data = getMiningData(mElapsed);
 
   // Print hashrate to serial
-  Serial.printf(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
-                data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
-  //Serial.printf(">>> Temperature: %s\n", data.temp.c_str());
+  LOG_I(">>> Completed %s share(s), %s Khashes, avg. hashrate %s KH/s\n",
+        data.completedShares.c_str(), data.totalKHashes.c_str(), data.currentHashRate.c_str());
+  //LOG_I(">>> Temperature: %s\n", data.temp.c_str());
 
   lv_label_set_text(ui_lblhashrate, data.currentHashRate.c_str());
   lv_bar_set_value(ui_barhashrate, data.currentHashRate.toInt(), LV_ANIM_ON);
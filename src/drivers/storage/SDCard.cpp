@@ -119,6 +119,7 @@ bool SDCard::loadConfigFile(TSettings* Settings)
                     strcpy(Settings->BtcWallet, json[JSON_KEY_WALLETID] | Settings->BtcWallet);
                     if (json.containsKey(JSON_KEY_POOLPORT))
                         Settings->PoolPort = json[JSON_KEY_POOLPORT].as<int>();
+                    Settings->BackupPools = json[JSON_KEY_BACKUPPOOLS] | Settings->BackupPools;
                     if (json.containsKey(JSON_KEY_TIMEZONE))
                         Settings->Timezone = json[JSON_KEY_TIMEZONE].as<int>();
                     if (json.containsKey(JSON_KEY_STATS2NV))
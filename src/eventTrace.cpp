@@ -0,0 +1,166 @@
+#ifdef TRACE_EVENTS
+
+#include <Arduino.h>
+#include <stdarg.h>
+#include <atomic>
+#include "eventTrace.h"
+#include "logger.h"
+
+static_assert((TRACE_EVENTS_SIZE & (TRACE_EVENTS_SIZE - 1)) == 0, "TRACE_EVENTS_SIZE must be a power of 2");
+
+typedef struct {
+  uint32_t us;          //micros()
+  const char* name;
+  uint32_t value;
+  char phase;           //'B', 'E' or 'i'
+  uint8_t core;
+  uint8_t task;         //Index in s_tasks
+} trace_event;
+
+static trace_event s_events[TRACE_EVENTS_SIZE];
+static std::atomic<uint32_t> s_next(0);
+static std::atomic<bool> s_enabled(true);
+static std::atomic<TaskHandle_t> s_tasks[TRACE_TASKS];
+
+static uint8_t TraceTask(void)
+{
+  TaskHandle_t self = xTaskGetCurrentTaskHandle();
+  for (int i = 0; i < TRACE_TASKS; ++i)
+  {
+    TaskHandle_t task = s_tasks[i].load(std::memory_order_relaxed);
+    if (task == self)
+      return i;
+    if (task == NULL)
+    {
+      TaskHandle_t expected = NULL;
+      if (s_tasks[i].compare_exchange_strong(expected, self) || expected == self)
+        return i;
+    }
+  }
+  return TRACE_TASKS - 1;   //Table full, the last tasks share a thread
+}
+
+void trace_record(char phase, const char* name, uint32_t value)
+{
+  if (!s_enabled.load(std::memory_order_relaxed))
+    return;
+  trace_event& event = s_events[s_next.fetch_add(1, std::memory_order_relaxed) & (TRACE_EVENTS_SIZE - 1)];
+  event.us = micros();
+  event.name = name;
+  event.value = value;
+  event.phase = phase;
+  event.core = (uint8_t)xPortGetCoreID();
+  event.task = TraceTask();
+}
+
+static void TracePrint(bool& first, const char* format, ...) __attribute__((format(printf, 2, 3)));
+static void TracePrint(bool& first, const char* format, ...)
+{
+  char line[192];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(line, sizeof(line), format, args);
+  va_end(args);
+  Serial.printf("%s%s\n", first ? "" : ",", line);
+  first = false;
+}
+
+static void TraceDump(void)
+{
+  //Recording and the logger stop, the JSON lines come out in one piece
+  s_enabled = false;
+  logger_hold(true);
+  delay(10);
+
+  uint32_t end = s_next.load();
+  uint32_t count = end < TRACE_EVENTS_SIZE ? end : TRACE_EVENTS_SIZE;
+  uint32_t start = end - count;
+  Serial.printf("[TRACE] %u events, save the lines up to [TRACE] end as a .json file for ui.perfetto.dev\n", count);
+  Serial.println("{\"traceEvents\":[");
+  bool first = true;
+
+  //Open spans of each task, as ring positions
+  const int depth = 8;
+  static uint32_t open[TRACE_TASKS][depth];
+  static uint64_t open_ts[TRACE_TASKS][depth];
+  int opened[TRACE_TASKS] = { 0 };
+  uint32_t cores = 0;
+  uint32_t tasks_on_core[32] = { 0 };
+
+  //micros() wraps, timestamps count from the oldest event
+  uint64_t ts = 0;
+  uint32_t last_us = count ? s_events[start & (TRACE_EVENTS_SIZE - 1)].us : 0;
+  for (uint32_t i = start; i != end; ++i)
+  {
+    const trace_event& event = s_events[i & (TRACE_EVENTS_SIZE - 1)];
+    int32_t step = (int32_t)(event.us - last_us);
+    ts = (step < 0 && (uint64_t)-step > ts) ? 0 : ts + step;
+    last_us = event.us;
+    if (event.name == NULL || event.task >= TRACE_TASKS)
+      continue;
+    uint8_t core = event.core & 31;
+    cores |= 1u << core;
+    tasks_on_core[core] |= 1u << event.task;
+
+    if (event.phase == 'B')
+    {
+      if (opened[event.task] < depth)
+      {
+        open[event.task][opened[event.task]] = i;
+        open_ts[event.task][opened[event.task]] = ts;
+        opened[event.task]++;
+      }
+    } else if (event.phase == 'E')
+    {
+      //Unmatched ends lost their begin to the ring
+      int n = opened[event.task];
+      if (n > 0 && strcmp(s_events[open[event.task][n - 1] & (TRACE_EVENTS_SIZE - 1)].name, event.name) == 0)
+      {
+        const trace_event& begin = s_events[open[event.task][n - 1] & (TRACE_EVENTS_SIZE - 1)];
+        TracePrint(first, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%u,\"tid\":%u,\"ts\":%llu,\"dur\":%llu}", event.name, begin.core & 31,
+                   event.task, (unsigned long long)open_ts[event.task][n - 1], (unsigned long long)(ts - open_ts[event.task][n - 1]));
+        opened[event.task]--;
+      }
+    } else
+      TracePrint(first, "{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":%u,\"tid\":%u,\"ts\":%llu,\"args\":{\"value\":%u}}", event.name, core,
+                 event.task, (unsigned long long)ts, event.value);
+  }
+
+  //Still running when dumped
+  for (int task = 0; task < TRACE_TASKS; ++task)
+    for (int n = 0; n < opened[task]; ++n)
+    {
+      const trace_event& begin = s_events[open[task][n] & (TRACE_EVENTS_SIZE - 1)];
+      TracePrint(first, "{\"name\":\"%s\",\"ph\":\"B\",\"pid\":%u,\"tid\":%u,\"ts\":%llu}", begin.name, begin.core & 31, task,
+                 (unsigned long long)open_ts[task][n]);
+    }
+
+  for (int core = 0; core < 32; ++core)
+  {
+    if (!(cores & (1u << core)))
+      continue;
+    TracePrint(first, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"Core %d\"}}", core, core);
+    for (int task = 0; task < TRACE_TASKS; ++task)
+      if (tasks_on_core[core] & (1u << task))
+        TracePrint(first, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", core, task,
+                   pcTaskGetName(s_tasks[task].load()));
+  }
+  Serial.println("]}");
+  Serial.println("[TRACE] end");
+
+  logger_hold(false);
+  s_enabled = true;
+}
+
+void trace_command(const char* args)
+{
+  if (strcmp(args, "clear") == 0)
+  {
+    s_next = 0;
+    memset(s_events, 0, sizeof(s_events));
+    Serial.println("[TRACE] cleared");
+  } else
+    TraceDump();
+}
+
+#endif // TRACE_EVENTS
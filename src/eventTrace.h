@@ -0,0 +1,52 @@
+#ifndef EVENT_TRACE_H
+#define EVENT_TRACE_H
+
+#include <Arduino.h>
+
+/************************************************************************************
+*   Timeline of the mining tasks, instrumentation only.
+*
+*   TRACE_BEGIN / TRACE_END / TRACE_INSTANT record a timestamped event with the task
+*   and the core it ran on into a ring of TRACE_EVENTS_SIZE events, the oldest ones
+*   are overwritten. Names must be string literals.
+*
+*   The "trace" serial command dumps the ring as Chrome trace event JSON (paste the
+*   lines between the markers in a .json file and open it in ui.perfetto.dev): one
+*   process per core, one thread per task, spans as complete events on the core
+*   they began on. "trace clear" empties the ring.
+*
+*   Traced: pool notify, job prep, submit, share ack, miner chunks, SHA engine hold,
+*   display frames and HTTP fetches.
+*
+*   Build with -D TRACE_EVENTS
+*************************************************************************************/
+
+#ifdef TRACE_EVENTS
+
+#ifndef TRACE_EVENTS_SIZE
+#ifdef NERDMINER_HOST
+#define TRACE_EVENTS_SIZE   65536     //Host miners run thousands of chunks per second
+#else
+#define TRACE_EVENTS_SIZE   1024      //Power of 2, 16 bytes each
+#endif
+#endif
+#define TRACE_TASKS         16
+
+void trace_record(char phase, const char* name, uint32_t value);
+
+//Serial console "trace [clear]"
+void trace_command(const char* args);
+
+#define TRACE_BEGIN(name)           trace_record('B', name, 0)
+#define TRACE_END(name)             trace_record('E', name, 0)
+#define TRACE_INSTANT(name, value)  trace_record('i', name, value)
+
+#else
+
+#define TRACE_BEGIN(name)           do {} while (0)
+#define TRACE_END(name)             do {} while (0)
+#define TRACE_INSTANT(name, value)  do {} while (0)
+
+#endif // TRACE_EVENTS
+
+#endif // EVENT_TRACE_H
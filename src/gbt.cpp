@@ -0,0 +1,1016 @@
+#include <Arduino.h>
+#include <WiFi.h>
+#include <ctype.h>
+#include <string.h>
+#include "esp_system.h"
+#include "mbedtls/sha256.h"
+#include "gbt.h"
+#include "utils.h"
+
+#define GBT_COINBASE_TAG    "NerdMiner"
+
+//Template fields a reply must have
+#define GBT_FOUND_VERSION   0x01
+#define GBT_FOUND_PREVHASH  0x02
+#define GBT_FOUND_CURTIME   0x04
+#define GBT_FOUND_BITS      0x08
+#define GBT_FOUND_HEIGHT    0x10
+#define GBT_FOUND_VALUE     0x20
+#define GBT_FOUND_ALL       0x3F
+
+enum { HTTP_STATUS, HTTP_HEADERS, HTTP_BODY };
+enum { JSON_VALUE, JSON_STRING, JSON_ESCAPE, JSON_LITERAL };
+
+static void Sha256d(uint8_t out[32], const uint8_t* data, size_t len)
+{
+  mbedtls_sha256_ret(data, len, out, 0);
+  mbedtls_sha256_ret(out, 32, out, 0);
+}
+
+//Hashes are shown byte reversed (txid, block hash)
+static bool HexReversed(const char* text, uint8_t out[32])
+{
+  if (strlen(text) != 64)
+    return false;
+  for (int i = 0; i < 32; ++i)
+    out[31 - i] = (hex(text[2 * i]) << 4) | hex(text[2 * i + 1]);
+  return true;
+}
+
+static void HexAppend(String& text, const uint8_t* data, size_t len)
+{
+  char byte[3];
+  for (size_t i = 0; i < len; ++i)
+  {
+    snprintf(byte, sizeof(byte), "%02x", data[i]);
+    text += byte;
+  }
+}
+
+static void HexAppendLE(String& text, uint64_t value, int bytes)
+{
+  for (int i = 0; i < bytes; ++i)
+  {
+    uint8_t byte = (uint8_t)(value >> (8 * i));
+    HexAppend(text, &byte, 1);
+  }
+}
+
+static void HexAppendVarInt(String& text, uint64_t value)
+{
+  if (value < 0xFD)
+    HexAppendLE(text, value, 1);
+  else if (value <= 0xFFFF)
+  {
+    text += "fd";
+    HexAppendLE(text, value, 2);
+  } else
+  {
+    text += "fe";
+    HexAppendLE(text, value, 4);
+  }
+}
+
+String gbt_base64(const String& text)
+{
+  static const char digits[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  String out;
+  size_t len = text.length();
+  for (size_t i = 0; i < len; i += 3)
+  {
+    uint32_t v = (uint8_t)text[i] << 16;
+    if (i + 1 < len)
+      v |= (uint8_t)text[i + 1] << 8;
+    if (i + 2 < len)
+      v |= (uint8_t)text[i + 2];
+    out += digits[(v >> 18) & 0x3F];
+    out += digits[(v >> 12) & 0x3F];
+    out += (i + 1 < len) ? digits[(v >> 6) & 0x3F] : '=';
+    out += (i + 2 < len) ? digits[v & 0x3F] : '=';
+  }
+  return out;
+}
+
+bool gbt_parse_url(const String& url, String& host, String& auth)
+{
+  if (!url.startsWith(GBT_URL_SCHEME))
+    return false;
+  host = url.substring(strlen(GBT_URL_SCHEME));
+  auth = "";
+  int at = host.lastIndexOf('@');
+  if (at >= 0)
+  {
+    auth = host.substring(0, at);
+    host = host.substring(at + 1);
+  }
+  int slash = host.indexOf('/');
+  if (slash >= 0)
+    host = host.substring(0, slash);
+  return true;
+}
+
+//////////////////////////// Payout address ///////////////////////////////
+
+static bool Base58CheckDecode(const char* text, uint8_t* out, size_t& len)
+{
+  static const char digits[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+  uint8_t data[32] = { 0 };   //Big endian, version + 20 bytes + checksum is 25
+  size_t zeros = 0;
+  while (text[zeros] == '1')
+    zeros++;
+  for (const char* p = text; *p; ++p)
+  {
+    const char* digit = strchr(digits, *p);
+    if (digit == NULL)
+      return false;
+    uint32_t carry = digit - digits;
+    for (int j = sizeof(data) - 1; j >= 0; --j)
+    {
+      carry += (uint32_t)data[j] * 58;
+      data[j] = carry & 0xFF;
+      carry >>= 8;
+    }
+    if (carry != 0)
+      return false;
+  }
+  size_t start = 0;
+  while (start < sizeof(data) && data[start] == 0)
+    start++;
+  len = zeros + sizeof(data) - start;
+  if (len < 5 || len > sizeof(data))
+    return false;
+  memset(out, 0, zeros);
+  memcpy(out + zeros, data + start, sizeof(data) - start);
+
+  uint8_t h[32];
+  Sha256d(h, out, len - 4);
+  if (memcmp(h, out + len - 4, 4) != 0)
+    return false;
+  len -= 4;
+  return true;
+}
+
+static uint32_t Bech32Polymod(uint32_t chk, uint8_t value)
+{
+  static const uint32_t generator[5] = { 0x3b6a57b2, 0x26508e6d, 0x1ea119fa, 0x3d4233dd, 0x2a1462b3 };
+  uint8_t top = chk >> 25;
+  chk = ((chk & 0x1ffffff) << 5) ^ value;
+  for (int i = 0; i < 5; ++i)
+    if ((top >> i) & 1)
+      chk ^= generator[i];
+  return chk;
+}
+
+//Segwit address (BIP173 / BIP350): witness version and program
+static bool SegwitDecode(const char* text, int& version, uint8_t* program, size_t& program_len)
+{
+  static const char charset[] = "qpzry9x8gf2tvdw0s3jn54khce6mua7l";
+  size_t len = strlen(text);
+  const char* sep = strrchr(text, '1');
+  if (sep == NULL || sep == text || len > 90)
+    return false;
+  size_t hrp_len = sep - text;
+  size_t data_len = len - hrp_len - 1;
+  if (data_len < 7)
+    return false;
+
+  bool lower = false, upper = false;
+  for (size_t i = 0; i < len; ++i)
+  {
+    lower |= islower((unsigned char)text[i]) != 0;
+    upper |= isupper((unsigned char)text[i]) != 0;
+  }
+  if (lower && upper)
+    return false;
+
+  uint32_t chk = 1;
+  for (size_t i = 0; i < hrp_len; ++i)
+    chk = Bech32Polymod(chk, tolower((unsigned char)text[i]) >> 5);
+  chk = Bech32Polymod(chk, 0);
+  for (size_t i = 0; i < hrp_len; ++i)
+    chk = Bech32Polymod(chk, tolower((unsigned char)text[i]) & 31);
+
+  uint8_t values[90];
+  for (size_t i = 0; i < data_len; ++i)
+  {
+    const char* digit = strchr(charset, tolower((unsigned char)sep[1 + i]));
+    if (digit == NULL)
+      return false;
+    values[i] = digit - charset;
+    chk = Bech32Polymod(chk, values[i]);
+  }
+
+  version = values[0];
+  uint32_t expected = (version == 0) ? 1 : 0x2bc830a3;   //bech32 for v0, bech32m after
+  if (chk != expected || version > 16)
+    return false;
+
+  //5 bit groups to bytes, the padding must be zero
+  uint32_t acc = 0;
+  int bits = 0;
+  program_len = 0;
+  for (size_t i = 1; i < data_len - 6; ++i)
+  {
+    acc = (acc << 5) | values[i];
+    bits += 5;
+    if (bits >= 8)
+    {
+      bits -= 8;
+      if (program_len == 40)
+        return false;
+      program[program_len++] = (acc >> bits) & 0xFF;
+    }
+  }
+  if (bits >= 5 || ((acc << (8 - bits)) & 0xFF) != 0)
+    return false;
+  if (program_len < 2 || (version == 0 && program_len != 20 && program_len != 32))
+    return false;
+  return true;
+}
+
+bool gbt_address_script(const char* address, uint8_t* script, size_t script_size, size_t& script_len)
+{
+  //Pool style user names: address.worker
+  char text[100];
+  snprintf(text, sizeof(text), "%s", address);
+  char* dot = strchr(text, '.');
+  if (dot != NULL)
+    *dot = 0;
+
+  int version;
+  uint8_t program[40];
+  size_t program_len;
+  if (SegwitDecode(text, version, program, program_len))
+  {
+    if (2 + program_len > script_size)
+      return false;
+    script[0] = (version == 0) ? 0x00 : 0x50 + version;   //OP_0, OP_1..OP_16
+    script[1] = program_len;
+    memcpy(script + 2, program, program_len);
+    script_len = 2 + program_len;
+    return true;
+  }
+
+  uint8_t data[32];
+  size_t len;
+  if (!Base58CheckDecode(text, data, len) || len != 21)
+    return false;
+  if ((data[0] == 0x00 || data[0] == 0x6f) && script_size >= 25)
+  {
+    //P2PKH: OP_DUP OP_HASH160 <20> OP_EQUALVERIFY OP_CHECKSIG
+    script[0] = 0x76;
+    script[1] = 0xa9;
+    script[2] = 20;
+    memcpy(script + 3, data + 1, 20);
+    script[23] = 0x88;
+    script[24] = 0xac;
+    script_len = 25;
+    return true;
+  }
+  if ((data[0] == 0x05 || data[0] == 0xc4) && script_size >= 23)
+  {
+    //P2SH: OP_HASH160 <20> OP_EQUAL
+    script[0] = 0xa9;
+    script[1] = 20;
+    memcpy(script + 2, data + 1, 20);
+    script[22] = 0x87;
+    script_len = 23;
+    return true;
+  }
+  return false;
+}
+
+//////////////////////////// Merkle tree ///////////////////////////////
+
+static void MerkleHash(uint8_t out[32], const uint8_t left[32], const uint8_t right[32])
+{
+  uint8_t pair[64];
+  memcpy(pair, left, 32);
+  memcpy(pair + 32, right, 32);
+  Sha256d(out, pair, sizeof(pair));
+}
+
+void gbt_merkle_init(gbt_merkle& m, uint8_t (*branch)[32])
+{
+  m.count = 0;
+  m.path_level = -1;
+  m.branch = branch;
+}
+
+//With a branch, the first leaf is the coinbase: unknown, only its siblings are kept
+void gbt_merkle_add(gbt_merkle& m, const uint8_t leaf[32])
+{
+  uint8_t node[32];
+  bool path = (m.branch != NULL && m.count == 0);
+  memcpy(node, leaf, 32);
+  int level = 0;
+  while (m.count & (1u << level))
+  {
+    if (m.path_level == level)
+    {
+      memcpy(m.branch[level], node, 32);
+      path = true;
+    } else
+      MerkleHash(node, m.inner[level], node);
+    level++;
+  }
+  memcpy(m.inner[level], node, 32);
+  if (path)
+    m.path_level = level;
+  m.count++;
+}
+
+//Root (plain tree) and depth. Odd levels pair the last node with itself.
+int gbt_merkle_finish(gbt_merkle& m, uint8_t root[32])
+{
+  memset(root, 0, 32);
+  if (m.count == 0)
+    return 0;
+  uint64_t count = m.count;
+  int level = 0;
+  while (!(count & (1ull << level)))
+    level++;
+  uint8_t node[32];
+  memcpy(node, m.inner[level], 32);
+  while (count != (1ull << level))
+  {
+    MerkleHash(node, node, node);
+    count += 1ull << level;
+    level++;
+    while (!(count & (1ull << level)))
+    {
+      if (m.path_level == level)
+        memcpy(m.branch[level], node, 32);
+      else
+        MerkleHash(node, m.inner[level], node);
+      level++;
+    }
+  }
+  memcpy(root, node, 32);
+  return level;
+}
+
+//////////////////////////// RPC replies ///////////////////////////////
+
+static void ReplyInit(gbt_reply& r, gbt_template* tmpl)
+{
+  r.http_state = HTTP_STATUS;
+  r.line = "";
+  r.status = 0;
+  r.content_length = -1;
+  r.body_read = 0;
+  r.done = false;
+
+  r.depth = 0;
+  r.expect_key = false;
+  r.json_state = JSON_VALUE;
+  r.value_len = 0;
+  r.value_data = false;
+
+  r.tmpl = tmpl;
+  r.found = 0;
+  r.tx_open = false;
+  r.full = false;
+  r.dropped_fees = 0;
+  r.fees_unknown = false;
+  r.longpollid = "";
+  r.result_null = false;
+  r.result = "";
+  r.error = "";
+  if (tmpl != NULL)
+  {
+    tmpl->valid = false;
+    tmpl->data_len = 0;
+    tmpl->tx_count = 0;
+    tmpl->tx_dropped = 0;
+    tmpl->branch_count = 0;
+    //Leaf 0 of both trees is the coinbase, its wtxid is zero
+    uint8_t zero[32] = { 0 };
+    gbt_merkle_init(r.txids, tmpl->branch);
+    gbt_merkle_add(r.txids, zero);
+    gbt_merkle_init(r.wtxids, NULL);
+    gbt_merkle_add(r.wtxids, zero);
+  }
+}
+
+static inline bool KeyIs(const gbt_reply& r, int depth, const char* key)
+{
+  return strcmp(r.key[depth], key) == 0;
+}
+
+//result.transactions[n], an object
+static inline bool InTransaction(const gbt_reply& r)
+{
+  return r.tmpl != NULL && r.depth == 4 && KeyIs(r, 1, "result") && KeyIs(r, 2, "transactions") && r.array[3] && !r.array[4];
+}
+
+static void TransactionBegin(gbt_reply& r)
+{
+  r.tx_open = true;
+  r.tx_fits = !r.full;
+  r.tx_start = r.tmpl->data_len;
+  r.tx_fee_known = false;
+  r.tx_txid = false;
+  r.tx_wtxid = false;
+  r.hex_half = false;
+}
+
+//Kept when its data fit, else it and every one after it (they may spend it) are left out
+static void TransactionEnd(gbt_reply& r)
+{
+  r.tx_open = false;
+  if (r.tx_fits && r.tx_txid && !r.hex_half)
+  {
+    gbt_merkle_add(r.txids, r.txid);
+    gbt_merkle_add(r.wtxids, r.tx_wtxid ? r.wtxid : r.txid);
+    r.tmpl->tx_count++;
+    return;
+  }
+  r.tmpl->data_len = r.tx_start;
+  r.full = true;
+  r.tmpl->tx_dropped++;
+  if (r.tx_fee_known)
+    r.dropped_fees += r.tx_fee;
+  else
+    r.fees_unknown = true;
+}
+
+static void TransactionData(gbt_reply& r, char c)
+{
+  if (!r.tx_fits)
+    return;
+  if (!r.hex_half)
+  {
+    r.hex_high = hex(c);
+    r.hex_half = true;
+    return;
+  }
+  r.hex_half = false;
+  if (r.tmpl->data_len >= GBT_BLOCK_DATA_MAX)
+  {
+    r.tx_fits = false;
+    return;
+  }
+  r.tmpl->data[r.tmpl->data_len++] = (r.hex_high << 4) | hex(c);
+}
+
+static void JsonValue(gbt_reply& r, bool text)
+{
+  const char* v = r.value;
+  if (r.depth == 1 && KeyIs(r, 1, "result"))
+  {
+    if (text)
+      r.result = v;
+    else
+      r.result_null = strcmp(v, "null") == 0;
+    return;
+  }
+  if (r.depth == 2 && KeyIs(r, 1, "error") && KeyIs(r, 2, "message"))
+  {
+    r.error = v;
+    return;
+  }
+  if (r.tmpl == NULL)
+    return;
+
+  gbt_template& t = *r.tmpl;
+  if (r.depth == 2 && KeyIs(r, 1, "result"))
+  {
+    if (KeyIs(r, 2, "version"))
+    {
+      t.version = strtoul(v, NULL, 10);
+      r.found |= GBT_FOUND_VERSION;
+    } else if (KeyIs(r, 2, "previousblockhash"))
+    {
+      if (HexReversed(v, t.prev_hash))
+        r.found |= GBT_FOUND_PREVHASH;
+    } else if (KeyIs(r, 2, "curtime"))
+    {
+      t.curtime = strtoul(v, NULL, 10);
+      r.found |= GBT_FOUND_CURTIME;
+    } else if (KeyIs(r, 2, "bits"))
+    {
+      t.bits = strtoul(v, NULL, 16);
+      r.found |= GBT_FOUND_BITS;
+    } else if (KeyIs(r, 2, "height"))
+    {
+      t.height = strtoul(v, NULL, 10);
+      r.found |= GBT_FOUND_HEIGHT;
+    } else if (KeyIs(r, 2, "coinbasevalue"))
+    {
+      t.coinbase_value = strtoull(v, NULL, 10);
+      r.found |= GBT_FOUND_VALUE;
+    } else if (KeyIs(r, 2, "longpollid"))
+      r.longpollid = v;
+    return;
+  }
+  if (InTransaction(r) && r.tx_open)
+  {
+    if (KeyIs(r, 4, "txid"))
+      r.tx_txid = HexReversed(v, r.txid);
+    else if (KeyIs(r, 4, "hash"))
+      r.tx_wtxid = HexReversed(v, r.wtxid);
+    else if (KeyIs(r, 4, "fee"))
+    {
+      r.tx_fee = strtoull(v, NULL, 10);
+      r.tx_fee_known = true;
+    }
+  }
+}
+
+static void JsonStringStart(gbt_reply& r)
+{
+  r.value_len = 0;
+  r.value_data = !r.string_key && InTransaction(r) && r.tx_open && KeyIs(r, 4, "data");
+}
+
+static void JsonChar(gbt_reply& r, char c)
+{
+  if (r.value_data)
+    TransactionData(r, c);
+  else if (r.value_len < GBT_JSON_VALUE_MAX - 1)
+    r.value[r.value_len++] = c;
+}
+
+static void JsonStringEnd(gbt_reply& r)
+{
+  r.value[r.value_len] = 0;
+  if (r.string_key)
+  {
+    if (r.depth >= 1 && r.depth <= GBT_JSON_DEPTH)
+      snprintf(r.key[r.depth], GBT_JSON_KEY_MAX, "%s", r.value);
+    r.expect_key = false;
+  } else if (!r.value_data)
+    JsonValue(r, true);
+  r.value_data = false;
+}
+
+//Only the structure and the few values of the template are kept, strings we
+//don't need (transaction data past the budget) are skipped a byte at a time
+static void JsonByte(gbt_reply& r, char c)
+{
+  switch (r.json_state)
+  {
+    case JSON_STRING:
+      if (c == '\\')
+        r.json_state = JSON_ESCAPE;
+      else if (c == '"')
+      {
+        r.json_state = JSON_VALUE;
+        JsonStringEnd(r);
+      } else
+        JsonChar(r, c);
+      return;
+    case JSON_ESCAPE:
+      r.json_state = JSON_STRING;
+      JsonChar(r, c);
+      return;
+    case JSON_LITERAL:
+      if (isalnum((unsigned char)c) || c == '-' || c == '+' || c == '.')
+      {
+        JsonChar(r, c);
+        return;
+      }
+      r.value[r.value_len] = 0;
+      r.json_state = JSON_VALUE;
+      JsonValue(r, false);
+      break;
+    default:
+      break;
+  }
+
+  switch (c)
+  {
+    case '{':
+    case '[':
+      r.depth++;
+      if (r.depth <= GBT_JSON_DEPTH)
+      {
+        r.array[r.depth] = (c == '[');
+        r.key[r.depth][0] = 0;
+      }
+      r.expect_key = (c == '{');
+      if (c == '{' && InTransaction(r))
+        TransactionBegin(r);
+      break;
+    case '}':
+    case ']':
+      if (c == '}' && InTransaction(r) && r.tx_open)
+        TransactionEnd(r);
+      if (r.depth > 0)
+        r.depth--;
+      r.expect_key = false;
+      break;
+    case ',':
+      r.expect_key = r.depth >= 1 && r.depth <= GBT_JSON_DEPTH && !r.array[r.depth];
+      break;
+    case ':':
+      r.expect_key = false;
+      break;
+    case '"':
+      r.json_state = JSON_STRING;
+      r.string_key = r.expect_key;
+      JsonStringStart(r);
+      break;
+    case ' ':
+    case '\t':
+    case '\r':
+    case '\n':
+      break;
+    default:
+      r.json_state = JSON_LITERAL;
+      r.value_len = 0;
+      r.value_data = false;
+      JsonChar(r, c);
+      break;
+  }
+}
+
+static void HttpLine(gbt_reply& r)
+{
+  if (r.http_state == HTTP_STATUS)
+  {
+    //HTTP/1.1 200 OK
+    int space = r.line.indexOf(' ');
+    r.status = (space > 0) ? r.line.substring(space + 1).toInt() : 0;
+    r.http_state = HTTP_HEADERS;
+    return;
+  }
+  if (r.line.length() == 0)
+  {
+    r.http_state = HTTP_BODY;
+    if (r.content_length == 0)
+      r.done = true;
+    return;
+  }
+  String name = r.line.substring(0, r.line.indexOf(':'));
+  name.toLowerCase();
+  if (name == "content-length")
+    r.content_length = r.line.substring(r.line.indexOf(':') + 1).toInt();
+}
+
+//Bytes of the reply, returns how many were used (none past its end)
+static size_t ReplyFeed(gbt_reply& r, const uint8_t* data, size_t len)
+{
+  size_t i = 0;
+  for (; i < len && !r.done; ++i)
+  {
+    char c = (char)data[i];
+    if (r.http_state != HTTP_BODY)
+    {
+      if (c == '\n')
+      {
+        HttpLine(r);
+        r.line = "";
+      } else if (c != '\r' && r.line.length() < 256)
+        r.line += c;
+      continue;
+    }
+    JsonByte(r, c);
+    r.body_read++;
+    if (r.content_length >= 0 && r.body_read >= r.content_length)
+      r.done = true;
+  }
+  return i;
+}
+
+//A body without length ends with the connection
+static void ReplyClosed(gbt_reply& r)
+{
+  if (!r.done && r.http_state == HTTP_BODY && r.content_length < 0)
+  {
+    JsonByte(r, ' ');
+    r.done = true;
+  }
+}
+
+//Branch, witness root and coinbase value once the whole template is in
+static bool TemplateFinish(gbt_reply& r)
+{
+  gbt_template& t = *r.tmpl;
+  if (r.found != GBT_FOUND_ALL || r.fees_unknown || r.dropped_fees > t.coinbase_value)
+    return false;
+  uint8_t root[32];
+  t.branch_count = gbt_merkle_finish(r.txids, root);
+  gbt_merkle_finish(r.wtxids, t.witness_root);
+  t.coinbase_value -= r.dropped_fees;
+  t.valid = true;
+  return true;
+}
+
+//////////////////////////// Requests ///////////////////////////////
+
+static String RpcBody(const char* method, const String& params)
+{
+  return String("{\"jsonrpc\":\"1.0\",\"id\":\"nerdminer\",\"method\":\"") + method + "\",\"params\":" + params + "}";
+}
+
+static String HttpHeader(const gbt_session& s, size_t content_length)
+{
+  String header = "POST / HTTP/1.1\r\nHost: " + s.host + "\r\n";
+  if (s.auth.length() > 0)
+    header += "Authorization: Basic " + s.auth + "\r\n";
+  header += "Content-Type: application/json\r\nContent-Length: " + String((unsigned long)content_length) + "\r\n\r\n";
+  return header;
+}
+
+static bool TemplateRequest(WiFiClient& client, gbt_session& s)
+{
+  String params = "[{\"rules\":[\"segwit\"],\"capabilities\":[\"longpoll\"]";
+  if (s.longpollid.length() > 0)
+    params += ",\"longpollid\":\"" + s.longpollid + "\"";
+  params += "}]";
+  String body = RpcBody("getblocktemplate", params);
+  String request = HttpHeader(s, body.length()) + body;
+  if (client.print(request) != request.length())
+    return false;
+
+  ReplyInit(s.reply, &s.tmpl[1 - s.current]);
+  s.request_pending = true;
+  s.long_poll = s.longpollid.length() > 0;
+  s.request_time = millis();
+  return true;
+}
+
+bool gbt_connect(WiFiClient& client, gbt_session& s, const char* host, uint16_t port, const String& auth, const char* wallet)
+{
+  if (!gbt_address_script(wallet, s.script, sizeof(s.script), s.script_len))
+  {
+    Serial.printf("[GBT] %s is not a payout address, solo mining needs one\n", wallet);
+    return false;
+  }
+  if (s.buffer == NULL)
+  {
+    s.buffer = (uint8_t*)malloc(2 * GBT_BLOCK_DATA_MAX);
+    if (s.buffer == NULL)
+      return false;
+    for (int i = 0; i < 2; ++i)
+    {
+      s.tmpl[i].valid = false;
+      s.tmpl[i].data = s.buffer + i * GBT_BLOCK_DATA_MAX;
+      s.tmpl[i].data_len = 0;
+    }
+    s.current = 0;
+    s.extranonce = esp_random();
+    s.solved = false;
+    s.submit_id = 0;
+  }
+  s.host = host;
+  s.port = port;
+  s.auth = (auth.length() > 0) ? gbt_base64(auth) : String("");
+  s.request_pending = false;
+  s.longpollid = "";
+  s.next_request_time = millis();
+  s.answer_count = 0;
+  s.rx_bytes = 0;
+  Serial.printf("[WORKER] ==> Solo mining on node %s:%u\n", host, port);
+  return TemplateRequest(client, s);
+}
+
+gbt_event gbt_poll(WiFiClient& client, gbt_session& s, gbt_result& result)
+{
+  if (s.answer_count > 0)
+  {
+    result.id = s.answers[0].id;
+    result.reason = s.answers[0].reason;
+    bool accepted = s.answers[0].accepted;
+    for (int i = 1; i < s.answer_count; ++i)
+      s.answers[i - 1] = s.answers[i];
+    s.answer_count--;
+    return accepted ? GBT_EVENT_BLOCK_ACCEPTED : GBT_EVENT_BLOCK_REJECTED;
+  }
+
+  if (!s.request_pending)
+  {
+    if ((int32_t)(millis() - s.next_request_time) < 0)
+      return GBT_EVENT_NONE;
+    return TemplateRequest(client, s) ? GBT_EVENT_NONE : GBT_EVENT_CLOSE;
+  }
+
+  uint8_t data[256];
+  size_t total = 0;
+  while (!s.reply.done && total < GBT_READ_CHUNK && client.available() > 0)
+  {
+    int n = client.read(data, sizeof(data));
+    if (n <= 0)
+      break;
+    total += n;
+    s.rx_bytes += n;
+    ReplyFeed(s.reply, data, n);
+  }
+  if (!s.reply.done)
+  {
+    if (!client.connected())
+      ReplyClosed(s.reply);
+    if (!s.reply.done)
+    {
+      if (!client.connected() || (!s.long_poll && millis() - s.request_time > GBT_RPC_TIMEOUT_ms))
+        return GBT_EVENT_CLOSE;
+      return GBT_EVENT_NONE;
+    }
+  }
+
+  s.request_pending = false;
+  gbt_reply& r = s.reply;
+  uint32_t time_now = millis();
+  if (r.status == 401 || r.status == 403)
+  {
+    Serial.println("[GBT] Node refused the RPC user and password");
+    return GBT_EVENT_CLOSE;
+  }
+  if (r.error.length() > 0 || !TemplateFinish(r))
+  {
+    Serial.printf("[GBT] getblocktemplate failed (HTTP %d): %s\n", r.status, r.error.length() > 0 ? r.error.c_str() : "incomplete template");
+    s.longpollid = "";
+    s.next_request_time = time_now + GBT_POLL_ms;
+    return GBT_EVENT_OTHER;
+  }
+
+  //Mempool changes past the transactions kept: same block, keep mining it
+  const gbt_template& next = s.tmpl[1 - s.current];
+  const gbt_template& mined = s.tmpl[s.current];
+  s.longpollid = r.longpollid;
+  s.next_request_time = time_now + (s.longpollid.length() > 0 ? 0 : GBT_POLL_ms);
+  if (mined.valid && !s.solved && next.tx_count == mined.tx_count && next.coinbase_value == mined.coinbase_value && next.bits == mined.bits &&
+      next.version == mined.version && memcmp(next.prev_hash, mined.prev_hash, 32) == 0 && memcmp(next.witness_root, mined.witness_root, 32) == 0)
+    return GBT_EVENT_OTHER;
+
+  s.current = 1 - s.current;
+  s.extranonce++;
+  s.solved = false;
+  const gbt_template& t = s.tmpl[s.current];
+  Serial.printf("[GBT] Template for block %u: %u transactions (%u left out, %u bytes kept), %.8f BTC\n", t.height, t.tx_count,
+                t.tx_dropped, (uint32_t)t.data_len, t.coinbase_value / 1e8);
+  return GBT_EVENT_NEW_TEMPLATE;
+}
+
+//////////////////////////// Jobs and blocks ///////////////////////////////
+
+//BIP34 height, pushed like CScript() << height
+static void HeightPush(String& text, uint32_t height)
+{
+  if (height == 0)
+  {
+    text += "00";
+    return;
+  }
+  if (height <= 16)
+  {
+    HexAppendLE(text, 0x50 + height, 1);
+    return;
+  }
+  uint8_t bytes[5];
+  int len = 0;
+  while (height > 0)
+  {
+    bytes[len++] = height & 0xFF;
+    height >>= 8;
+  }
+  if (bytes[len - 1] & 0x80)
+    bytes[len++] = 0;
+  HexAppendLE(text, len, 1);
+  HexAppend(text, bytes, len);
+}
+
+void gbt_mining_job(gbt_session& s, mining_subscribe& mWorker, mining_job& mJob)
+{
+  const gbt_template& t = s.tmpl[s.current];
+  char text[32];
+
+  //scriptSig: height, extranonce (extranonce1 + extranonce2, 8 bytes), tag
+  String height;
+  HeightPush(height, t.height);
+  String tag;
+  HexAppend(tag, (const uint8_t*)GBT_COINBASE_TAG, strlen(GBT_COINBASE_TAG));
+  size_t script_len = height.length() / 2 + 1 + 8 + 1 + strlen(GBT_COINBASE_TAG);
+
+  mJob.coinb1 = "01000000010000000000000000000000000000000000000000000000000000000000000000ffffffff";
+  HexAppendLE(mJob.coinb1, script_len, 1);
+  mJob.coinb1 += height + "08";
+
+  //Payout and witness commitment (over the transactions kept, not the whole template)
+  uint8_t commitment[64];
+  memcpy(commitment, t.witness_root, 32);
+  memset(commitment + 32, 0, 32);   //Witness reserved value of the coinbase
+  Sha256d(commitment, commitment, sizeof(commitment));
+  String coinb2;
+  HexAppendLE(coinb2, strlen(GBT_COINBASE_TAG), 1);
+  coinb2 += tag + "ffffffff02";
+  HexAppendLE(coinb2, t.coinbase_value, 8);
+  HexAppendLE(coinb2, s.script_len, 1);
+  HexAppend(coinb2, s.script, s.script_len);
+  coinb2 += "0000000000000000266a24aa21a9ed";
+  HexAppend(coinb2, commitment, 32);
+  coinb2 += "00000000";
+  mJob.coinb2 = coinb2;
+
+  snprintf(text, sizeof(text), "%08x", s.extranonce);
+  mWorker.extranonce1 = text;
+  mWorker.extranonce2_size = 4;
+  mWorker.extranonce2 = "00000000";
+  mWorker.version_mask = VERSION_ROLLING_MASK;  //Nobody to ask, BIP320 bits are free
+  s.coinbase = mJob.coinb1 + mWorker.extranonce1 + mWorker.extranonce2 + mJob.coinb2;
+
+  mJob.merkle_branch.clear();
+  for (int i = 0; i < t.branch_count; ++i)
+  {
+    String branch;
+    HexAppend(branch, t.branch[i], 32);
+    mJob.merkle_branch.push_back(branch);
+  }
+
+  //Previous hash with its 32 bit words swapped, like mining.notify
+  mJob.prev_block_hash = "";
+  for (int w = 0; w < 8; ++w)
+    for (int i = 3; i >= 0; --i)
+      HexAppend(mJob.prev_block_hash, &t.prev_hash[4 * w + i], 1);
+  snprintf(text, sizeof(text), "%u.%08x", t.height, s.extranonce);
+  mJob.job_id = text;
+  snprintf(text, sizeof(text), "%08x", t.version);
+  mJob.version = text;
+  snprintf(text, sizeof(text), "%08x", t.bits);
+  mJob.nbits = text;
+  snprintf(text, sizeof(text), "%08x", t.curtime);
+  mJob.ntime = text;
+  mJob.clean_jobs = true;
+}
+
+bool gbt_submit_block(gbt_session& s, const uint8_t header[80], unsigned long& submit_id)
+{
+  if (s.solved || s.answer_count == GBT_ANSWERS)
+    return false;
+  const gbt_template& t = s.tmpl[s.current];
+  submit_id = ++s.submit_id;
+
+  //Header, transaction count, coinbase with its witness (the reserved value), transactions
+  String head = "{\"jsonrpc\":\"1.0\",\"id\":\"nerdminer\",\"method\":\"submitblock\",\"params\":[\"";
+  HexAppend(head, header, 80);
+  HexAppendVarInt(head, t.tx_count + 1);
+  size_t cb = s.coinbase.length();
+  head += s.coinbase.substring(0, 8) + "0001" + s.coinbase.substring(8, cb - 8);
+  head += "0120";
+  for (int i = 0; i < 32; ++i)
+    head += "00";
+  head += s.coinbase.substring(cb - 8);
+  const char* tail = "\"]}";
+  size_t body_length = head.length() + 2 * t.data_len + strlen(tail);
+
+  gbt_answer& answer = s.answers[s.answer_count++];
+  answer.id = submit_id;
+  answer.accepted = false;
+  WiFiClient node;
+  if (!node.connect(s.host.c_str(), s.port))
+  {
+    answer.reason = "node unreachable";
+    return true;
+  }
+  node.setNoDelay(true);
+  node.print(HttpHeader(s, body_length));
+  node.print(head);
+  char chunk[257];
+  for (size_t i = 0; i < t.data_len; i += 128)
+  {
+    size_t n = (t.data_len - i < 128) ? t.data_len - i : 128;
+    for (size_t j = 0; j < n; ++j)
+      snprintf(chunk + 2 * j, 3, "%02x", t.data[i + j]);
+    node.write((const uint8_t*)chunk, 2 * n);
+  }
+  node.print(tail);
+
+  gbt_reply reply;
+  ReplyInit(reply, NULL);
+  uint32_t start = millis();
+  uint8_t data[256];
+  while (!reply.done && millis() - start < GBT_RPC_TIMEOUT_ms)
+  {
+    if (node.available() > 0)
+    {
+      int n = node.read(data, sizeof(data));
+      if (n > 0)
+        ReplyFeed(reply, data, n);
+    } else if (!node.connected())
+    {
+      ReplyClosed(reply);
+      break;
+    } else
+      delay(1);
+  }
+  node.stop();
+
+  //BIP22: null when accepted, else the reason
+  answer.accepted = reply.done && reply.status == 200 && reply.result_null && reply.error.length() == 0;
+  if (!reply.done)
+    answer.reason = "no answer";
+  else if (reply.error.length() > 0)
+    answer.reason = reply.error;
+  else
+    answer.reason = reply.result;
+  if (answer.accepted)
+  {
+    //Tip moved, the template is stale: refresh now if no long poll is waiting for it
+    s.solved = true;
+    if (!s.request_pending)
+      s.next_request_time = millis();
+  }
+  return true;
+}
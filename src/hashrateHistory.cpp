@@ -0,0 +1,217 @@
+#include <Arduino.h>
+#include <nvs.h>
+#include <math.h>
+#include <mutex>
+#include "hashrateHistory.h"
+#include "logger.h"
+#include "utils.h"
+
+#ifdef HASHRATE_HISTORY
+
+#define HISTORY_SECOND_SAMPLES    600     //10 minutes
+#define HISTORY_MINUTE_SAMPLES    1440    //24 hours
+#define HISTORY_QUARTER_SAMPLES   672     //7 days
+
+static history_sample s_second_samples[HISTORY_SECOND_SAMPLES];
+static history_sample s_minute_samples[HISTORY_MINUTE_SAMPLES];
+static history_sample s_quarter_samples[HISTORY_QUARTER_SAMPLES];
+
+static history_archive s_archives[HISTORY_ARCHIVES] = {
+  { "s", HISTORY_SECOND_SAMPLES, 1, 0, s_second_samples },
+  { "m", HISTORY_MINUTE_SAMPLES, 60, 0, s_minute_samples },
+  { "q", HISTORY_QUARTER_SAMPLES, 15 * 60, 0, s_quarter_samples },
+};
+
+//Open period of an archive, filled by the samples of the finer one
+typedef struct {
+  double khs;
+  uint32_t shares;
+  float temperature;
+  uint16_t samples;
+} history_period;
+
+static history_period s_periods[HISTORY_ARCHIVES];
+static uint32_t s_shares_accepted = 0;
+static bool s_started = false;
+static uint32_t s_saved_count = 0;
+//Sample writes of the monitor task against the console and metrics tasks reading
+static std::mutex s_history_mutex;
+
+static history_sample HistorySample(double khs, uint32_t shares, float temperature, double difficulty)
+{
+  history_sample sample;
+  double hashrate = khs * HISTORY_KHS_SCALE + 0.5;
+  sample.hashrate = hashrate <= 0.0 ? 0 : hashrate >= 65535.0 ? 65535 : (uint16_t)hashrate;
+  sample.shares = shares > 255 ? 255 : shares;
+  sample.temperature = temperature < -128.0f ? -128 : temperature > 127.0f ? 127 : (int8_t)lroundf(temperature);
+  double log_difficulty = difficulty > 0.0 ? log2(difficulty) * 256.0 : -32768.0;
+  sample.difficulty = log_difficulty <= -32768.0 ? -32768 : log_difficulty >= 32767.0 ? 32767 : (int16_t)lround(log_difficulty);
+  return sample;
+}
+
+static void HistoryAdd(int index, double khs, uint32_t shares, float temperature, double difficulty)
+{
+  history_archive& archive = s_archives[index];
+  {
+    std::lock_guard<std::mutex> lock(s_history_mutex);
+    archive.samples[archive.count % archive.size] = HistorySample(khs, shares, temperature, difficulty);
+    archive.count++;
+  }
+
+  if (index + 1 >= HISTORY_ARCHIVES)
+    return;
+  history_period& period = s_periods[index + 1];
+  period.khs += khs;
+  period.shares += shares;
+  period.temperature += temperature;
+  period.samples++;
+  if (period.samples * archive.seconds < s_archives[index + 1].seconds)
+    return;
+  HistoryAdd(index + 1, period.khs / period.samples, period.shares, period.temperature / period.samples, difficulty);
+  period = history_period();
+}
+
+void history_update(double khs, uint32_t shares_accepted, double pool_difficulty, float temperature)
+{
+  if (!s_started)
+  {
+    s_shares_accepted = shares_accepted;
+    s_started = true;
+  }
+  uint32_t shares = shares_accepted - s_shares_accepted;
+  s_shares_accepted = shares_accepted;
+  HistoryAdd(HISTORY_SECOND, khs, shares, temperature, pool_difficulty);
+}
+
+const history_archive& history_get(int archive)
+{
+  return s_archives[archive];
+}
+
+const history_sample& history_sample_at(const history_archive& archive, uint32_t n)
+{
+  return archive.samples[(archive.count - 1 - n) % archive.size];
+}
+
+double history_khs(const history_sample& sample)
+{
+  return (double)sample.hashrate / HISTORY_KHS_SCALE;
+}
+
+double history_difficulty(const history_sample& sample)
+{
+  if (sample.difficulty == -32768)
+    return 0.0;
+  return exp2(sample.difficulty / 256.0);
+}
+
+//Only the 7 day archive, the finer ones would not fit the NVS partition
+typedef struct {
+  uint32_t count;
+  history_sample samples[HISTORY_QUARTER_SAMPLES];
+} history_saved;
+
+void history_restore(nvs_handle_t handle)
+{
+  static history_saved saved;
+  size_t size = sizeof(saved);
+  uint32_t nv_crc = 0;
+  if (nvs_get_blob(handle, "history", &saved, &size) != ESP_OK || size != sizeof(saved) ||
+      nvs_get_u32(handle, "history_crc", &nv_crc) != ESP_OK)
+    return;
+  uint32_t crc = crc32_reset();
+  crc = crc32_add(crc, &saved, sizeof(saved));
+  crc = crc32_finish(crc);
+  if (crc != nv_crc)
+  {
+    LOG_W("[HISTORY] Saved history is corrupted, dropped\n");
+    return;
+  }
+
+  history_archive& archive = s_archives[HISTORY_QUARTER];
+  std::lock_guard<std::mutex> lock(s_history_mutex);
+  memcpy(archive.samples, saved.samples, sizeof(saved.samples));
+  archive.count = saved.count;
+  s_saved_count = saved.count;
+}
+
+void history_save(nvs_handle_t handle)
+{
+  const history_archive& archive = s_archives[HISTORY_QUARTER];
+  //Monitor task, no lock for reading
+  if (archive.count == s_saved_count)
+    return;
+  static history_saved saved;
+  saved.count = archive.count;
+  memcpy(saved.samples, archive.samples, sizeof(saved.samples));
+  uint32_t crc = crc32_reset();
+  crc = crc32_add(crc, &saved, sizeof(saved));
+  crc = crc32_finish(crc);
+  if (nvs_set_blob(handle, "history", &saved, sizeof(saved)) != ESP_OK || nvs_set_u32(handle, "history_crc", crc) != ESP_OK)
+  {
+    LOG_W("[HISTORY] Saving the history failed\n");
+    return;
+  }
+  s_saved_count = archive.count;
+}
+
+int history_archive_from(const char* name)
+{
+  for (int i = 0; i < HISTORY_ARCHIVES; ++i)
+    if (strcmp(name, s_archives[i].name) == 0)
+      return i;
+  return -1;
+}
+
+void history_csv(int index, void (*line)(const char* text, void* context), void* context)
+{
+  const history_archive& archive = s_archives[index];
+  char text[64];
+  line("seconds_ago,khs,shares,difficulty,celsius", context);
+
+  uint32_t end;
+  {
+    std::lock_guard<std::mutex> lock(s_history_mutex);
+    end = archive.count;
+  }
+  uint32_t start = end > archive.size ? end - archive.size : 0;
+  for (uint32_t n = start; n < end; ++n)
+  {
+    history_sample sample;
+    {
+      //The monitor task goes on adding samples, skip the ones overwritten meanwhile
+      std::lock_guard<std::mutex> lock(s_history_mutex);
+      if (archive.count - n > archive.size)
+        continue;
+      sample = archive.samples[n % archive.size];
+    }
+    snprintf(text, sizeof(text), "%u,%.1f,%u,%.6g,%d", (unsigned)((end - n) * archive.seconds), history_khs(sample),
+             (unsigned)sample.shares, history_difficulty(sample), (int)sample.temperature);
+    line(text, context);
+  }
+}
+
+static void HistoryPrintLine(const char* text, void* context)
+{
+  Serial.println(text);
+}
+
+void history_command(const char* args)
+{
+  int archive = history_archive_from(*args ? args : "s");
+  if (archive < 0)
+  {
+    Serial.println("history s|m|q: 1s samples over 10 minutes, 1 minute over 24 hours, 15 minutes over 7 days");
+    return;
+  }
+  //The logger waits, the CSV lines come out in one piece
+  logger_hold(true);
+  const history_archive& selected = s_archives[archive];
+  Serial.printf("[HISTORY] %s archive, %u samples of %us\n", selected.name,
+                (unsigned)(selected.count < selected.size ? selected.count : selected.size), (unsigned)selected.seconds);
+  history_csv(archive, HistoryPrintLine, NULL);
+  Serial.println("[HISTORY] end");
+  logger_hold(false);
+}
+
+#endif // HASHRATE_HISTORY
@@ -0,0 +1,83 @@
+#ifndef HASHRATE_HISTORY_H
+#define HASHRATE_HISTORY_H
+
+#include <Arduino.h>
+#include <nvs.h>
+
+/************************************************************************************
+*   Hashrate history, round robin archives in fixed memory.
+*
+*   The monitor task adds one sample per tick (1s): hashrate, shares accepted, pool
+*   difficulty and chip temperature. Every 60 of them make a 1 minute sample and
+*   every 15 of those a 15 minute one:
+*
+*     HISTORY_SECOND   1s samples over 10 minutes
+*     HISTORY_MINUTE   1 minute samples over 24 hours
+*     HISTORY_QUARTER  15 minute samples over 7 days
+*
+*   6 bytes a sample, 16KB in all. The 7 day archive is saved with the other stats
+*   (Settings.saveStats), samples follow each other in mining time: the time the
+*   miner was off leaves no gap.
+*
+*   Serial console "history [s|m|q]" and, with the metrics server, GET /history?s|m|q
+*   dump an archive as CSV, oldest first.
+*
+*   Build with -D HASHRATE_HISTORY
+*************************************************************************************/
+
+#ifdef HASHRATE_HISTORY
+
+#ifdef NERDMINER_HOST
+#define HISTORY_KHS_SCALE     1       //Hashrate unit of the samples, 1 KH/s up to 65 MH/s
+#else
+#define HISTORY_KHS_SCALE     10      //0.1 KH/s up to 6.5 MH/s
+#endif
+
+enum {
+  HISTORY_SECOND = 0,
+  HISTORY_MINUTE,
+  HISTORY_QUARTER,
+  HISTORY_ARCHIVES
+};
+
+typedef struct __attribute__((packed)) {
+  uint16_t hashrate;      //KH/s * HISTORY_KHS_SCALE
+  uint8_t shares;         //Accepted in the period, saturates
+  int8_t temperature;     //Celsius
+  int16_t difficulty;     //log2(pool difficulty) * 256
+} history_sample;
+
+typedef struct {
+  const char* name;
+  uint16_t size;          //Samples
+  uint16_t seconds;       //Period of a sample
+  uint32_t count;         //Samples since boot (restored for the persisted one), sample n at n % size
+  history_sample* samples;
+} history_archive;
+
+//Monitor task, once per tick
+void history_update(double khs, uint32_t shares_accepted, double pool_difficulty, float temperature);
+
+const history_archive& history_get(int archive);
+
+//Sample n of the archive, 0 the newest. Call with n < min(count, size).
+const history_sample& history_sample_at(const history_archive& archive, uint32_t n);
+
+double history_khs(const history_sample& sample);
+double history_difficulty(const history_sample& sample);
+
+//Persisted 7 day archive, from restoreStat/saveStat
+void history_restore(nvs_handle_t handle);
+void history_save(nvs_handle_t handle);
+
+//"s", "m" or "q"
+int history_archive_from(const char* name);
+//CSV of an archive, oldest first, one line at a time
+void history_csv(int archive, void (*line)(const char* text, void* context), void* context);
+
+//Serial console "history"
+void history_command(const char* args);
+
+#endif // HASHRATE_HISTORY
+
+#endif // HASHRATE_HISTORY_H
@@ -0,0 +1,97 @@
+#include <Arduino.h>
+#include <math.h>
+#include "hashrateStats.h"
+
+#define HASHRATE_SKIP_FIRST   3     //Ticks before the top hashrate follows, the miners are starting
+
+static const double s_windows_s[HASHRATE_WINDOWS] = { 60.0, 15 * 60.0, 60 * 60.0, 24 * 60 * 60.0 };
+
+static hashrate_stats s_stats = { 0.0, { 0.0 }, 0.0, 2 };
+static double s_samples[HASHRATE_SAMPLES];
+static uint8_t s_sample_next = 0;
+static uint8_t s_sample_count = 0;
+static double s_weights[HASHRATE_WINDOWS];    //Share of the average already filled, 1 once a window has passed
+static uint32_t s_worker_hashes[MINING_WORKERS];
+static double s_worker_weights[MINING_WORKERS];
+
+//Exponential average over window_s seconds of samples dt seconds apart. Until the
+//window has passed it is the plain average of the samples so far, the boot doesn't
+//drag the 24h average down for a day.
+static void HashrateAverage(double& average, double& weight, double rate, double dt, double window_s)
+{
+  double alpha = 1.0 - exp(-dt / window_s);
+  weight = weight * (1.0 - alpha) + alpha;
+  average += (rate - average) * alpha / weight;
+}
+
+void hashrate_stats_update(uint32_t elapsed_khs, uint32_t elapsed_ms)
+{
+  if (elapsed_ms == 0)
+    return;
+  double dt = elapsed_ms / 1000.0;
+  double rate = elapsed_khs / dt;
+  s_stats.ticks++;
+
+  s_samples[s_sample_next] = rate;
+  s_sample_next = (s_sample_next + 1) % HASHRATE_SAMPLES;
+  if (s_sample_count < HASHRATE_SAMPLES)
+    s_sample_count++;
+  double sum = 0.0;
+  for (int i = 0; i < s_sample_count; ++i)
+    sum += s_samples[i];
+  s_stats.current = sum / s_sample_count;
+
+  for (int w = 0; w < HASHRATE_WINDOWS; ++w)
+    HashrateAverage(s_stats.average[w], s_weights[w], rate, dt, s_windows_s[w]);
+
+  if (s_stats.ticks > HASHRATE_SKIP_FIRST && s_stats.current > s_stats.top)
+  {
+    s_stats.top = s_stats.current;
+    if (s_stats.top > 999.9)
+      s_stats.decimals = 0;
+    else if (s_stats.top > 99.9)
+      s_stats.decimals = 1;
+  }
+
+  mining_worker workers[MINING_WORKERS];
+  int count = mining_workers(workers);
+  for (int e = 0; e < ENGINES; ++e)
+    s_stats.engine[e] = 0.0;
+  for (int i = 0; i < count; ++i)
+  {
+    hashrate_worker& worker = s_stats.worker[i];
+    if (i >= s_stats.workers)
+    {
+      //Started since the last tick
+      worker.rate = 0.0;
+      s_worker_weights[i] = 0.0;
+      s_worker_hashes[i] = workers[i].hashes;
+      worker.name = workers[i].name;
+      worker.engine = workers[i].engine;
+      continue;
+    }
+    double worker_rate = (uint32_t)(workers[i].hashes - s_worker_hashes[i]) / 1000.0 / dt;
+    s_worker_hashes[i] = workers[i].hashes;
+    HashrateAverage(worker.rate, s_worker_weights[i], worker_rate, dt, s_windows_s[HASHRATE_1M]);
+    s_stats.engine[worker.engine] += worker.rate;
+  }
+  s_stats.workers = count;
+}
+
+const hashrate_stats& hashrate_stats_get(void)
+{
+  return s_stats;
+}
+
+void hashrate_stats_command(const char* args)
+{
+  static const char* const engines[ENGINES] = { "software", "hardware", "I2C" };
+  const hashrate_stats& stats = hashrate_stats_get();
+  Serial.printf("[HASHRATE] %.2f KH/s | 1m %.2f | 15m %.2f | 1h %.2f | 24h %.2f | top %.2f\n", stats.current, stats.average[HASHRATE_1M],
+                stats.average[HASHRATE_15M], stats.average[HASHRATE_1H], stats.average[HASHRATE_24H], stats.top);
+  for (int i = 0; i < stats.workers; ++i)
+    Serial.printf("  %-16s %-8s %10.2f KH/s\n", stats.worker[i].name, engines[stats.worker[i].engine], stats.worker[i].rate);
+  for (int e = 0; e < ENGINES; ++e)
+    if (stats.engine[e] > 0.0)
+      Serial.printf("  %-16s %-8s %10.2f KH/s\n", "engine", engines[e], stats.engine[e]);
+}
@@ -0,0 +1,55 @@
+#ifndef HASHRATE_STATS_H
+#define HASHRATE_STATS_H
+
+#include <Arduino.h>
+#include "mining.h"
+
+/************************************************************************************
+*   Hashrate statistics, fixed memory.
+*
+*   The monitor task calls hashrate_stats_update() once per tick with the KH hashed
+*   since the previous one. It keeps the last HASHRATE_SAMPLES rates in a ring (the
+*   screens show their average), exponential averages over 1m, 15m, 1h and 24h, and
+*   the rate of each miner task and SHA engine.
+*
+*   Readers get a const reference and change nothing, a screen can ask for the
+*   hashrate as often as it wants. Updated by the monitor task only, the screens run
+*   in it.
+*************************************************************************************/
+
+#define HASHRATE_SAMPLES    10    //Ticks averaged by the screens
+
+enum {
+  HASHRATE_1M = 0,
+  HASHRATE_15M,
+  HASHRATE_1H,
+  HASHRATE_24H,
+  HASHRATE_WINDOWS
+};
+
+typedef struct {
+  const char* name;
+  uint8_t engine;
+  double rate;                    //KH/s, 1 minute average
+} hashrate_worker;
+
+typedef struct {
+  double current;                 //KH/s, average of the last HASHRATE_SAMPLES ticks
+  double average[HASHRATE_WINDOWS]; //KH/s, exponential
+  double top;                     //Highest current since boot, past the first ticks
+  uint8_t decimals;               //Display precision, from the top hashrate
+  uint32_t ticks;
+  int workers;
+  hashrate_worker worker[MINING_WORKERS];
+  double engine[ENGINES];         //KH/s, 1 minute average
+} hashrate_stats;
+
+//Monitor task, once per tick
+void hashrate_stats_update(uint32_t elapsed_khs, uint32_t elapsed_ms);
+
+const hashrate_stats& hashrate_stats_get(void);
+
+//Serial console "hashrate"
+void hashrate_stats_command(const char* args);
+
+#endif // HASHRATE_STATS_H
@@ -0,0 +1,46 @@
+/************************************************************************************
+*   Minimal Arduino-ESP32 stand-in for the native (host) build.
+*   Only what the shared mining sources need, nothing more.
+*************************************************************************************/
+#ifndef HOST_ARDUINO_H_
+#define HOST_ARDUINO_H_
+
+#ifdef NERDMINER_HOST
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <limits.h>
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+
+#ifndef likely
+#define likely(x)   __builtin_expect(!!(x), 1)
+#define unlikely(x) __builtin_expect(!!(x), 0)
+#endif
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "WString.h"
+#include "HardwareSerial.h"
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(uint32_t ms);
+long random(long howbig);
+long random(long howsmall, long howbig);
+
+#endif // NERDMINER_HOST
+
+#endif // HOST_ARDUINO_H_
@@ -0,0 +1,441 @@
+/************************************************************************************
+*   Arduino core / FreeRTOS stand-ins for the native (host) build.
+*************************************************************************************/
+#ifdef NERDMINER_HOST
+
+#include <Arduino.h>
+#include <ctype.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdarg.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//////////////////////////// Time ///////////////////////////////
+
+static const std::chrono::steady_clock::time_point s_boot_time = std::chrono::steady_clock::now();
+
+unsigned long millis(void)
+{
+    //Wraps at 32 bits like on the ESP32
+    return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - s_boot_time).count();
+}
+
+unsigned long micros(void)
+{
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - s_boot_time).count();
+}
+
+void delay(uint32_t ms)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+long random(long howbig)
+{
+    if (howbig <= 0)
+        return 0;
+    return rand() % howbig;
+}
+
+long random(long howsmall, long howbig)
+{
+    if (howsmall >= howbig)
+        return howsmall;
+    return howsmall + random(howbig - howsmall);
+}
+
+//////////////////////////// String ///////////////////////////////
+
+static std::string ultoa_base(unsigned long long value, unsigned char base)
+{
+    if (base < 2 || base > 36)
+        base = 10;
+    char buf[72];
+    char* p = buf + sizeof(buf) - 1;
+    *p = 0;
+    do
+    {
+        unsigned digit = value % base;
+        *--p = digit < 10 ? '0' + digit : 'a' + digit - 10;
+        value /= base;
+    } while (value);
+    return std::string(p);
+}
+
+String::String(long value, unsigned char base) : String((long long)value, base) {}
+String::String(unsigned long value, unsigned char base) : String((unsigned long long)value, base) {}
+
+String::String(long long value, unsigned char base)
+{
+    if (value < 0 && base == DEC)
+        s = "-" + ultoa_base(-(unsigned long long)value, base);
+    else
+        s = ultoa_base((unsigned long long)value, base);
+}
+
+String::String(unsigned long long value, unsigned char base) : s(ultoa_base(value, base)) {}
+
+String::String(double value, unsigned int decimalPlaces)
+{
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", decimalPlaces, value);
+    s = buf;
+}
+
+StringSumHelper operator+(const String& lhs, const String& rhs) { StringSumHelper r(lhs); r.concat(rhs); return r; }
+StringSumHelper operator+(const String& lhs, const char* rhs) { StringSumHelper r(lhs); r.concat(rhs); return r; }
+StringSumHelper operator+(const char* lhs, const String& rhs) { StringSumHelper r(lhs); r.concat(rhs); return r; }
+StringSumHelper operator+(const String& lhs, char rhs) { StringSumHelper r(lhs); r.concat(rhs); return r; }
+
+bool String::equalsIgnoreCase(const String& rhs) const
+{
+    return s.size() == rhs.s.size() && strcasecmp(s.c_str(), rhs.s.c_str()) == 0;
+}
+
+bool String::endsWith(const String& suffix) const
+{
+    return s.size() >= suffix.s.size() && s.compare(s.size() - suffix.s.size(), suffix.s.size(), suffix.s) == 0;
+}
+
+int String::indexOf(char c, unsigned int fromIndex) const
+{
+    size_t pos = s.find(c, fromIndex);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::indexOf(const String& str, unsigned int fromIndex) const
+{
+    size_t pos = s.find(str.s, fromIndex);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::lastIndexOf(char c) const
+{
+    size_t pos = s.rfind(c);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+String String::substring(unsigned int beginIndex, unsigned int endIndex) const
+{
+    if (beginIndex > endIndex)
+        std::swap(beginIndex, endIndex);
+    if (beginIndex >= s.size())
+        return String();
+    if (endIndex > s.size())
+        endIndex = s.size();
+    return String(s.substr(beginIndex, endIndex - beginIndex));
+}
+
+void String::replace(const String& find, const String& replace)
+{
+    if (find.s.empty())
+        return;
+    size_t pos = 0;
+    while ((pos = s.find(find.s, pos)) != std::string::npos)
+    {
+        s.replace(pos, find.s.size(), replace.s);
+        pos += replace.s.size();
+    }
+}
+
+void String::remove(unsigned int index, unsigned int count)
+{
+    if (index < s.size())
+        s.erase(index, count);
+}
+
+void String::toLowerCase()
+{
+    for (auto& c : s)
+        c = tolower((unsigned char)c);
+}
+
+void String::toUpperCase()
+{
+    for (auto& c : s)
+        c = toupper((unsigned char)c);
+}
+
+void String::trim()
+{
+    size_t begin = 0;
+    while (begin < s.size() && isspace((unsigned char)s[begin]))
+        ++begin;
+    size_t end = s.size();
+    while (end > begin && isspace((unsigned char)s[end - 1]))
+        --end;
+    s = s.substr(begin, end - begin);
+}
+
+//////////////////////////// Serial ///////////////////////////////
+
+HardwareSerial Serial;
+
+//Tasks print concurrently, keep every call on its own line of output
+static std::mutex s_serial_mutex;
+
+size_t HardwareSerial::write(uint8_t c)
+{
+    return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size)
+{
+    std::lock_guard<std::mutex> lock(s_serial_mutex);
+    return fwrite(buffer, 1, size, stdout);
+}
+
+size_t HardwareSerial::printf(const char* format, ...)
+{
+    char buf[512];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    if (len < 0)
+        return 0;
+    if ((size_t)len >= sizeof(buf))
+        len = sizeof(buf) - 1;
+    return write((const uint8_t*)buf, len);
+}
+
+void HardwareSerial::flush()
+{
+    std::lock_guard<std::mutex> lock(s_serial_mutex);
+    fflush(stdout);
+}
+
+int HardwareSerial::available()
+{
+    struct pollfd pfd = { STDIN_FILENO, POLLIN, 0 };
+    return poll(&pfd, 1, 0) > 0 && (pfd.revents & POLLIN) ? 1 : 0;
+}
+
+int HardwareSerial::read()
+{
+    if (!available())
+        return -1;
+    unsigned char c;
+    return ::read(STDIN_FILENO, &c, 1) == 1 ? c : -1;
+}
+
+String HardwareSerial::readStringUntil(char terminator)
+{
+    String line;
+    unsigned long start = millis();
+    while (millis() - start < _timeout)
+    {
+        int c = read();
+        if (c < 0)
+        {
+            delay(1);
+            continue;
+        }
+        if (c == terminator)
+            break;
+        line += (char)c;
+    }
+    return line;
+}
+
+//////////////////////////// FreeRTOS tasks ///////////////////////////////
+
+struct host_task
+{
+    pthread_t thread;
+    TaskFunction_t fn;
+    void* param;
+    char name[16];
+    int core;
+    UBaseType_t priority;
+    std::mutex notify_mutex;
+    std::condition_variable notify_cv;
+    uint32_t notify_value;
+};
+
+static thread_local host_task* s_current_task = NULL;
+static std::mutex s_tasks_mutex;
+static std::vector<host_task*> s_tasks;
+
+static void host_task_add(host_task* task)
+{
+    std::lock_guard<std::mutex> lock(s_tasks_mutex);
+    s_tasks.push_back(task);
+}
+
+static void* host_task_entry(void* arg)
+{
+    host_task* task = (host_task*)arg;
+    s_current_task = task;
+    pthread_setname_np(pthread_self(), task->name);
+    task->fn(task->param);
+    return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack_depth, void* param,
+                                   UBaseType_t priority, TaskHandle_t* handle, BaseType_t core_id)
+{
+    host_task* task = new host_task();
+    task->fn = fn;
+    task->param = param;
+    task->core = core_id;
+    task->priority = priority;
+    snprintf(task->name, sizeof(task->name), "%s", name ? name : "task");
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    //ESP32 stack sizes are in bytes and tuned for the device, give host threads some headroom
+    size_t stack = (size_t)stack_depth * 4;
+    if (stack < 256 * 1024)
+        stack = 256 * 1024;
+    pthread_attr_setstacksize(&attr, stack);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    if (core_id != tskNO_AFFINITY)
+    {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(core_id % (cpus > 0 ? cpus : 1), &set);
+        pthread_attr_setaffinity_np(&attr, sizeof(set), &set);
+    }
+    int err = pthread_create(&task->thread, &attr, host_task_entry, task);
+    pthread_attr_destroy(&attr);
+    if (err != 0)
+    {
+        delete task;
+        return pdFAIL;
+    }
+    host_task_add(task);
+    if (handle)
+        *handle = task;
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack_depth, void* param,
+                       UBaseType_t priority, TaskHandle_t* handle)
+{
+    return xTaskCreatePinnedToCore(fn, name, stack_depth, param, priority, handle, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t handle)
+{
+    if (handle == NULL)
+    {
+        {
+            std::lock_guard<std::mutex> lock(s_tasks_mutex);
+            s_tasks.erase(std::remove(s_tasks.begin(), s_tasks.end(), s_current_task), s_tasks.end());
+        }
+        pthread_exit(NULL);
+    }
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    delay(ticks * portTICK_PERIOD_MS);
+}
+
+void vTaskPrioritySet(TaskHandle_t handle, UBaseType_t priority)
+{
+    (handle ? handle : xTaskGetCurrentTaskHandle())->priority = priority;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return millis() / portTICK_PERIOD_MS;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t handle)
+{
+    (void)handle;
+    return 0;
+}
+
+char* pcTaskGetName(TaskHandle_t handle)
+{
+    return (handle ? handle : xTaskGetCurrentTaskHandle())->name;
+}
+
+UBaseType_t uxTaskGetSystemState(TaskStatus_t* status, UBaseType_t count, uint32_t* total_run_time)
+{
+    std::lock_guard<std::mutex> lock(s_tasks_mutex);
+    if (s_tasks.size() > count)
+        return 0;
+    for (size_t i = 0; i < s_tasks.size(); ++i)
+    {
+        host_task* task = s_tasks[i];
+        clockid_t clock;
+        struct timespec ts = { 0, 0 };
+        if (pthread_getcpuclockid(task->thread, &clock) == 0)
+            clock_gettime(clock, &ts);
+        status[i] = TaskStatus_t();
+        status[i].xHandle = task;
+        status[i].pcTaskName = task->name;
+        status[i].xTaskNumber = i + 1;
+        status[i].eCurrentState = eReady;
+        status[i].uxCurrentPriority = status[i].uxBasePriority = task->priority;
+        status[i].ulRunTimeCounter = (uint32_t)((uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000);
+    }
+    if (total_run_time)
+        *total_run_time = micros();
+    return s_tasks.size();
+}
+
+BaseType_t xTaskGetAffinity(TaskHandle_t handle)
+{
+    return handle->core;
+}
+
+BaseType_t xPortGetCoreID(void)
+{
+    return sched_getcpu();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    //Threads not started by xTaskCreate (main) get a handle on first use
+    if (s_current_task == NULL)
+    {
+        s_current_task = new host_task();
+        s_current_task->thread = pthread_self();
+        snprintf(s_current_task->name, sizeof(s_current_task->name), "main");
+        s_current_task->core = tskNO_AFFINITY;
+        host_task_add(s_current_task);
+    }
+    return s_current_task;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t handle)
+{
+    {
+        std::lock_guard<std::mutex> lock(handle->notify_mutex);
+        handle->notify_value++;
+    }
+    handle->notify_cv.notify_one();
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks)
+{
+    host_task* task = xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> lock(task->notify_mutex);
+    if (ticks == portMAX_DELAY)
+        task->notify_cv.wait(lock, [task] { return task->notify_value != 0; });
+    else
+        task->notify_cv.wait_for(lock, std::chrono::milliseconds((uint64_t)ticks * portTICK_PERIOD_MS),
+                                 [task] { return task->notify_value != 0; });
+    uint32_t value = task->notify_value;
+    if (value != 0)
+        task->notify_value = clear_on_exit ? 0 : value - 1;
+    return value;
+}
+
+#endif // NERDMINER_HOST
@@ -0,0 +1,105 @@
+/************************************************************************************
+*   Arduino String stand-in for the native (host) build, backed by std::string.
+*************************************************************************************/
+#ifndef HOST_WSTRING_H_
+#define HOST_WSTRING_H_
+
+#ifdef NERDMINER_HOST
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string>
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+class StringSumHelper;
+
+class String
+{
+public:
+    String() {}
+    String(const char* cstr) : s(cstr ? cstr : "") {}
+    String(const char* cstr, unsigned int length) : s(cstr ? cstr : "", cstr ? length : 0) {}
+    String(const std::string& str) : s(str) {}
+    explicit String(char c) : s(1, c) {}
+    explicit String(unsigned char value, unsigned char base = DEC) : String((unsigned long)value, base) {}
+    explicit String(int value, unsigned char base = DEC) : String((long)value, base) {}
+    explicit String(unsigned int value, unsigned char base = DEC) : String((unsigned long)value, base) {}
+    explicit String(long value, unsigned char base = DEC);
+    explicit String(unsigned long value, unsigned char base = DEC);
+    explicit String(long long value, unsigned char base = DEC);
+    explicit String(unsigned long long value, unsigned char base = DEC);
+    explicit String(float value, unsigned int decimalPlaces = 2) : String((double)value, decimalPlaces) {}
+    explicit String(double value, unsigned int decimalPlaces = 2);
+
+    const char* c_str() const { return s.c_str(); }
+    unsigned int length() const { return (unsigned int)s.length(); }
+    bool isEmpty() const { return s.empty(); }
+    bool reserve(unsigned int size) { s.reserve(size); return true; }
+
+    bool concat(const String& str) { s += str.s; return true; }
+    bool concat(const char* cstr) { if (cstr) s += cstr; return true; }
+    bool concat(const char* cstr, unsigned int length) { if (cstr) s.append(cstr, length); return true; }
+    bool concat(char c) { s += c; return true; }
+    template <typename T> bool concat(T value) { return concat(String(value)); }
+
+    String& operator+=(const String& rhs) { concat(rhs); return *this; }
+    String& operator+=(const char* cstr) { concat(cstr); return *this; }
+    String& operator+=(char c) { concat(c); return *this; }
+    template <typename T> String& operator+=(T value) { concat(String(value)); return *this; }
+
+    friend StringSumHelper operator+(const String& lhs, const String& rhs);
+    friend StringSumHelper operator+(const String& lhs, const char* rhs);
+    friend StringSumHelper operator+(const char* lhs, const String& rhs);
+    friend StringSumHelper operator+(const String& lhs, char rhs);
+
+    bool equals(const String& rhs) const { return s == rhs.s; }
+    bool equals(const char* cstr) const { return s == (cstr ? cstr : ""); }
+    bool equalsIgnoreCase(const String& rhs) const;
+    bool operator==(const String& rhs) const { return equals(rhs); }
+    bool operator==(const char* cstr) const { return equals(cstr); }
+    bool operator!=(const String& rhs) const { return !equals(rhs); }
+    bool operator!=(const char* cstr) const { return !equals(cstr); }
+    bool operator<(const String& rhs) const { return s < rhs.s; }
+    bool startsWith(const String& prefix) const { return s.compare(0, prefix.s.size(), prefix.s) == 0; }
+    bool endsWith(const String& suffix) const;
+
+    char charAt(unsigned int index) const { return index < s.size() ? s[index] : 0; }
+    char operator[](unsigned int index) const { return charAt(index); }
+    char& operator[](unsigned int index) { return s[index]; }
+
+    int indexOf(char c, unsigned int fromIndex = 0) const;
+    int indexOf(const String& str, unsigned int fromIndex = 0) const;
+    int lastIndexOf(char c) const;
+    String substring(unsigned int beginIndex) const { return substring(beginIndex, length()); }
+    String substring(unsigned int beginIndex, unsigned int endIndex) const;
+
+    void replace(const String& find, const String& replace);
+    void remove(unsigned int index, unsigned int count = (unsigned int)-1);
+    void toLowerCase();
+    void toUpperCase();
+    void trim();
+
+    long toInt() const { return strtol(s.c_str(), NULL, 10); }
+    float toFloat() const { return strtof(s.c_str(), NULL); }
+    double toDouble() const { return strtod(s.c_str(), NULL); }
+
+    const std::string& str() const { return s; }
+
+private:
+    std::string s;
+};
+
+class StringSumHelper : public String
+{
+public:
+    StringSumHelper(const String& str) : String(str) {}
+    StringSumHelper(const char* cstr) : String(cstr) {}
+};
+
+#endif // NERDMINER_HOST
+
+#endif // HOST_WSTRING_H_
@@ -0,0 +1,267 @@
+#ifdef NERDMINER_HOST
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+WiFiClass WiFi;
+
+//////////////////////////// IPAddress ///////////////////////////////
+
+bool IPAddress::fromString(const char* address)
+{
+    struct in_addr addr;
+    if (inet_pton(AF_INET, address, &addr) != 1)
+        return false;
+    _address = addr.s_addr;
+    return true;
+}
+
+String IPAddress::toString() const
+{
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+    return String(buf);
+}
+
+int WiFiClass::hostByName(const char* host, IPAddress& result)
+{
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* res = NULL;
+    if (getaddrinfo(host, NULL, &hints, &res) != 0 || res == NULL)
+        return 0;
+    result = IPAddress(((struct sockaddr_in*)res->ai_addr)->sin_addr.s_addr);
+    freeaddrinfo(res);
+    return 1;
+}
+
+IPAddress WiFiClass::localIP()
+{
+    return IPAddress(127, 0, 0, 1);
+}
+
+//////////////////////////// WiFiClient ///////////////////////////////
+
+int WiFiClient::connect(IPAddress ip, uint16_t port)
+{
+    stop();
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+        return 0;
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = (uint32_t)ip;
+
+    //Non blocking connect so an unreachable pool times out like on the device
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    int res = ::connect(fd, (struct sockaddr*)&addr, sizeof(addr));
+    if (res < 0 && errno == EINPROGRESS)
+    {
+        struct pollfd pfd = { fd, POLLOUT, 0 };
+        int err = 0;
+        socklen_t len = sizeof(err);
+        if (poll(&pfd, 1, 3000) == 1 && getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) == 0 && err == 0)
+            res = 0;
+    }
+    if (res < 0)
+    {
+        close(fd);
+        return 0;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) & ~O_NONBLOCK);
+    _fd = fd;
+    return 1;
+}
+
+int WiFiClient::connect(const char* host, uint16_t port)
+{
+    IPAddress ip;
+    if (!WiFi.hostByName(host, ip))
+        return 0;
+    return connect(ip, port);
+}
+
+void WiFiClient::stop()
+{
+    if (_fd >= 0)
+        close(_fd);
+    _fd = -1;
+    _rx.clear();
+}
+
+int WiFiClient::setNoDelay(bool nodelay)
+{
+    if (_fd < 0)
+        return -1;
+    int flag = nodelay ? 1 : 0;
+    return setsockopt(_fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+}
+
+//Pull whatever is pending on the socket into _rx, waits up to timeout_ms for the first byte
+//Returns -1 when the peer closed the connection
+int WiFiClient::fill(int timeout_ms)
+{
+    if (_fd < 0)
+        return -1;
+    struct pollfd pfd = { _fd, POLLIN, 0 };
+    int ready = poll(&pfd, 1, timeout_ms);
+    if (ready <= 0)
+        return 0;
+    char buf[2048];
+    ssize_t n = recv(_fd, buf, sizeof(buf), MSG_DONTWAIT);
+    if (n > 0)
+    {
+        _rx.append(buf, n);
+        return (int)n;
+    }
+    if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+    {
+        close(_fd);
+        _fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+bool WiFiClient::connected()
+{
+    if (!_rx.empty())
+        return true;
+    if (_fd < 0)
+        return false;
+    fill(0);
+    return _fd >= 0 || !_rx.empty();
+}
+
+int WiFiClient::available()
+{
+    if (_fd >= 0)
+        fill(0);
+    return (int)_rx.size();
+}
+
+int WiFiClient::read()
+{
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+int WiFiClient::read(uint8_t* buf, size_t size)
+{
+    if (_rx.empty() && fill(0) <= 0 && _rx.empty())
+        return -1;
+    size_t n = size < _rx.size() ? size : _rx.size();
+    memcpy(buf, _rx.data(), n);
+    _rx.erase(0, n);
+    return (int)n;
+}
+
+int WiFiClient::peek()
+{
+    if (_rx.empty())
+        fill(0);
+    return _rx.empty() ? -1 : (uint8_t)_rx[0];
+}
+
+String WiFiClient::readStringUntil(char terminator)
+{
+    unsigned long start = millis();
+    size_t pos;
+    while ((pos = _rx.find(terminator)) == std::string::npos)
+    {
+        long left = (long)_timeout_ms - (long)(millis() - start);
+        if (left <= 0 || fill((int)left) < 0)
+        {
+            //Timeout or closed: return what we have, like Stream::readStringUntil
+            String line(_rx);
+            _rx.clear();
+            return line;
+        }
+    }
+    String line(_rx.substr(0, pos));
+    _rx.erase(0, pos + 1);
+    return line;
+}
+
+size_t WiFiClient::write(const uint8_t* buf, size_t size)
+{
+    if (_fd < 0)
+        return 0;
+    size_t sent = 0;
+    while (sent < size)
+    {
+        ssize_t n = send(_fd, buf + sent, size - sent, MSG_NOSIGNAL);
+        if (n <= 0)
+        {
+            if (n < 0 && errno == EINTR)
+                continue;
+            stop();
+            break;
+        }
+        sent += n;
+    }
+    return sent;
+}
+
+//////////////////////////// WiFiServer ///////////////////////////////
+
+void WiFiServer::begin()
+{
+    end();
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+        return;
+    int flag = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &flag, sizeof(flag));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(_port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 64) < 0)
+    {
+        close(fd);
+        return;
+    }
+    //Accept never blocks, like the lwIP server
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    _fd = fd;
+}
+
+void WiFiServer::end()
+{
+    if (_fd >= 0)
+        close(_fd);
+    _fd = -1;
+}
+
+WiFiClient WiFiServer::available()
+{
+    if (_fd < 0)
+        return WiFiClient();
+    int fd = accept(_fd, NULL, NULL);
+    if (fd < 0)
+        return WiFiClient();
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) & ~O_NONBLOCK);
+    WiFiClient client(fd);
+    client.setNoDelay(_nodelay);
+    return client;
+}
+
+#endif // NERDMINER_HOST
@@ -0,0 +1,112 @@
+/************************************************************************************
+*   WiFi stand-in for the native (host) build: the network is always "connected"
+*   and WiFiClient is a plain POSIX TCP socket.
+*************************************************************************************/
+#ifndef HOST_WIFI_H_
+#define HOST_WIFI_H_
+
+#ifdef NERDMINER_HOST
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <string>
+#include "WString.h"
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+class IPAddress
+{
+public:
+    IPAddress() : _address(0) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : _address((uint32_t)a | ((uint32_t)b << 8) | ((uint32_t)c << 16) | ((uint32_t)d << 24)) {}
+    IPAddress(uint32_t address) : _address(address) {}
+
+    operator uint32_t() const { return _address; }
+    bool operator==(const IPAddress& rhs) const { return _address == rhs._address; }
+    bool operator!=(const IPAddress& rhs) const { return _address != rhs._address; }
+    uint8_t operator[](int index) const { return (uint8_t)(_address >> (index * 8)); }
+
+    bool fromString(const char* address);
+    String toString() const;
+
+private:
+    uint32_t _address;  //network byte order, like lwIP
+};
+
+class WiFiClient
+{
+public:
+    WiFiClient() {}
+    explicit WiFiClient(int fd) : _fd(fd) {}
+
+    int connect(IPAddress ip, uint16_t port);
+    int connect(const char* host, uint16_t port);
+    bool connected();
+    void stop();
+
+    int available();
+    int read();
+    int read(uint8_t* buf, size_t size);
+    int peek();
+    String readStringUntil(char terminator);
+    void setTimeout(uint32_t seconds) { _timeout_ms = seconds * 1000; }
+
+    size_t write(const uint8_t* buf, size_t size);
+    size_t print(const char* str) { return write((const uint8_t*)str, strlen(str)); }
+    size_t print(const String& str) { return write((const uint8_t*)str.c_str(), str.length()); }
+    size_t println(const char* str) { return print(str) + print("\r\n"); }
+    size_t println(const String& str) { return print(str) + print("\r\n"); }
+
+    int setNoDelay(bool nodelay);
+    int fd() const { return _fd; }
+    operator bool() { return connected(); }
+
+private:
+    int fill(int timeout_ms);
+
+    int _fd = -1;
+    std::string _rx;
+    uint32_t _timeout_ms = 1000;
+};
+
+class WiFiServer
+{
+public:
+    WiFiServer(uint16_t port) : _port(port) {}
+
+    void begin();
+    void end();
+    WiFiClient available();     //Next pending connection, not connected client if none
+    void setNoDelay(bool nodelay) { _nodelay = nodelay; }
+    operator bool() { return _fd >= 0; }
+
+private:
+    uint16_t _port;
+    int _fd = -1;
+    bool _nodelay = false;
+};
+
+class WiFiClass
+{
+public:
+    wl_status_t status() { return WL_CONNECTED; }
+    bool reconnect() { return true; }
+    bool isConnected() { return true; }
+    int hostByName(const char* host, IPAddress& result);
+    IPAddress localIP();
+    int8_t RSSI() { return 0; }
+};
+
+extern WiFiClass WiFi;
+
+#endif // NERDMINER_HOST
+
+#endif // HOST_WIFI_H_
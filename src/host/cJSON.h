@@ -0,0 +1,6 @@
+#ifndef HOST_CJSON_H_
+#define HOST_CJSON_H_
+
+//stratum.h includes cJSON.h from ESP-IDF but nothing uses it
+
+#endif // HOST_CJSON_H_
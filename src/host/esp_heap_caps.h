@@ -0,0 +1,38 @@
+#ifndef HOST_ESP_HEAP_CAPS_H_
+#define HOST_ESP_HEAP_CAPS_H_
+
+#ifdef NERDMINER_HOST
+
+#include <stddef.h>
+#include <stdint.h>
+#include <malloc.h>
+
+#define MALLOC_CAP_DMA          (1 << 3)
+#define MALLOC_CAP_8BIT         (1 << 2)
+#define MALLOC_CAP_SPIRAM       (1 << 10)
+#define MALLOC_CAP_INTERNAL     (1 << 11)
+
+/* The malloc arena is the internal heap, there is no DMA nor PSRAM heap */
+static inline size_t heap_caps_get_total_size(uint32_t caps)
+{
+    return (caps & (MALLOC_CAP_DMA | MALLOC_CAP_SPIRAM)) ? 0 : mallinfo2().arena;
+}
+
+static inline size_t heap_caps_get_free_size(uint32_t caps)
+{
+    return (caps & (MALLOC_CAP_DMA | MALLOC_CAP_SPIRAM)) ? 0 : mallinfo2().fordblks;
+}
+
+static inline size_t heap_caps_get_minimum_free_size(uint32_t caps)
+{
+    return heap_caps_get_free_size(caps);
+}
+
+static inline size_t heap_caps_get_largest_free_block(uint32_t caps)
+{
+    return heap_caps_get_free_size(caps);
+}
+
+#endif // NERDMINER_HOST
+
+#endif // HOST_ESP_HEAP_CAPS_H_
@@ -0,0 +1,8 @@
+#ifndef HOST_ESP_LOG_H_
+#define HOST_ESP_LOG_H_
+
+#ifdef NERDMINER_HOST
+#include <stdio.h>
+#endif
+
+#endif // HOST_ESP_LOG_H_
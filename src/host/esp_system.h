@@ -0,0 +1,30 @@
+#ifndef HOST_ESP_SYSTEM_H_
+#define HOST_ESP_SYSTEM_H_
+
+#ifdef NERDMINER_HOST
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static inline void esp_fill_random(void* buf, size_t len)
+{
+    FILE* f = fopen("/dev/urandom", "rb");
+    size_t n = f ? fread(buf, 1, len, f) : 0;
+    if (f)
+        fclose(f);
+    for (; n < len; ++n)
+        ((uint8_t*)buf)[n] = (uint8_t)rand();
+}
+
+static inline uint32_t esp_random(void)
+{
+    uint32_t v;
+    esp_fill_random(&v, sizeof(v));
+    return v;
+}
+
+#endif // NERDMINER_HOST
+
+#endif // HOST_ESP_SYSTEM_H_
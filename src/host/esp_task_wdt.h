@@ -0,0 +1,17 @@
+#ifndef HOST_ESP_TASK_WDT_H_
+#define HOST_ESP_TASK_WDT_H_
+
+#ifdef NERDMINER_HOST
+
+#include "esp_err.h"
+#include "freertos/task.h"
+
+//No task watchdog on the host
+static inline esp_err_t esp_task_wdt_init(uint32_t timeout_s, bool panic) { (void)timeout_s; (void)panic; return ESP_OK; }
+static inline esp_err_t esp_task_wdt_add(TaskHandle_t handle) { (void)handle; return ESP_OK; }
+static inline esp_err_t esp_task_wdt_delete(TaskHandle_t handle) { (void)handle; return ESP_OK; }
+static inline esp_err_t esp_task_wdt_reset(void) { return ESP_OK; }
+
+#endif // NERDMINER_HOST
+
+#endif // HOST_ESP_TASK_WDT_H_
@@ -0,0 +1,25 @@
+#ifndef HOST_ESP_VFS_EVENTFD_H_
+#define HOST_ESP_VFS_EVENTFD_H_
+
+#ifdef NERDMINER_HOST
+
+#include <stddef.h>
+#include <sys/eventfd.h>
+#include "esp_err.h"
+
+typedef struct {
+    size_t max_fds;
+} esp_vfs_eventfd_config_t;
+
+#define ESP_VFS_EVENTD_CONFIG_DEFAULT() { 5 }
+
+/* Linux has eventfd built in, nothing to register */
+static inline esp_err_t esp_vfs_eventfd_register(const esp_vfs_eventfd_config_t* config)
+{
+    (void)config;
+    return ESP_OK;
+}
+
+#endif // NERDMINER_HOST
+
+#endif // HOST_ESP_VFS_EVENTFD_H_
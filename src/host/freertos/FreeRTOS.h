@@ -0,0 +1,30 @@
+/************************************************************************************
+*   FreeRTOS stand-in for the native (host) build, tasks are pthreads.
+*************************************************************************************/
+#ifndef HOST_FREERTOS_H_
+#define HOST_FREERTOS_H_
+
+#ifdef NERDMINER_HOST
+
+#include <stdint.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE     0
+#define pdTRUE      1
+#define pdPASS      pdTRUE
+#define pdFAIL      pdFALSE
+
+//One tick per millisecond, vTaskDelay(x / portTICK_PERIOD_MS) sleeps x ms
+#define portTICK_PERIOD_MS      1
+#define portMAX_DELAY           0xFFFFFFFFu
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(ms))
+
+//uxTaskGetSystemState() fills the thread cpu times
+#define configGENERATE_RUN_TIME_STATS   1
+
+#endif // NERDMINER_HOST
+
+#endif // HOST_FREERTOS_H_
@@ -0,0 +1,66 @@
+/************************************************************************************
+*   Display API for the native (host) build: runMonitor drives it exactly like a
+*   device screen, drawCurrentScreen prints a one line summary every second.
+*************************************************************************************/
+#ifdef NERDMINER_HOST
+
+#include <Arduino.h>
+#include "mining.h"
+#include "monitor.h"
+#include "logger.h"
+#include "utils.h"
+#include "nonceCoverage.h"
+#include "hashrateStats.h"
+#include "drivers/displays/display.h"
+
+extern uint64_t upTime;
+extern uint32_t pool_failovers;
+extern uint32_t pool_downtime_max_ms;
+extern uint32_t block_submit_latency_last_us;
+extern uint32_t block_submit_latency_max_us;
+
+DisplayDriver *currentDisplayDriver = NULL;
+bool isScreensaverActive = false;
+
+void initDisplay() {}
+void alternateScreenState() {}
+void alternateScreenRotation() {}
+void switchToNextScreen() {}
+void switchToPreviousScreen() {}
+void resetToFirstScreen() {}
+void drawLoadingScreen() { Serial.println("Initializing..."); }
+void drawSetupScreen() {}
+void animateCurrentScreen(unsigned long frame) { (void)frame; }
+void doLedStuff(unsigned long frame) { (void)frame; }
+void updateActivityTime() {}
+void checkScreensaver() {}
+void wakeFromScreensaver() {}
+bool getScreensaverActive() { return false; }
+
+void drawCurrentScreen(unsigned long mElapsed)
+{
+  mining_counters counters = mining_counters_get();
+  char best_diff_string[16] = {0};
+  suffix_string(counters.best_diff, best_diff_string, 16, 0);
+
+  const hashrate_stats& stats = hashrate_stats_get();
+  LOG_I(">>> %.2f KH/s (1m %.2f | 15m %.2f | 1h %.2f | 24h %.2f) | templates %u | 32bit shares %u | valids %u | best diff %s | %u MH total | up %llus\n",
+        stats.current, stats.average[HASHRATE_1M], stats.average[HASHRATE_15M], stats.average[HASHRATE_1H], stats.average[HASHRATE_24H], counters.templates, counters.shares, counters.valids, best_diff_string, counters.Mhashes, (unsigned long long)upTime);
+  if (counters.pool_incidents)
+    LOG_I(">>> pool incidents %u | failovers %u | downtime %llums total, %ums max\n",
+          counters.pool_incidents, pool_failovers, (unsigned long long)counters.pool_downtime_ms, pool_downtime_max_ms);
+  if (block_submit_latency_max_us)
+    LOG_I(">>> block submit latency %uus last, %uus max\n", block_submit_latency_last_us, block_submit_latency_max_us);
+  if (logger_dropped())
+    LOG_I(">>> log messages dropped %u\n", logger_dropped());
+#ifdef NONCE_COVERAGE
+  if (nonce_coverage_total.jobs)
+  {
+    char coverage[48];
+    nonce_coverage_summary(coverage, sizeof(coverage));
+    LOG_I(">>> nonces searched / overlap / abandoned %s over %u jobs\n", coverage, nonce_coverage_total.jobs);
+  }
+#endif
+}
+
+#endif // NERDMINER_HOST
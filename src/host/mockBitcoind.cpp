@@ -0,0 +1,548 @@
+#ifdef NERDMINER_HOST
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <esp_system.h>
+#include <stdio.h>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+#include "mbedtls/sha256.h"
+#include "gbt.h"
+#include "utils.h"
+#include "mockBitcoind.h"
+
+#define MOCK_RPC_BODY_MAX   (4 * 1024 * 1024)
+
+typedef struct {
+    uint16_t port;
+    String rpc_auth;            //user:password, empty accepts anyone
+    uint32_t bits;
+    uint32_t txs;               //Mempool size kept after every block
+    uint32_t tx_size;
+    uint32_t mempool_every_ms;  //New transaction (and long poll answer), 0 never
+    uint32_t block_every_ms;    //Block found by somebody else, 0 never
+    uint32_t stats_every_ms;
+} mock_bitcoind_config;
+
+struct MockTx
+{
+    std::vector<uint8_t> data;
+    uint8_t txid[32];
+    uint8_t wtxid[32];
+    uint64_t fee;
+};
+
+struct MockRpcSession
+{
+    WiFiClient client;
+    std::string rx;
+    bool long_poll;             //Waiting for the template to change
+    String long_poll_id;        //JSON-RPC id of the waiting request
+};
+
+typedef struct {
+    uint32_t templates;
+    uint32_t long_polls;
+    uint32_t accepted;
+    uint32_t rejected;
+    uint32_t stale;
+    uint32_t foreign_blocks;
+    uint32_t txs_mined;
+    uint32_t txs_left_out;      //Template transactions not in the accepted blocks
+    String last_reject;
+} mock_bitcoind_stats;
+
+static mock_bitcoind_config s_config;
+static mock_bitcoind_stats s_stats;
+static uint8_t s_tip[32];               //Header byte order
+static uint32_t s_height = 100;         //Of the tip
+static uint32_t s_template_sequence = 0;
+static std::vector<MockTx> s_mempool;
+
+static void MockSha256d(uint8_t out[32], const uint8_t* data, size_t len)
+{
+    mbedtls_sha256_ret(data, len, out, 0);
+    mbedtls_sha256_ret(out, 32, out, 0);
+}
+
+static String MockHex(const uint8_t* data, size_t len, bool reversed)
+{
+    String text;
+    char byte[3];
+    for (size_t i = 0; i < len; ++i)
+    {
+        snprintf(byte, sizeof(byte), "%02x", data[reversed ? len - 1 - i : i]);
+        text += byte;
+    }
+    return text;
+}
+
+static uint64_t MockSubsidy(uint32_t height)
+{
+    uint32_t halvings = height / 150;   //Regtest interval
+    return halvings >= 64 ? 0 : (5000000000ull >> halvings);
+}
+
+//Random transaction, every other one with a witness (its wtxid differs)
+static void MockAddTx(void)
+{
+    MockTx tx;
+    tx.data.resize(s_config.tx_size);
+    esp_fill_random(tx.data.data(), tx.data.size());
+    MockSha256d(tx.txid, tx.data.data(), tx.data.size());
+    memcpy(tx.wtxid, tx.txid, 32);
+    if (s_mempool.size() & 1)
+        tx.wtxid[0] ^= 0x5a;
+    tx.fee = 1000 + random(100000);
+    s_mempool.push_back(tx);
+}
+
+static String MockLongPollId(void)
+{
+    return MockHex(s_tip, 32, true) + String(s_template_sequence);
+}
+
+static void MockNewTip(const uint8_t hash[32])
+{
+    memcpy(s_tip, hash, 32);
+    s_height++;
+    s_template_sequence++;
+    while (s_mempool.size() < s_config.txs)
+        MockAddTx();
+}
+
+static void MockReply(WiFiClient& client, int status, const String& id, const String& result, const String& error)
+{
+    String body = "{\"result\":" + result + ",\"error\":" + error + ",\"id\":" + (id.length() > 0 ? id : String("null")) + "}\n";
+    String header = "HTTP/1.1 " + String(status) + (status == 200 ? " OK" : " Error") + "\r\nContent-Type: application/json\r\nContent-Length: " +
+                    String((unsigned long)body.length()) + "\r\n\r\n";
+    client.print(header + body);
+}
+
+static void MockReplyError(WiFiClient& client, const String& id, int code, const char* message)
+{
+    MockReply(client, 500, id, "null", "{\"code\":" + String(code) + ",\"message\":\"" + message + "\"}");
+}
+
+static void MockTemplate(WiFiClient& client, const String& id)
+{
+    uint64_t value = MockSubsidy(s_height + 1);
+    String txs;
+    for (size_t i = 0; i < s_mempool.size(); ++i)
+    {
+        const MockTx& tx = s_mempool[i];
+        value += tx.fee;
+        if (i > 0)
+            txs += ",";
+        txs += "{\"data\":\"" + MockHex(tx.data.data(), tx.data.size(), false) + "\",\"txid\":\"" + MockHex(tx.txid, 32, true) +
+               "\",\"hash\":\"" + MockHex(tx.wtxid, 32, true) + "\",\"depends\":[],\"fee\":" + String((unsigned long)tx.fee) +
+               ",\"sigops\":4,\"weight\":" + String((unsigned long)tx.data.size() * 4) + "}";
+    }
+    char bits[9];
+    snprintf(bits, sizeof(bits), "%08x", s_config.bits);
+    String result = "{\"capabilities\":[\"proposal\"],\"version\":536870912,\"rules\":[\"csv\",\"!segwit\",\"taproot\"],\"vbavailable\":{},"
+                    "\"vbrequired\":0,\"previousblockhash\":\"" + MockHex(s_tip, 32, true) + "\",\"transactions\":[" + txs + "],"
+                    "\"coinbaseaux\":{},\"coinbasevalue\":" + String((unsigned long long)value) + ",\"longpollid\":\"" + MockLongPollId() + "\","
+                    "\"mintime\":" + String((unsigned long)(time(NULL) - 3600)) + ",\"mutable\":[\"time\",\"transactions\",\"prevblock\"],"
+                    "\"noncerange\":\"00000000ffffffff\",\"sigoplimit\":80000,\"sizelimit\":4000000,\"weightlimit\":4000000,"
+                    "\"curtime\":" + String((unsigned long)time(NULL)) + ",\"bits\":\"" + bits + "\",\"height\":" + String(s_height + 1) + "}";
+    s_stats.templates++;
+    MockReply(client, 200, id, result, "null");
+}
+
+//Block reader, false once past the end
+class MockBlockReader
+{
+public:
+    MockBlockReader(const std::vector<uint8_t>& data) : _data(data), _pos(0), _ok(true) {}
+    const uint8_t* bytes(size_t n) { if (_pos + n > _data.size()) { _ok = false; return NULL; } const uint8_t* p = _data.data() + _pos; _pos += n; return p; }
+    uint64_t le(int n) { const uint8_t* p = bytes(n); uint64_t v = 0; for (int i = 0; p && i < n; ++i) v |= (uint64_t)p[i] << (8 * i); return v; }
+    uint64_t varint() { uint8_t v = le(1); return v < 0xFD ? v : le(v == 0xFD ? 2 : (v == 0xFE ? 4 : 8)); }
+    size_t pos() const { return _pos; }
+    size_t left() const { return _data.size() - _pos; }
+    bool ok() const { return _ok; }
+private:
+    const std::vector<uint8_t>& _data;
+    size_t _pos;
+    bool _ok;
+};
+
+//Reject reason, NULL when the block is good
+static const char* MockCheckBlock(const std::vector<uint8_t>& block, uint8_t hash[32], uint32_t& txs_mined)
+{
+    if (block.size() < 80)
+        return "bad-blk-length";
+    const uint8_t* header = block.data();
+    MockSha256d(hash, header, 80);
+    if (memcmp(header + 4, s_tip, 32) != 0)
+        return "stale-prevblk";
+    uint32_t bits = header[72] | (header[73] << 8) | (header[74] << 16) | ((uint32_t)header[75] << 24);
+    if (bits != s_config.bits)
+        return "bad-diffbits";
+    uint8_t target[32];
+    target_from_nbits(bits, target);
+    if (!checkValid(hash, target))
+        return "high-hash";
+
+    //Coinbase, witness serialization
+    MockBlockReader r(block);
+    r.bytes(80);
+    uint64_t tx_count = r.varint();
+    size_t cb_start = r.pos();
+    r.le(4);
+    if (r.le(1) != 0 || r.le(1) != 1)
+        return "bad-cb-missing-witness";
+    size_t middle_start = r.pos();
+    if (r.varint() != 1)
+        return "bad-cb-missing";
+    const uint8_t* prevout = r.bytes(36);
+    uint64_t script_len = r.varint();
+    const uint8_t* script = r.bytes(script_len);
+    r.le(4);
+    if (!r.ok() || script_len < 2 || script_len > 100)
+        return "bad-cb-length";
+    for (int i = 0; i < 32; ++i)
+        if (prevout[i] != 0)
+            return "bad-cb-missing";
+
+    //BIP34: height first in the script
+    uint32_t height = 0;
+    if (script[0] >= 0x51 && script[0] <= 0x60)
+        height = script[0] - 0x50;
+    else if (script[0] >= 1 && script[0] <= 4 && script[0] < script_len)
+        for (int i = 0; i < script[0]; ++i)
+            height |= (uint32_t)script[1 + i] << (8 * i);
+    if (height != s_height + 1)
+        return "bad-cb-height";
+
+    uint64_t outputs = r.varint();
+    uint64_t value = 0;
+    const uint8_t* commitment = NULL;
+    for (uint64_t i = 0; i < outputs && r.ok(); ++i)
+    {
+        value += r.le(8);
+        uint64_t len = r.varint();
+        const uint8_t* out_script = r.bytes(len);
+        if (out_script && len >= 38 && memcmp(out_script, "\x6a\x24\xaa\x21\xa9\xed", 6) == 0)
+            commitment = out_script + 6;
+    }
+    size_t middle_end = r.pos();
+    if (r.varint() != 1 || r.varint() != 32)
+        return "bad-witness-nonce-size";
+    const uint8_t* reserved = r.bytes(32);
+    size_t locktime = r.pos();
+    r.le(4);
+    if (!r.ok())
+        return "bad-cb-length";
+
+    std::vector<uint8_t> stripped(block.begin() + cb_start, block.begin() + cb_start + 4);
+    stripped.insert(stripped.end(), block.begin() + middle_start, block.begin() + middle_end);
+    stripped.insert(stripped.end(), block.begin() + locktime, block.begin() + locktime + 4);
+    uint8_t cb_txid[32];
+    MockSha256d(cb_txid, stripped.data(), stripped.size());
+
+    //The rest: the first mempool transactions, in order
+    gbt_merkle txids, wtxids;
+    uint8_t zero[32] = { 0 };
+    gbt_merkle_init(txids, NULL);
+    gbt_merkle_add(txids, cb_txid);
+    gbt_merkle_init(wtxids, NULL);
+    gbt_merkle_add(wtxids, zero);
+    uint64_t fees = 0;
+    if (tx_count == 0 || tx_count - 1 > s_mempool.size())
+        return "bad-txns";
+    for (uint64_t i = 0; i + 1 < tx_count; ++i)
+    {
+        const MockTx& tx = s_mempool[i];
+        const uint8_t* data = r.bytes(tx.data.size());
+        if (data == NULL || memcmp(data, tx.data.data(), tx.data.size()) != 0)
+            return "bad-txns";
+        gbt_merkle_add(txids, tx.txid);
+        gbt_merkle_add(wtxids, tx.wtxid);
+        fees += tx.fee;
+    }
+    if (r.left() != 0)
+        return "bad-blk-length";
+
+    uint8_t root[32];
+    gbt_merkle_finish(txids, root);
+    if (memcmp(root, header + 36, 32) != 0)
+        return "bad-txnmrklroot";
+    uint8_t witness[64];
+    gbt_merkle_finish(wtxids, witness);
+    memcpy(witness + 32, reserved, 32);
+    MockSha256d(witness, witness, sizeof(witness));
+    if (commitment == NULL || memcmp(witness, commitment, 32) != 0)
+        return "bad-witness-merkle-match";
+    if (value > MockSubsidy(height) + fees)
+        return "bad-cb-amount";
+
+    txs_mined = tx_count - 1;
+    return NULL;
+}
+
+static void MockSubmitBlock(WiFiClient& client, const String& id, const std::string& body)
+{
+    //params: ["<block hex>"]
+    size_t start = body.find("\"params\"");
+    start = (start == std::string::npos) ? start : body.find('"', body.find('[', start));
+    size_t end = (start == std::string::npos) ? start : body.find('"', start + 1);
+    if (end == std::string::npos)
+    {
+        MockReplyError(client, id, -8, "Block decode failed");
+        return;
+    }
+    std::vector<uint8_t> block((end - start - 1) / 2);
+    const char* text = body.c_str() + start + 1;
+    for (size_t i = 0; i < block.size(); ++i)
+        block[i] = (hex(text[2 * i]) << 4) | hex(text[2 * i + 1]);
+
+    uint8_t hash[32];
+    uint32_t txs_mined = 0;
+    const char* reason = MockCheckBlock(block, hash, txs_mined);
+    if (reason != NULL)
+    {
+        if (strcmp(reason, "stale-prevblk") == 0)
+            s_stats.stale++;
+        else
+            s_stats.rejected++;
+        s_stats.last_reject = reason;
+        Serial.printf("[MOCKBITCOIND] Block %s rejected: %s\n", MockHex(hash, 32, true).c_str(), reason);
+        MockReply(client, 200, id, String("\"") + reason + "\"", "null");
+        return;
+    }
+
+    s_stats.accepted++;
+    s_stats.txs_mined += txs_mined;
+    s_stats.txs_left_out += s_mempool.size() - txs_mined;
+    Serial.printf("[MOCKBITCOIND] Block %u accepted: %s, %u of %u transactions\n", s_height + 1, MockHex(hash, 32, true).c_str(),
+                  txs_mined, (uint32_t)s_mempool.size());
+    s_mempool.erase(s_mempool.begin(), s_mempool.begin() + txs_mined);
+    MockNewTip(hash);
+    MockReply(client, 200, id, "null", "null");
+}
+
+//Value of "key":"..." in a request body, empty if missing
+static String MockJsonString(const std::string& body, const char* key)
+{
+    std::string pattern = std::string("\"") + key + "\"";
+    size_t pos = body.find(pattern);
+    if (pos == std::string::npos)
+        return "";
+    pos = body.find('"', body.find(':', pos + pattern.size()));
+    size_t end = (pos == std::string::npos) ? pos : body.find('"', pos + 1);
+    if (end == std::string::npos || end - pos > 256)
+        return "";
+    return String(body.substr(pos + 1, end - pos - 1).c_str());
+}
+
+//Raw "id" value of a request, echoed in the reply
+static String MockJsonId(const std::string& body)
+{
+    size_t pos = body.find("\"id\"");
+    if (pos == std::string::npos)
+        return "";
+    pos = body.find(':', pos) + 1;
+    size_t end = body.find_first_of(",}", pos);
+    if (end == std::string::npos || end - pos > 64)
+        return "";
+    return String(body.substr(pos, end - pos).c_str());
+}
+
+//Complete requests of the session, false to drop it
+static bool MockHandleRequests(MockRpcSession& s)
+{
+    while (!s.long_poll)
+    {
+        size_t header_end = s.rx.find("\r\n\r\n");
+        if (header_end == std::string::npos)
+            return s.rx.size() < 8192;
+        std::string header = s.rx.substr(0, header_end);
+        std::string lower = header;
+        for (size_t i = 0; i < lower.size(); ++i)
+            lower[i] = tolower((unsigned char)lower[i]);
+        size_t length_pos = lower.find("content-length:");
+        if (length_pos == std::string::npos)
+            return false;
+        size_t length = strtoul(header.c_str() + length_pos + 15, NULL, 10);
+        if (length > MOCK_RPC_BODY_MAX)
+            return false;
+        if (s.rx.size() < header_end + 4 + length)
+            return true;
+        std::string body = s.rx.substr(header_end + 4, length);
+        s.rx.erase(0, header_end + 4 + length);
+
+        if (s_config.rpc_auth.length() > 0 && header.find("Authorization: Basic " + std::string(gbt_base64(s_config.rpc_auth).c_str())) == std::string::npos)
+        {
+            s.client.print("HTTP/1.1 401 Unauthorized\r\nWWW-Authenticate: Basic realm=\"jsonrpc\"\r\nContent-Length: 0\r\n\r\n");
+            continue;
+        }
+
+        String id = MockJsonId(body);
+        String method = MockJsonString(body, "method");
+        if (method == "getblocktemplate")
+        {
+            String longpollid = MockJsonString(body, "longpollid");
+            if (longpollid.length() > 0 && longpollid == MockLongPollId())
+            {
+                s.long_poll = true;
+                s.long_poll_id = id;
+                s_stats.long_polls++;
+            } else
+                MockTemplate(s.client, id);
+        } else if (method == "submitblock")
+            MockSubmitBlock(s.client, id, body);
+        else
+            MockReplyError(s.client, id, -32601, "Method not found");
+    }
+    return true;
+}
+
+static void MockPrintStats(void)
+{
+    Serial.printf("[MOCKBITCOIND] height %u | templates %u, long polls %u | blocks accepted %u, stale %u, rejected %u%s%s | foreign blocks %u\n",
+                  s_height, s_stats.templates, s_stats.long_polls, s_stats.accepted, s_stats.stale, s_stats.rejected,
+                  s_stats.last_reject.length() > 0 ? ", last: " : "", s_stats.last_reject.c_str(), s_stats.foreign_blocks);
+    Serial.printf("[MOCKBITCOIND] transactions mined %u, left out %u | mempool %u\n", s_stats.txs_mined, s_stats.txs_left_out,
+                  (uint32_t)s_mempool.size());
+}
+
+int mock_bitcoind_main(int argc, char** argv)
+{
+    s_config.port = 18443;
+    s_config.rpc_auth = "";
+    s_config.bits = 0x1e00ffff;
+    s_config.txs = 20;
+    s_config.tx_size = 250;
+    s_config.mempool_every_ms = 0;
+    s_config.block_every_ms = 0;
+    s_config.stats_every_ms = 10000;
+
+    for (int i = 0; i + 1 < argc; i += 2)
+    {
+        const char* arg = argv[i];
+        const char* value = argv[i + 1];
+        if (strcmp(arg, "--port") == 0)
+            s_config.port = (uint16_t)atoi(value);
+        else if (strcmp(arg, "--rpc-auth") == 0)
+            s_config.rpc_auth = value;
+        else if (strcmp(arg, "--bits") == 0)
+            s_config.bits = strtoul(value, NULL, 16);
+        else if (strcmp(arg, "--txs") == 0)
+            s_config.txs = (uint32_t)atoi(value);
+        else if (strcmp(arg, "--tx-size") == 0)
+            s_config.tx_size = (uint32_t)atoi(value);
+        else if (strcmp(arg, "--mempool-every") == 0)
+            s_config.mempool_every_ms = (uint32_t)atoi(value);
+        else if (strcmp(arg, "--block-every") == 0)
+            s_config.block_every_ms = (uint32_t)atoi(value);
+        else if (strcmp(arg, "--stats-every") == 0)
+            s_config.stats_every_ms = (uint32_t)(atof(value) * 1000);
+        else
+        {
+            Serial.printf("[MOCKBITCOIND] Unknown option %s\n", arg);
+            return 1;
+        }
+    }
+    if (argc & 1)
+    {
+        Serial.printf("[MOCKBITCOIND] Unknown option %s\n", argv[argc - 1]);
+        return 1;
+    }
+    if (s_config.tx_size < 60)
+        s_config.tx_size = 60;
+
+    WiFiServer server(s_config.port);
+    server.begin();
+    if (!server)
+    {
+        Serial.printf("[MOCKBITCOIND] Unable to listen on port %d\n", s_config.port);
+        return 1;
+    }
+    esp_fill_random(s_tip, sizeof(s_tip));
+    while (s_mempool.size() < s_config.txs)
+        MockAddTx();
+    Serial.printf("[MOCKBITCOIND] Listening on port %d: bits %08x, %u transactions of %u bytes, %s\n", s_config.port, s_config.bits,
+                  s_config.txs, s_config.tx_size, s_config.rpc_auth.length() > 0 ? "RPC user and password required" : "no RPC authentication");
+
+    std::list<std::shared_ptr<MockRpcSession>> sessions;
+    uint32_t time_now = millis();
+    uint32_t mempool_time = time_now;
+    uint32_t block_time = time_now;
+    uint32_t stats_time = time_now;
+    uint32_t sequence = s_template_sequence;
+
+    while (true)
+    {
+        time_now = millis();
+
+        WiFiClient incoming = server.available();
+        while (incoming)
+        {
+            std::shared_ptr<MockRpcSession> s = std::make_shared<MockRpcSession>();
+            s->client = incoming;
+            s->client.setNoDelay(true);
+            s->long_poll = false;
+            sessions.push_back(s);
+            incoming = server.available();
+        }
+
+        if (s_config.mempool_every_ms > 0 && time_now - mempool_time >= s_config.mempool_every_ms)
+        {
+            mempool_time = time_now;
+            MockAddTx();
+            s_template_sequence++;
+        }
+        if (s_config.block_every_ms > 0 && time_now - block_time >= s_config.block_every_ms)
+        {
+            //Somebody else's block, with the first half of the mempool
+            block_time = time_now;
+            uint8_t hash[32];
+            esp_fill_random(hash, sizeof(hash));
+            s_mempool.erase(s_mempool.begin(), s_mempool.begin() + s_mempool.size() / 2);
+            s_stats.foreign_blocks++;
+            MockNewTip(hash);
+            Serial.printf("[MOCKBITCOIND] Block %u found elsewhere\n", s_height);
+        }
+
+        //Template changed: answer the long polls
+        bool changed = sequence != s_template_sequence;
+        sequence = s_template_sequence;
+        for (auto it = sessions.begin(); it != sessions.end(); )
+        {
+            MockRpcSession& s = **it;
+            if (changed && s.long_poll)
+            {
+                s.long_poll = false;
+                MockTemplate(s.client, s.long_poll_id);
+            }
+            uint8_t data[4096];
+            while (s.client.connected() && s.client.available() > 0)
+            {
+                int n = s.client.read(data, sizeof(data));
+                if (n <= 0)
+                    break;
+                s.rx.append((const char*)data, n);
+            }
+            if (!s.client.connected() || !MockHandleRequests(s))
+            {
+                s.client.stop();
+                it = sessions.erase(it);
+            } else
+                ++it;
+        }
+
+        if (time_now - stats_time >= s_config.stats_every_ms)
+        {
+            stats_time = time_now;
+            MockPrintStats();
+        }
+
+        delay(1);
+    }
+    return 0;
+}
+
+#endif // NERDMINER_HOST
@@ -0,0 +1,26 @@
+/************************************************************************************
+*   Mock bitcoind JSON-RPC for end to end runs of the solo (getblocktemplate) mode,
+*   host build only.
+*
+*   Serves getblocktemplate with long polling and checks every submitblock like a
+*   node would: previous block, bits, proof of work, merkle root, BIP34 height,
+*   witness commitment, coinbase value and the transactions (a prefix of the
+*   template ones, in order). Accepted blocks move the tip and answer the long polls.
+*   The mempool is random transactions, big ones make the client truncate the
+*   block; --block-every has other miners find blocks, to get stale submits.
+*
+*     program --mock-bitcoind [--port 18443] [--rpc-auth user:password] [--bits hex] [--txs n]
+*             [--tx-size n] [--mempool-every ms] [--block-every ms] [--stats-every s]
+*
+*   Answers follow BIP22: null when accepted, else the reject reason.
+*************************************************************************************/
+#ifndef HOST_MOCK_BITCOIND_H_
+#define HOST_MOCK_BITCOIND_H_
+
+#ifdef NERDMINER_HOST
+
+int mock_bitcoind_main(int argc, char** argv);
+
+#endif // NERDMINER_HOST
+
+#endif // HOST_MOCK_BITCOIND_H_
@@ -0,0 +1,841 @@
+#ifdef NERDMINER_HOST
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <esp_system.h>
+#include <math.h>
+#include <stdio.h>
+#include <list>
+#include <map>
+#include <memory>
+#include <set>
+#include "stratum.h"
+#include "stratumV2.h"
+#include "crypto/secp256k1.h"
+#include "utils.h"
+#include "mockPool.h"
+
+#define MOCK_JOB_HISTORY    8
+
+typedef struct {
+    uint16_t port;
+    uint16_t sv2_port;          //0 no SV2 listener
+    uint8_t authority_secret[32];
+    uint32_t job_every_ms;
+    uint32_t clean_every;       //Every nth job has clean_jobs, 0 never
+    uint32_t branches;
+    double difficulty;
+    uint32_t diff_every_ms;     //Toggle between difficulty and difficulty * diff_factor, 0 never
+    double diff_factor;
+    uint32_t drop_every_ms;     //Close every miner connection, 0 never
+    int extranonce2_size;
+    uint32_t version_mask;
+    bool honor_suggest;
+    uint32_t stats_every_ms;
+} mock_pool_config;
+
+struct MockJob
+{
+    mining_job job;
+    uint32_t sequence;          //Jobs superseded by a later clean job are stale
+};
+
+struct MockSession
+{
+    WiFiClient client;
+    String extranonce1;
+    uint32_t version_mask;
+    double difficulty;
+    bool suggested;
+    bool subscribed;
+    bool authorized;
+    std::map<String, double> job_difficulty;    //Difficulty in force when the job was sent
+};
+
+struct MockSv2Job
+{
+    String job_id;              //Of the MockJob
+    double difficulty;
+};
+
+struct MockSv2Session
+{
+    WiFiClient client;
+    sv2_session s;
+    String extranonce1;
+    uint32_t channel_id;
+    double difficulty;
+    bool suggested;
+    bool setup;
+    bool open;
+    uint32_t next_job_id;
+    std::map<uint32_t, MockSv2Job> jobs;
+};
+
+typedef struct {
+    uint32_t accepted;
+    uint32_t late;              //Accepted, job replaced by a non clean one
+    uint32_t low_difficulty;
+    uint32_t stale;
+    uint32_t duplicate;
+    uint32_t unknown_job;
+    uint32_t bad_version;
+    double hashes;              //Expected hashes behind the accepted shares
+    uint32_t reconnects;
+    uint32_t reconnect_total_ms;
+    uint32_t reconnect_max_ms;
+} mock_pool_stats;
+
+static mock_pool_config s_config;
+static stratum_session s_session;    //Requests of the v1 miners are parsed here
+static mock_pool_stats s_stats;
+static std::list<MockJob> s_jobs;
+static uint32_t s_job_sequence = 0;
+static uint32_t s_clean_sequence = 0;   //Sequence of the last clean job
+static std::set<String> s_shares;       //Duplicate detection, cleared with the clean jobs
+static uint32_t s_next_extranonce1 = 1;
+static uint32_t s_next_channel_id = 1;
+static uint8_t s_sv2_static_key[32];
+static uint32_t s_drop_time = 0;
+static uint32_t s_drop_pending = 0;     //Miners dropped that didn't authorize again yet
+
+static String MockRandomHex(size_t bytes)
+{
+    String hex;
+    char byte[3];
+    for (size_t i = 0; i < bytes; ++i)
+    {
+        snprintf(byte, sizeof(byte), "%02x", (unsigned)random(256));
+        hex += byte;
+    }
+    return hex;
+}
+
+static const MockJob& MockNewJob(void)
+{
+    s_job_sequence++;
+    bool clean = s_config.clean_every > 0 && (s_job_sequence % s_config.clean_every) == 0;
+    if (s_jobs.empty())
+        clean = true;
+
+    MockJob mock;
+    mock.sequence = s_job_sequence;
+    mining_job& job = mock.job;
+    char text[16];
+    snprintf(text, sizeof(text), "%x", s_job_sequence);
+    job.job_id = text;
+    //A clean job is a new block: new previous hash
+    job.prev_block_hash = (clean || s_jobs.empty()) ? MockRandomHex(28) + "00000000" : s_jobs.back().job.prev_block_hash;
+    job.coinb1 = "01000000010000000000000000000000000000000000000000000000000000000000000000ffffffff2503";
+    job.coinb2 = "ffffffff0100f2052a010000001976a914" + MockRandomHex(20) + "88ac00000000";
+    for (uint32_t i = 0; i < s_config.branches; ++i)
+        job.merkle_branch.push_back(MockRandomHex(32));
+    job.version = "20000000";
+    job.nbits = "1703a30c";
+    snprintf(text, sizeof(text), "%08x", (uint32_t)time(NULL));
+    job.ntime = text;
+    job.clean_jobs = clean;
+
+    if (clean)
+    {
+        s_clean_sequence = mock.sequence;
+        s_shares.clear();
+    }
+    s_jobs.push_back(mock);
+    if (s_jobs.size() > MOCK_JOB_HISTORY)
+        s_jobs.pop_front();
+    return s_jobs.back();
+}
+
+static const MockJob* MockFindJob(const String& job_id)
+{
+    for (auto it = s_jobs.rbegin(); it != s_jobs.rend(); ++it)
+        if (it->job.job_id == job_id)
+            return &(*it);
+    return NULL;
+}
+
+static void MockSendJob(MockSession& s, const MockJob& mock)
+{
+    s.job_difficulty[mock.job.job_id] = s.difficulty;
+    if (s.job_difficulty.size() > MOCK_JOB_HISTORY * 2)
+        s.job_difficulty.erase(s.job_difficulty.begin());
+    tx_mining_notify(s.client, mock.job, mock.job.clean_jobs);
+}
+
+static void MockSubmit(MockSession& s, const String& line)
+{
+    mining_submit submit;
+    if (!parse_mining_submit(s_session, line, submit) || !s.authorized)
+    {
+        tx_error(s.client, parse_extract_id(s_session, line), 24, "Unauthorized worker");
+        return;
+    }
+
+    const MockJob* mock = MockFindJob(submit.job_id);
+    auto difficulty = s.job_difficulty.find(submit.job_id);
+    if (mock == NULL || difficulty == s.job_difficulty.end())
+    {
+        s_stats.unknown_job++;
+        tx_error(s.client, submit.id, 21, "Job not found");
+        return;
+    }
+    if (mock->sequence < s_clean_sequence)
+    {
+        s_stats.stale++;
+        tx_error(s.client, submit.id, 21, "Stale share");
+        return;
+    }
+    if ((submit.version_bits & ~s.version_mask) != 0)
+    {
+        s_stats.bad_version++;
+        tx_error(s.client, submit.id, 20, "Bad version bits");
+        return;
+    }
+    String key = s.extranonce1 + submit.job_id + submit.extranonce2 + submit.ntime + submit.nonce + String(submit.version_bits, HEX);
+    if (!s_shares.insert(key).second)
+    {
+        s_stats.duplicate++;
+        tx_error(s.client, submit.id, 22, "Duplicate share");
+        return;
+    }
+
+    uint8_t hash[32];
+    double share_difficulty = calculateShareDifficulty(s.extranonce1, s_config.extranonce2_size, mock->job, submit, s.version_mask, hash);
+    if (share_difficulty < difficulty->second)
+    {
+        s_stats.low_difficulty++;
+        Serial.printf("[MOCKPOOL] Low difficulty share %.6g < %.6g, job %s nonce %s\n", share_difficulty, difficulty->second,
+                      submit.job_id.c_str(), submit.nonce.c_str());
+        tx_error(s.client, submit.id, 23, "Low difficulty share");
+        return;
+    }
+    s_stats.accepted++;
+    if (mock != &s_jobs.back())
+        s_stats.late++;
+    s_stats.hashes += difficulty->second * 4294967296.0;
+    tx_result(s.client, submit.id, "true");
+}
+
+static void MockHandleLine(MockSession& s, String& line)
+{
+    unsigned long id = parse_extract_id(s_session, line);
+    switch (parse_mining_method(s_session, line))
+    {
+        case MINING_CONFIGURE:          {
+                                            uint32_t version_mask = 0;
+                                            if (s_config.version_mask == 0)
+                                            {
+                                                tx_error(s.client, id, 20, "Unknown method");
+                                                break;
+                                            }
+                                            if (parse_mining_configure_request(s_session, line, version_mask))
+                                                s.version_mask = version_mask & s_config.version_mask;
+                                            tx_mining_configure_result(s.client, id, s.version_mask);
+                                        }
+                                        break;
+        case MINING_SUBSCRIBE:          {
+                                            char extranonce1[9];
+                                            snprintf(extranonce1, sizeof(extranonce1), "%08x", s_next_extranonce1++);
+                                            s.extranonce1 = extranonce1;
+                                            s.subscribed = true;
+                                            tx_mining_subscribe_result(s.client, id, s.extranonce1, s_config.extranonce2_size);
+                                        }
+                                        break;
+        case MINING_AUTHORIZE:          if (!s.subscribed)
+                                        {
+                                            tx_error(s.client, id, 25, "Not subscribed");
+                                            break;
+                                        }
+                                        tx_result(s.client, id, "true");
+                                        if (!s.authorized && s_drop_pending > 0)
+                                        {
+                                            uint32_t reconnect_ms = millis() - s_drop_time;
+                                            s_drop_pending--;
+                                            s_stats.reconnects++;
+                                            s_stats.reconnect_total_ms += reconnect_ms;
+                                            if (reconnect_ms > s_stats.reconnect_max_ms)
+                                                s_stats.reconnect_max_ms = reconnect_ms;
+                                            Serial.printf("[MOCKPOOL] Miner back %ums after the disconnect\n", reconnect_ms);
+                                        }
+                                        s.authorized = true;
+                                        tx_mining_set_difficulty(s.client, s.difficulty);
+                                        if (!s_jobs.empty())
+                                            MockSendJob(s, s_jobs.back());
+                                        break;
+        case MINING_SUGGEST_DIFFICULTY: {
+                                            double difficulty;
+                                            if (s_config.honor_suggest && parse_mining_suggest_difficulty(s_session, line, difficulty) && difficulty > 0)
+                                            {
+                                                s.suggested = true;
+                                                if (difficulty != s.difficulty)
+                                                {
+                                                    s.difficulty = difficulty;
+                                                    if (s.authorized)
+                                                        tx_mining_set_difficulty(s.client, s.difficulty);
+                                                }
+                                            }
+                                            tx_result(s.client, id, "true");
+                                        }
+                                        break;
+        case MINING_EXTRANONCE_SUBSCRIBE:
+                                        tx_result(s.client, id, "true");
+                                        break;
+        case MINING_SUBMIT:             MockSubmit(s, line);
+                                        break;
+        default:                        if (id != 0)
+                                            tx_error(s.client, id, 20, "Unknown method");
+                                        break;
+    }
+}
+
+//////////////////////////// Stratum V2 ///////////////////////////////
+
+//Inverse of diff_from_target, little endian
+static void MockTargetFromDifficulty(double difficulty, uint8_t target[32])
+{
+    double value = ldexp(65535.0 / difficulty, 208);
+    for (int i = 31; i >= 0; --i)
+    {
+        double unit = ldexp(1.0, 8 * i);
+        double byte = floor(value / unit);
+        if (byte > 255)
+            byte = 255;
+        target[i] = (uint8_t)byte;
+        value -= byte * unit;
+    }
+}
+
+//Difficulty giving SUGGEST_SHARES_PER_MINUTE at the nominal hashrate of the channel
+static bool MockSv2Hashrate(MockSv2Session& s, float hashrate)
+{
+    if (!s_config.honor_suggest || hashrate <= 0)
+        return false;
+    s.suggested = true;
+    double difficulty = hashrate * 60.0 / (SUGGEST_SHARES_PER_MINUTE * 4294967296.0);
+    if (difficulty == s.difficulty)
+        return false;
+    s.difficulty = difficulty;
+    return true;
+}
+
+static String MockZeroExtranonce2(void)
+{
+    String extranonce2;
+    for (int i = 0; i < s_config.extranonce2_size; ++i)
+        extranonce2 += "00";
+    return extranonce2;
+}
+
+static void MockSv2SetTarget(MockSv2Session& s)
+{
+    uint8_t payload[36], target[32];
+    MockTargetFromDifficulty(s.difficulty, target);
+    Sv2Writer w(payload, sizeof(payload));
+    w.u32(s.channel_id);
+    w.u256(target);
+    sv2_send(s.client, s.s, SV2_CHANNEL_BIT, SV2_SET_TARGET, payload, w.length());
+}
+
+//The pool builds the coinbase (extranonce prefix + zero extranonce2) and sends the merkle root
+static void MockSv2SendJob(MockSv2Session& s, const MockJob& mock, bool new_block)
+{
+    mining_subscribe worker = init_mining_subscribe();
+    worker.extranonce1 = s.extranonce1;
+    worker.extranonce2 = MockZeroExtranonce2();
+    worker.extranonce2_size = s_config.extranonce2_size;
+    miner_data data = calculateMiningData(worker, mock.job);
+
+    Sv2Reader header(data.bytearray_blockheader, 80);
+    uint8_t prev_hash[32], merkle_root[32];
+    uint32_t version = header.u32();
+    header.u256(prev_hash);
+    header.u256(merkle_root);
+    uint32_t ntime = header.u32();
+    uint32_t nbits = header.u32();
+
+    uint32_t job_id = s.next_job_id++;
+    s.jobs[job_id] = { mock.job.job_id, s.difficulty };
+    if (s.jobs.size() > MOCK_JOB_HISTORY * 2)
+        s.jobs.erase(s.jobs.begin());
+
+    uint8_t payload[64];
+    Sv2Writer w(payload, sizeof(payload));
+    w.u32(s.channel_id);
+    w.u32(job_id);
+    if (new_block)
+        w.u8(0);                //Future job, SetNewPrevHash follows
+    else
+    {
+        w.u8(1);
+        w.u32(ntime);
+    }
+    w.u32(version);
+    w.b032(merkle_root, 32);
+    sv2_send(s.client, s.s, SV2_CHANNEL_BIT, SV2_NEW_MINING_JOB, payload, w.length());
+    if (!new_block)
+        return;
+
+    Sv2Writer prev(payload, sizeof(payload));
+    prev.u32(s.channel_id);
+    prev.u32(job_id);
+    prev.u256(prev_hash);
+    prev.u32(ntime);
+    prev.u32(nbits);
+    sv2_send(s.client, s.s, SV2_CHANNEL_BIT, SV2_SET_NEW_PREV_HASH, payload, prev.length());
+}
+
+static void MockSv2ShareError(MockSv2Session& s, uint32_t sequence, const char* error)
+{
+    uint8_t payload[64];
+    Sv2Writer w(payload, sizeof(payload));
+    w.u32(s.channel_id);
+    w.u32(sequence);
+    w.str(error);
+    sv2_send(s.client, s.s, SV2_CHANNEL_BIT, SV2_SUBMIT_SHARES_ERROR, payload, w.length());
+}
+
+static void MockSv2Submit(MockSv2Session& s, Sv2Reader& r)
+{
+    uint32_t channel_id = r.u32();
+    uint32_t sequence = r.u32();
+    uint32_t job_id = r.u32();
+    uint32_t nonce = r.u32();
+    uint32_t ntime = r.u32();
+    uint32_t version = r.u32();
+    if (!r.ok() || !s.open || channel_id != s.channel_id)
+    {
+        MockSv2ShareError(s, sequence, "invalid-channel-id");
+        return;
+    }
+
+    auto job = s.jobs.find(job_id);
+    const MockJob* mock = job != s.jobs.end() ? MockFindJob(job->second.job_id) : NULL;
+    if (mock == NULL)
+    {
+        s_stats.unknown_job++;
+        MockSv2ShareError(s, sequence, "invalid-job-id");
+        return;
+    }
+    if (mock->sequence < s_clean_sequence)
+    {
+        s_stats.stale++;
+        MockSv2ShareError(s, sequence, "stale-share");
+        return;
+    }
+    if (((version ^ strtoul(mock->job.version.c_str(), NULL, 16)) & ~s_config.version_mask) != 0)
+    {
+        s_stats.bad_version++;
+        MockSv2ShareError(s, sequence, "invalid-version");
+        return;
+    }
+
+    mining_submit submit;
+    char text[9];
+    submit.job_id = mock->job.job_id;
+    submit.extranonce2 = MockZeroExtranonce2();
+    snprintf(text, sizeof(text), "%08x", ntime);
+    submit.ntime = text;
+    snprintf(text, sizeof(text), "%08x", nonce);
+    submit.nonce = text;
+    submit.version_bits = version;
+    String key = s.extranonce1 + submit.job_id + submit.ntime + submit.nonce + String(version, HEX);
+    if (!s_shares.insert(key).second)
+    {
+        s_stats.duplicate++;
+        MockSv2ShareError(s, sequence, "duplicate-share");
+        return;
+    }
+
+    uint8_t hash[32];
+    double share_difficulty = calculateShareDifficulty(s.extranonce1, s_config.extranonce2_size, mock->job, submit,
+                                                       s_config.version_mask, hash);
+    if (share_difficulty < job->second.difficulty)
+    {
+        s_stats.low_difficulty++;
+        Serial.printf("[MOCKPOOL] Low difficulty share %.6g < %.6g, SV2 job %u nonce %08x\n", share_difficulty,
+                      job->second.difficulty, job_id, nonce);
+        MockSv2ShareError(s, sequence, "difficulty-too-low");
+        return;
+    }
+    s_stats.accepted++;
+    if (mock != &s_jobs.back())
+        s_stats.late++;
+    s_stats.hashes += job->second.difficulty * 4294967296.0;
+
+    //One acknowledgement per share, the batch is the single share
+    uint8_t payload[24];
+    uint64_t shares_sum = (uint64_t)job->second.difficulty;
+    Sv2Writer w(payload, sizeof(payload));
+    w.u32(s.channel_id);
+    w.u32(sequence);
+    w.u32(1);
+    w.u32((uint32_t)shares_sum);
+    w.u32((uint32_t)(shares_sum >> 32));
+    sv2_send(s.client, s.s, SV2_CHANNEL_BIT, SV2_SUBMIT_SHARES_SUCCESS, payload, w.length());
+}
+
+static void MockSv2HandleFrame(MockSv2Session& s, const uint8_t* data)
+{
+    Sv2Reader r(data, s.s.msg_length);
+    uint8_t payload[128];
+    Sv2Writer w(payload, sizeof(payload));
+    switch (s.s.msg_type)
+    {
+        case SV2_SETUP_CONNECTION:      {
+                                            uint8_t protocol = r.u8();
+                                            uint16_t min_version = r.u16();
+                                            uint16_t max_version = r.u16();
+                                            uint32_t flags = r.u32();
+                                            if (!r.ok() || protocol != 0 || min_version > 2 || max_version < 2)
+                                            {
+                                                w.u32(0);
+                                                w.str(protocol != 0 ? "unsupported-protocol" : "protocol-version-mismatch");
+                                                sv2_send(s.client, s.s, 0, SV2_SETUP_CONNECTION_ERROR, payload, w.length());
+                                                break;
+                                            }
+                                            s.setup = true;
+                                            w.u16(2);
+                                            w.u32(flags & SV2_REQUIRES_STANDARD_JOBS);
+                                            sv2_send(s.client, s.s, 0, SV2_SETUP_CONNECTION_SUCCESS, payload, w.length());
+                                        }
+                                        break;
+        case SV2_OPEN_STANDARD_CHANNEL: {
+                                            uint32_t request_id = r.u32();
+                                            String user = r.str();
+                                            float hashrate = r.f32();
+                                            if (!r.ok() || !s.setup || s.open)
+                                            {
+                                                w.u32(request_id);
+                                                w.str("unknown-user");
+                                                sv2_send(s.client, s.s, 0, SV2_OPEN_CHANNEL_ERROR, payload, w.length());
+                                                break;
+                                            }
+                                            char extranonce1[9];
+                                            snprintf(extranonce1, sizeof(extranonce1), "%08x", s_next_extranonce1++);
+                                            s.extranonce1 = extranonce1;
+                                            s.channel_id = s_next_channel_id++;
+                                            s.open = true;
+                                            MockSv2Hashrate(s, hashrate);
+
+                                            uint8_t target[32], prefix[32];
+                                            int prefix_len = to_byte_array(extranonce1, 8, prefix);
+                                            memset(prefix + prefix_len, 0, s_config.extranonce2_size);
+                                            MockTargetFromDifficulty(s.difficulty, target);
+                                            w.u32(request_id);
+                                            w.u32(s.channel_id);
+                                            w.u256(target);
+                                            w.b032(prefix, prefix_len + s_config.extranonce2_size);
+                                            w.u32(0);   //group_channel_id
+                                            sv2_send(s.client, s.s, 0, SV2_OPEN_STANDARD_CHANNEL_SUCCESS, payload, w.length());
+                                            if (s_drop_pending > 0)
+                                            {
+                                                uint32_t reconnect_ms = millis() - s_drop_time;
+                                                s_drop_pending--;
+                                                s_stats.reconnects++;
+                                                s_stats.reconnect_total_ms += reconnect_ms;
+                                                if (reconnect_ms > s_stats.reconnect_max_ms)
+                                                    s_stats.reconnect_max_ms = reconnect_ms;
+                                                Serial.printf("[MOCKPOOL] Miner back %ums after the disconnect\n", reconnect_ms);
+                                            }
+                                            if (!s_jobs.empty())
+                                                MockSv2SendJob(s, s_jobs.back(), true);
+                                        }
+                                        break;
+        case SV2_UPDATE_CHANNEL:        {
+                                            uint32_t channel_id = r.u32();
+                                            float hashrate = r.f32();
+                                            if (r.ok() && s.open && channel_id == s.channel_id && MockSv2Hashrate(s, hashrate))
+                                                MockSv2SetTarget(s);
+                                        }
+                                        break;
+        case SV2_SUBMIT_SHARES_STANDARD:
+                                        MockSv2Submit(s, r);
+                                        break;
+        default:                        break;
+    }
+}
+
+static bool MockSv2Accept(MockSv2Session& s)
+{
+    //Valid for a day around now, like a pool rotating its static key daily
+    uint32_t now = (uint32_t)time(NULL);
+    if (!sv2_accept(s.client, s.s, s_sv2_static_key, s_config.authority_secret, now - 43200, now + 43200))
+    {
+        Serial.println("[MOCKPOOL] SV2 handshake failed");
+        return false;
+    }
+    return true;
+}
+
+static void MockPrintStats(void)
+{
+    uint32_t rejected = s_stats.low_difficulty + s_stats.stale + s_stats.duplicate + s_stats.unknown_job + s_stats.bad_version;
+    uint32_t total = s_stats.accepted + rejected;
+    Serial.printf("[MOCKPOOL] shares %u | accepted %u (%u late) | low diff %u | stale %u (%.2f%%) | duplicate %u | unknown job %u | bad version %u\n",
+                  total, s_stats.accepted, s_stats.late, s_stats.low_difficulty, s_stats.stale, total ? 100.0 * s_stats.stale / total : 0.0,
+                  s_stats.duplicate, s_stats.unknown_job, s_stats.bad_version);
+    Serial.printf("[MOCKPOOL] %.2f GH of accepted work | reconnects %u, avg %ums, max %ums | %u jobs\n", s_stats.hashes / 1e9,
+                  s_stats.reconnects, s_stats.reconnects ? s_stats.reconnect_total_ms / s_stats.reconnects : 0, s_stats.reconnect_max_ms,
+                  s_job_sequence);
+}
+
+int mock_pool_main(int argc, char** argv)
+{
+    s_config.port = 3333;
+    s_config.sv2_port = 0;
+    esp_fill_random(s_config.authority_secret, sizeof(s_config.authority_secret));
+    s_config.job_every_ms = 30000;
+    s_config.clean_every = 1;
+    s_config.branches = 12;
+    s_config.difficulty = 0.001;
+    s_config.diff_every_ms = 0;
+    s_config.diff_factor = 4;
+    s_config.drop_every_ms = 0;
+    s_config.extranonce2_size = 4;
+    s_config.version_mask = VERSION_ROLLING_MASK;
+    s_config.honor_suggest = true;
+    s_config.stats_every_ms = 10000;
+
+    for (int i = 0; i < argc; ++i)
+    {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(arg, "--ignore-suggest") == 0)
+        {
+            s_config.honor_suggest = false;
+            continue;
+        }
+        if (value == NULL)
+        {
+            Serial.printf("[MOCKPOOL] Unknown option %s\n", arg);
+            return 1;
+        }
+        ++i;
+        if (strcmp(arg, "--port") == 0)
+            s_config.port = (uint16_t)atoi(value);
+        else if (strcmp(arg, "--sv2-port") == 0)
+            s_config.sv2_port = (uint16_t)atoi(value);
+        else if (strcmp(arg, "--authority-secret") == 0)
+        {
+            if (strlen(value) != 64 || to_byte_array(value, 64, s_config.authority_secret) != 32)
+            {
+                Serial.println("[MOCKPOOL] The authority secret is 32 bytes in hex");
+                return 1;
+            }
+        }
+        else if (strcmp(arg, "--job-every") == 0)
+            s_config.job_every_ms = (uint32_t)atoi(value);
+        else if (strcmp(arg, "--clean-every") == 0)
+            s_config.clean_every = (uint32_t)atoi(value);
+        else if (strcmp(arg, "--branches") == 0)
+            s_config.branches = (uint32_t)atoi(value);
+        else if (strcmp(arg, "--diff") == 0)
+            s_config.difficulty = atof(value);
+        else if (strcmp(arg, "--diff-every") == 0)
+            s_config.diff_every_ms = (uint32_t)(atof(value) * 1000);
+        else if (strcmp(arg, "--diff-factor") == 0)
+            s_config.diff_factor = atof(value);
+        else if (strcmp(arg, "--drop-every") == 0)
+            s_config.drop_every_ms = (uint32_t)(atof(value) * 1000);
+        else if (strcmp(arg, "--extranonce2-size") == 0)
+            s_config.extranonce2_size = atoi(value);
+        else if (strcmp(arg, "--mask") == 0)
+            s_config.version_mask = strtoul(value, NULL, 16);
+        else if (strcmp(arg, "--stats-every") == 0)
+            s_config.stats_every_ms = (uint32_t)(atof(value) * 1000);
+        else
+        {
+            Serial.printf("[MOCKPOOL] Unknown option %s\n", arg);
+            return 1;
+        }
+    }
+    if (s_config.branches > MAX_MERKLE_BRANCHES)
+        s_config.branches = MAX_MERKLE_BRANCHES;
+
+    WiFiServer server(s_config.port);
+    server.begin();
+    if (!server)
+    {
+        Serial.printf("[MOCKPOOL] Unable to listen on port %d\n", s_config.port);
+        return 1;
+    }
+    Serial.printf("[MOCKPOOL] Listening on port %d: job every %ums, clean every %u, %u branches, difficulty %.6g\n", s_config.port,
+                  s_config.job_every_ms, s_config.clean_every, s_config.branches, s_config.difficulty);
+
+    WiFiServer sv2_server(s_config.sv2_port);
+    if (s_config.sv2_port != 0)
+    {
+        uint8_t authority_key[32], static_pubkey[32];
+        if (!secp256k1_pubkey_xonly(authority_key, s_config.authority_secret))
+        {
+            Serial.println("[MOCKPOOL] Invalid authority secret");
+            return 1;
+        }
+        //New static key every run, the certificate ties it to the authority
+        do
+            esp_fill_random(s_sv2_static_key, sizeof(s_sv2_static_key));
+        while (!secp256k1_pubkey_xonly(static_pubkey, s_sv2_static_key));
+        sv2_server.begin();
+        if (!sv2_server)
+        {
+            Serial.printf("[MOCKPOOL] Unable to listen on port %d\n", s_config.sv2_port);
+            return 1;
+        }
+        Serial.printf("[MOCKPOOL] Stratum V2 on port %d: %s127.0.0.1:%d/%s\n", s_config.sv2_port, SV2_URL_SCHEME,
+                      s_config.sv2_port, sv2_authority_key_encode(authority_key).c_str());
+    }
+
+    std::list<std::shared_ptr<MockSession>> sessions;
+    std::list<std::shared_ptr<MockSv2Session>> sv2_sessions;
+    double difficulty = s_config.difficulty;
+    bool difficulty_high = false;
+    uint32_t time_now = millis();
+    uint32_t job_time = time_now;
+    uint32_t diff_time = time_now;
+    uint32_t drop_time = time_now;
+    uint32_t stats_time = time_now;
+    MockNewJob();
+
+    while (true)
+    {
+        time_now = millis();
+
+        WiFiClient incoming = server.available();
+        while (incoming)
+        {
+            std::shared_ptr<MockSession> s = std::make_shared<MockSession>();
+            s->client = incoming;
+            s->client.setNoDelay(true);
+            s->version_mask = 0;
+            s->difficulty = difficulty;
+            s->suggested = false;
+            s->subscribed = false;
+            s->authorized = false;
+            sessions.push_back(s);
+            incoming = server.available();
+        }
+
+        incoming = s_config.sv2_port != 0 ? sv2_server.available() : WiFiClient();
+        while (incoming)
+        {
+            std::shared_ptr<MockSv2Session> s = std::make_shared<MockSv2Session>();
+            s->client = incoming;
+            s->client.setNoDelay(true);
+            s->channel_id = 0;
+            s->difficulty = difficulty;
+            s->suggested = false;
+            s->setup = false;
+            s->open = false;
+            s->next_job_id = 1;
+            if (MockSv2Accept(*s))
+                sv2_sessions.push_back(s);
+            else
+                s->client.stop();
+            incoming = sv2_server.available();
+        }
+
+        for (auto it = sessions.begin(); it != sessions.end(); )
+        {
+            MockSession& s = **it;
+            while (s.client.connected() && s.client.available())
+            {
+                String line = s.client.readStringUntil('\n');
+                if (verifyPayload(&line))
+                    MockHandleLine(s, line);
+            }
+            if (!s.client.connected())
+            {
+                s.client.stop();
+                it = sessions.erase(it);
+            } else
+                ++it;
+        }
+
+        for (auto it = sv2_sessions.begin(); it != sv2_sessions.end(); )
+        {
+            MockSv2Session& s = **it;
+            const uint8_t* payload;
+            bool error = false;
+            while (s.client.connected() && sv2_read_frame(s.client, s.s, payload, error))
+                MockSv2HandleFrame(s, payload);
+            if (error || !s.client.connected())
+            {
+                s.client.stop();
+                it = sv2_sessions.erase(it);
+            } else
+                ++it;
+        }
+
+        if (s_config.diff_every_ms > 0 && time_now - diff_time >= s_config.diff_every_ms)
+        {
+            diff_time = time_now;
+            difficulty_high = !difficulty_high;
+            difficulty = difficulty_high ? s_config.difficulty * s_config.diff_factor : s_config.difficulty;
+            Serial.printf("[MOCKPOOL] Difficulty %.6g\n", difficulty);
+            for (auto it = sessions.begin(); it != sessions.end(); ++it)
+            {
+                MockSession& s = **it;
+                if (s.suggested)
+                    continue;
+                s.difficulty = difficulty;
+                if (s.authorized)
+                    tx_mining_set_difficulty(s.client, s.difficulty);
+            }
+            for (auto it = sv2_sessions.begin(); it != sv2_sessions.end(); ++it)
+            {
+                MockSv2Session& s = **it;
+                if (s.suggested)
+                    continue;
+                s.difficulty = difficulty;
+                if (s.open)
+                    MockSv2SetTarget(s);
+            }
+        }
+
+        if (time_now - job_time >= s_config.job_every_ms)
+        {
+            job_time = time_now;
+            const MockJob& mock = MockNewJob();
+            for (auto it = sessions.begin(); it != sessions.end(); ++it)
+                if ((*it)->authorized)
+                    MockSendJob(**it, mock);
+            for (auto it = sv2_sessions.begin(); it != sv2_sessions.end(); ++it)
+                if ((*it)->open)
+                    MockSv2SendJob(**it, mock, mock.job.clean_jobs);
+        }
+
+        if (s_config.drop_every_ms > 0 && time_now - drop_time >= s_config.drop_every_ms)
+        {
+            drop_time = time_now;
+            Serial.printf("[MOCKPOOL] Dropping %u miner(s)\n", (uint32_t)(sessions.size() + sv2_sessions.size()));
+            s_drop_time = time_now;
+            s_drop_pending = 0;
+            for (auto it = sessions.begin(); it != sessions.end(); ++it)
+            {
+                if ((*it)->authorized)
+                    s_drop_pending++;
+                (*it)->client.stop();
+            }
+            sessions.clear();
+            for (auto it = sv2_sessions.begin(); it != sv2_sessions.end(); ++it)
+            {
+                if ((*it)->open)
+                    s_drop_pending++;
+                (*it)->client.stop();
+            }
+            sv2_sessions.clear();
+        }
+
+        if (time_now - stats_time >= s_config.stats_every_ms)
+        {
+            stats_time = time_now;
+            MockPrintStats();
+        }
+
+        delay(1);
+    }
+    return 0;
+}
+
+#endif // NERDMINER_HOST
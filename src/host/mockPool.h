@@ -0,0 +1,28 @@
+/************************************************************************************
+*   Mock Stratum pool for end to end runs of the host client, host build only.
+*
+*   Serves configure/subscribe/authorize/suggest_difficulty/notify/set_difficulty
+*   and checks every mining.submit by rebuilding the header and hashing it again.
+*   With --sv2-port the same jobs are also served over Stratum V2 standard channels
+*   (merkle root built by the pool), the authority key to give the client is printed
+*   at startup; --authority-secret fixes it across runs.
+*   Job rate, clean_jobs pattern, merkle branch count, difficulty changes and forced
+*   disconnects are configurable, to stress the client:
+*
+*     program --mock-pool [--port 3333] [--sv2-port port] [--authority-secret hex] [--job-every ms] [--clean-every n] [--branches n]
+*             [--diff d] [--diff-every s] [--diff-factor f] [--drop-every s]
+*             [--extranonce2-size n] [--mask hex] [--ignore-suggest] [--stats-every s]
+*
+*   Stats: share validity (accepted, low difficulty, stale, duplicate, unknown job,
+*   bad version bits), stale rate and reconnect time after a forced disconnect.
+*************************************************************************************/
+#ifndef HOST_MOCK_POOL_H_
+#define HOST_MOCK_POOL_H_
+
+#ifdef NERDMINER_HOST
+
+int mock_pool_main(int argc, char** argv);
+
+#endif // NERDMINER_HOST
+
+#endif // HOST_MOCK_POOL_H_
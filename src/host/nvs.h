@@ -0,0 +1,35 @@
+/************************************************************************************
+*   NVS stand-in for the native (host) build: nothing is persisted, every read
+*   reports ESP_ERR_NVS_NOT_FOUND so stats always start from zero.
+*************************************************************************************/
+#ifndef HOST_NVS_H_
+#define HOST_NVS_H_
+
+#ifdef NERDMINER_HOST
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef uint32_t nvs_handle_t;
+
+typedef enum {
+    NVS_READONLY,
+    NVS_READWRITE
+} nvs_open_mode_t;
+
+static inline esp_err_t nvs_open(const char* name, nvs_open_mode_t mode, nvs_handle_t* handle) { (void)name; (void)mode; *handle = 1; return ESP_OK; }
+static inline void nvs_close(nvs_handle_t handle) { (void)handle; }
+static inline esp_err_t nvs_commit(nvs_handle_t handle) { (void)handle; return ESP_OK; }
+
+static inline esp_err_t nvs_get_blob(nvs_handle_t h, const char* key, void* out, size_t* len) { (void)h; (void)key; (void)out; (void)len; return ESP_ERR_NVS_NOT_FOUND; }
+static inline esp_err_t nvs_get_u32(nvs_handle_t h, const char* key, uint32_t* out) { (void)h; (void)key; (void)out; return ESP_ERR_NVS_NOT_FOUND; }
+static inline esp_err_t nvs_get_u64(nvs_handle_t h, const char* key, uint64_t* out) { (void)h; (void)key; (void)out; return ESP_ERR_NVS_NOT_FOUND; }
+
+static inline esp_err_t nvs_set_blob(nvs_handle_t h, const char* key, const void* value, size_t len) { (void)h; (void)key; (void)value; (void)len; return ESP_OK; }
+static inline esp_err_t nvs_set_u32(nvs_handle_t h, const char* key, uint32_t value) { (void)h; (void)key; (void)value; return ESP_OK; }
+static inline esp_err_t nvs_set_u64(nvs_handle_t h, const char* key, uint64_t value) { (void)h; (void)key; (void)value; return ESP_OK; }
+
+#endif // NERDMINER_HOST
+
+#endif // HOST_NVS_H_
@@ -0,0 +1,13 @@
+#ifndef HOST_NVS_FLASH_H_
+#define HOST_NVS_FLASH_H_
+
+#ifdef NERDMINER_HOST
+
+#include "esp_err.h"
+
+static inline esp_err_t nvs_flash_init(void) { return ESP_OK; }
+static inline esp_err_t nvs_flash_erase(void) { return ESP_OK; }
+
+#endif // NERDMINER_HOST
+
+#endif // HOST_NVS_FLASH_H_
@@ -0,0 +1,268 @@
+#ifdef NERDMINER_HOST
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <WiFi.h>
+#include <stdio.h>
+#include <algorithm>
+#include <map>
+#include <vector>
+#include "stratum.h"
+#include "mining.h"
+#include "utils.h"
+#include "stratumReplay.h"
+
+#define REPLAY_LINE_MAX     8192
+#define REPLAY_LINGER_ms    2000    //Keep the miner connected after the last message, for its late submits
+
+struct ReplayLine
+{
+    uint32_t ms;
+    char direction;     //'r' from the pool, 't' to the pool
+    String line;
+    String method;      //Empty for answers
+    unsigned long id;
+};
+
+static StaticJsonDocument<BUFFER_JSON_DOC> s_doc;
+static stratum_session s_session;   //Parse timings of the replayed pool lines
+
+static void ReplayPeek(const String& line, String& method, unsigned long& id)
+{
+    method = "";
+    id = 0;
+    if (deserializeJson(s_doc, line))
+        return;
+    method = (const char*)(s_doc["method"] | "");
+    id = s_doc["id"].as<unsigned long>();
+}
+
+static bool ReplayLoad(const char* path, std::vector<ReplayLine>& lines)
+{
+    FILE* file = fopen(path, "r");
+    if (file == NULL)
+    {
+        Serial.printf("[REPLAY] Unable to open %s\n", path);
+        return false;
+    }
+    std::vector<char> buffer(REPLAY_LINE_MAX);
+    while (fgets(buffer.data(), buffer.size(), file))
+    {
+        unsigned int ms;
+        char direction;
+        int offset = 0;
+        if (sscanf(buffer.data(), "%u %c %n", &ms, &direction, &offset) < 2 || offset == 0 || (direction != 'r' && direction != 't'))
+            continue;
+        ReplayLine line;
+        line.ms = ms;
+        line.direction = direction;
+        line.line = String(buffer.data() + offset);
+        line.line.trim();
+        ReplayPeek(line.line, line.method, line.id);
+        lines.push_back(line);
+    }
+    fclose(file);
+    Serial.printf("[REPLAY] %u lines loaded from %s\n", (uint32_t)lines.size(), path);
+    return !lines.empty();
+}
+
+//Answers carry the id of the request, the replayed client numbers them its own way
+static String ReplayWithId(const String& line, unsigned long id)
+{
+    int key = line.indexOf("\"id\"");
+    if (key < 0)
+        return line;
+    int start = line.indexOf(':', key) + 1;
+    while (start < (int)line.length() && line[start] == ' ')
+        start++;
+    int end = start;
+    while (end < (int)line.length() && line[end] != ',' && line[end] != '}')
+        end++;
+    return line.substring(0, start) + String(id) + line.substring(end);
+}
+
+int replay_server(const char* path, uint16_t port, double speed)
+{
+    std::vector<ReplayLine> lines;
+    if (!ReplayLoad(path, lines))
+        return 1;
+    if (speed <= 0)
+        speed = 1;
+
+    //Captured answers by request method, and the pool messages to replay
+    std::map<unsigned long, String> requests;
+    std::map<String, String> answers;
+    std::vector<const ReplayLine*> events;
+    uint32_t anchor = 0xFFFFFFFF;
+    for (size_t i = 0; i < lines.size(); ++i)
+    {
+        const ReplayLine& l = lines[i];
+        if (l.direction == 't')
+        {
+            if (l.method.length() > 0 && l.id != 0)
+                requests[l.id] = l.method;
+        } else if (l.method.length() > 0)
+        {
+            events.push_back(&l);
+        } else
+        {
+            auto it = requests.find(l.id);
+            if (it != requests.end() && answers.find(it->second) == answers.end())
+            {
+                answers[it->second] = l.line;
+                if (it->second == "mining.authorize")
+                    anchor = l.ms;
+            }
+        }
+    }
+    if (anchor == 0xFFFFFFFF)
+        anchor = events.empty() ? 0 : events[0]->ms;
+    Serial.printf("[REPLAY] %u pool messages over %us, replayed at x%.2f\n", (uint32_t)events.size(),
+                  events.empty() ? 0 : (events.back()->ms - anchor) / 1000, speed);
+
+    WiFiServer server(port);
+    server.begin();
+    if (!server)
+    {
+        Serial.printf("[REPLAY] Unable to listen on port %d\n", port);
+        return 1;
+    }
+    Serial.printf("[REPLAY] Listening on port %d\n", port);
+
+    while (true)
+    {
+        WiFiClient client = server.available();
+        if (!client)
+        {
+            delay(10);
+            continue;
+        }
+        client.setNoDelay(true);
+        Serial.println("[REPLAY] Miner connected");
+
+        size_t next = 0;
+        bool started = false;
+        uint32_t start_time = 0;
+        uint32_t done_time = 0;
+        uint32_t submits = 0;
+        while (client.connected())
+        {
+            while (client.available())
+            {
+                String line = client.readStringUntil('\n');
+                if (!verifyPayload(&line))
+                    continue;
+                String method;
+                unsigned long id;
+                ReplayPeek(line, method, id);
+                if (method.length() == 0 || id == 0)
+                    continue;
+                if (method == "mining.submit")
+                    submits++;
+                auto it = answers.find(method);
+                String answer = (it != answers.end() && method != "mining.submit") ? ReplayWithId(it->second, id)
+                                                                                   : "{\"id\":" + String(id) + ",\"result\":true,\"error\":null}";
+                client.print(answer + "\n");
+                if (method == "mining.authorize" && !started)
+                {
+                    started = true;
+                    start_time = millis();
+                }
+            }
+
+            if (started)
+            {
+                uint32_t elapsed = millis() - start_time;
+                while (next < events.size() && (events[next]->ms <= anchor || elapsed >= (uint32_t)((events[next]->ms - anchor) / speed)))
+                {
+                    client.print(events[next]->line + "\n");
+                    next++;
+                }
+                if (next == events.size())
+                {
+                    if (done_time == 0)
+                        done_time = millis();
+                    else if (millis() - done_time >= REPLAY_LINGER_ms)
+                        break;
+                }
+            }
+            delay(1);
+        }
+        client.stop();
+        Serial.printf("[REPLAY] Session over: %u/%u pool messages sent in %ums, %u submits\n", (uint32_t)next, (uint32_t)events.size(),
+                      started ? millis() - start_time : 0, submits);
+    }
+    return 0;
+}
+
+struct ReplayStat
+{
+    std::vector<uint32_t> samples;
+};
+
+int replay_bench(const char* path, unsigned int loops)
+{
+    std::vector<ReplayLine> lines;
+    if (!ReplayLoad(path, lines))
+        return 1;
+    if (loops == 0)
+        loops = 1;
+
+    //Session state as the client had it: subscribe answer, then every pool message in order
+    unsigned long subscribe_id = 0;
+    for (size_t i = 0; i < lines.size() && subscribe_id == 0; ++i)
+        if (lines[i].direction == 't' && lines[i].method == "mining.subscribe")
+            subscribe_id = lines[i].id;
+
+    std::map<String, ReplayStat> stats;
+    for (unsigned int loop = 0; loop < loops; ++loop)
+    {
+        mining_subscribe worker = init_mining_subscribe();
+        mining_job job;
+        double difficulty = DEFAULT_DIFFICULTY;
+        for (size_t i = 0; i < lines.size(); ++i)
+        {
+            const ReplayLine& l = lines[i];
+            if (l.direction != 'r')
+                continue;
+            if (l.method.length() == 0 && l.id == subscribe_id)
+            {
+                parse_mining_subscribe(s_session, l.line, worker);
+                continue;
+            }
+
+            uint32_t start_us = micros();
+            switch (parse_mining_method(s_session, l.line))
+            {
+                case MINING_NOTIFY:             if (parse_mining_notify(s_session, l.line, job) && worker.extranonce2_size > 0)
+                                                    calculateMiningData(worker, job);
+                                                break;
+                case MINING_SET_DIFFICULTY:     parse_mining_set_difficulty(s_session, l.line, difficulty);
+                                                break;
+                case MINING_SET_EXTRANONCE:     parse_mining_set_extranonce(s_session, l.line, worker);
+                                                break;
+                case MINING_SET_VERSION_MASK:   parse_mining_set_version_mask(s_session, l.line, worker.version_mask);
+                                                break;
+                default:                        break;
+            }
+            uint32_t elapsed_us = micros() - start_us;
+            stats[l.method.length() > 0 ? l.method : String("(answer)")].samples.push_back(elapsed_us);
+        }
+    }
+
+    Serial.printf("\n[REPLAY] %s, %u loop(s), time per pool message\n", path, loops);
+    Serial.printf("  %-28s %8s %10s %10s %10s %10s\n", "message", "count", "mean us", "p50 us", "p99 us", "max us");
+    for (auto it = stats.begin(); it != stats.end(); ++it)
+    {
+        std::vector<uint32_t>& samples = it->second.samples;
+        std::sort(samples.begin(), samples.end());
+        uint64_t total = 0;
+        for (size_t i = 0; i < samples.size(); ++i)
+            total += samples[i];
+        Serial.printf("  %-28s %8u %10.1f %10u %10u %10u\n", it->first.c_str(), (uint32_t)samples.size(), (double)total / samples.size(),
+                      samples[samples.size() / 2], samples[(samples.size() * 99) / 100], samples.back());
+    }
+    return 0;
+}
+
+#endif // NERDMINER_HOST
@@ -0,0 +1,24 @@
+/************************************************************************************
+*   Offline replay of a stratum capture (see stratumCapture.h), host build only.
+*
+*   replay_server: acts as the captured pool. Handshake requests get the captured
+*   answers (ids rewritten), pool messages are sent on the captured timeline, scaled
+*   by speed, from the authorize answer on. Submits are accepted without checks.
+*   Point a client at it to compare job switch latency across builds.
+*
+*   replay_bench: runs the captured pool messages through the client parsers and
+*   calculateMiningData, and prints the time spent per message type.
+*************************************************************************************/
+#ifndef HOST_STRATUM_REPLAY_H_
+#define HOST_STRATUM_REPLAY_H_
+
+#ifdef NERDMINER_HOST
+
+#include <stdint.h>
+
+int replay_server(const char* path, uint16_t port, double speed);
+int replay_bench(const char* path, unsigned int loops);
+
+#endif // NERDMINER_HOST
+
+#endif // HOST_STRATUM_REPLAY_H_
@@ -0,0 +1,334 @@
+#include <Arduino.h>
+#include <stdarg.h>
+#include <atomic>
+#include "logger.h"
+
+static_assert((LOGGER_RECORDS & (LOGGER_RECORDS - 1)) == 0, "LOGGER_RECORDS must be a power of 2");
+
+//Argument of a conversion, as read from the va_list
+enum {
+  LOG_ARG_END,        //End of the format or unsupported conversion
+  LOG_ARG_NONE,       //"%%"
+  LOG_ARG_INT,
+  LOG_ARG_LONG,
+  LOG_ARG_LONG_LONG,
+  LOG_ARG_SIZE,
+  LOG_ARG_PTRDIFF,
+  LOG_ARG_DOUBLE,
+  LOG_ARG_LONG_DOUBLE,
+  LOG_ARG_POINTER,
+  LOG_ARG_STRING
+};
+
+typedef struct {
+  const char* start;    //The '%'
+  size_t length;        //Up to the conversion character included
+  int stars;            //'*' width and precision, ints before the value
+  int type;
+} log_spec;
+
+//Sequence, zero initialized: position & ~(LOGGER_RECORDS - 1) of the lap the record
+//is free for, + 1 once written. Vyukov bounded queue, many producers, one consumer.
+typedef struct {
+  std::atomic<uint32_t> sequence;
+  const char* format;
+  uint8_t args[LOGGER_RECORD_SIZE - sizeof(std::atomic<uint32_t>) - sizeof(const char*)];
+} log_record;
+
+static log_record s_records[LOGGER_RECORDS];
+static std::atomic<uint32_t> s_head(0);
+static uint32_t s_tail = 0;                     //Logger task only
+static std::atomic<uint32_t> s_dropped(0);
+static std::atomic<bool> s_running(false);
+static std::atomic<bool> s_hold(false);
+static TaskHandle_t s_task = NULL;
+static char s_line[2 * LOGGER_RECORD_SIZE];     //Logger task only
+
+static const char* LoggerSpec(const char* p, log_spec& spec)
+{
+  spec.start = p++;
+  spec.stars = 0;
+  while (*p && strchr("-+ #0", *p))
+    p++;
+  if (*p == '*') { spec.stars++; p++; }
+  else while (isdigit((unsigned char)*p)) p++;
+  if (*p == '.')
+  {
+    p++;
+    if (*p == '*') { spec.stars++; p++; }
+    else while (isdigit((unsigned char)*p)) p++;
+  }
+
+  char length = 0, length2 = 0;
+  if (*p && strchr("hlLzjt", *p))
+  {
+    length = *p++;
+    if ((length == 'h' || length == 'l') && *p == length)
+      length2 = *p++;
+  }
+
+  char conversion = *p;
+  if (conversion)
+    p++;
+  switch (conversion)
+  {
+    case '%': spec.type = LOG_ARG_NONE; break;
+    case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+      if (length == 'l' && length2) spec.type = LOG_ARG_LONG_LONG;
+      else if (length == 'l')       spec.type = LOG_ARG_LONG;
+      else if (length == 'j')       spec.type = LOG_ARG_LONG_LONG;
+      else if (length == 'z')       spec.type = LOG_ARG_SIZE;
+      else if (length == 't')       spec.type = LOG_ARG_PTRDIFF;
+      else                          spec.type = LOG_ARG_INT;
+      break;
+    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+      spec.type = (length == 'L') ? LOG_ARG_LONG_DOUBLE : LOG_ARG_DOUBLE;
+      break;
+    case 's': spec.type = LOG_ARG_STRING; break;
+    case 'p': spec.type = LOG_ARG_POINTER; break;
+    default:  spec.type = LOG_ARG_END; break;
+  }
+  spec.length = p - spec.start;
+  return p;
+}
+
+static size_t LoggerArgSize(int type)
+{
+  switch (type)
+  {
+    case LOG_ARG_INT:         return sizeof(int);
+    case LOG_ARG_LONG:        return sizeof(long);
+    case LOG_ARG_LONG_LONG:   return sizeof(long long);
+    case LOG_ARG_SIZE:        return sizeof(size_t);
+    case LOG_ARG_PTRDIFF:     return sizeof(ptrdiff_t);
+    case LOG_ARG_DOUBLE:      return sizeof(double);
+    case LOG_ARG_LONG_DOUBLE: return sizeof(long double);
+    case LOG_ARG_POINTER:     return sizeof(void*);
+    case LOG_ARG_STRING:      return 1;   //The NUL, the text shares what is left
+    default:                  return 0;
+  }
+}
+
+template <typename T> static inline void LoggerPut(uint8_t*& out, T value)
+{
+  memcpy(out, &value, sizeof(T));
+  out += sizeof(T);
+}
+
+template <typename T> static inline T LoggerGet(const uint8_t*& in)
+{
+  T value;
+  memcpy(&value, in, sizeof(T));
+  in += sizeof(T);
+  return value;
+}
+
+//Copy of the arguments of format, false when they can't fit
+static bool LoggerPack(uint8_t* out, size_t room, const char* format, va_list args)
+{
+  log_spec spec;
+  size_t fixed = 0;
+  for (const char* p = strchr(format, '%'); p != NULL; p = strchr(p, '%'))
+  {
+    p = LoggerSpec(p, spec);
+    if (spec.type == LOG_ARG_END)
+      break;
+    fixed += spec.stars * sizeof(int) + LoggerArgSize(spec.type);
+  }
+  if (fixed > room)
+    return false;
+
+  size_t text = room - fixed;
+  for (const char* p = strchr(format, '%'); p != NULL; p = strchr(p, '%'))
+  {
+    p = LoggerSpec(p, spec);
+    if (spec.type == LOG_ARG_END)
+      break;
+    for (int i = 0; i < spec.stars; ++i)
+      LoggerPut(out, va_arg(args, int));
+    switch (spec.type)
+    {
+      case LOG_ARG_INT:         LoggerPut(out, va_arg(args, int)); break;
+      case LOG_ARG_LONG:        LoggerPut(out, va_arg(args, long)); break;
+      case LOG_ARG_LONG_LONG:   LoggerPut(out, va_arg(args, long long)); break;
+      case LOG_ARG_SIZE:        LoggerPut(out, va_arg(args, size_t)); break;
+      case LOG_ARG_PTRDIFF:     LoggerPut(out, va_arg(args, ptrdiff_t)); break;
+      case LOG_ARG_DOUBLE:      LoggerPut(out, va_arg(args, double)); break;
+      case LOG_ARG_LONG_DOUBLE: LoggerPut(out, va_arg(args, long double)); break;
+      case LOG_ARG_POINTER:     LoggerPut(out, va_arg(args, void*)); break;
+      case LOG_ARG_STRING:
+      {
+        const char* s = va_arg(args, const char*);
+        if (s == NULL)
+          s = "(null)";
+        size_t length = strlen(s);
+        size_t copy = length < text ? length : text;
+        memcpy(out, s, copy);
+        if (copy < length && copy >= 2)
+          memcpy(out + copy - 2, "..", 2);
+        out[copy] = 0;
+        out += copy + 1;
+        text -= copy;
+        break;
+      }
+    }
+  }
+  return true;
+}
+
+template <typename T> static int LoggerPrint(char* out, size_t room, const char* spec, int stars, const int* star, T value)
+{
+  if (stars == 0)
+    return snprintf(out, room, spec, value);
+  if (stars == 1)
+    return snprintf(out, room, spec, star[0], value);
+  return snprintf(out, room, spec, star[0], star[1], value);
+}
+
+//Format of a record into out, returns the length
+static size_t LoggerFormat(char* out, size_t room, const char* format, const uint8_t* args)
+{
+  size_t length = 0;
+  const char* p = format;
+  while (*p && length + 1 < room)
+  {
+    const char* percent = strchr(p, '%');
+    size_t literal = percent ? (size_t)(percent - p) : strlen(p);
+    if (literal > room - 1 - length)
+      literal = room - 1 - length;
+    memcpy(out + length, p, literal);
+    length += literal;
+    if (percent == NULL)
+      break;
+
+    log_spec spec;
+    p = LoggerSpec(percent, spec);
+    char conversion[24];
+    if (spec.type == LOG_ARG_END || spec.length >= sizeof(conversion))
+      break;
+    memcpy(conversion, spec.start, spec.length);
+    conversion[spec.length] = 0;
+
+    int star[2] = { 0, 0 };
+    for (int i = 0; i < spec.stars; ++i)
+      star[i] = LoggerGet<int>(args);
+    char* at = out + length;
+    size_t left = room - length;
+    int n = 0;
+    switch (spec.type)
+    {
+      case LOG_ARG_NONE:        n = snprintf(at, left, "%%"); break;
+      case LOG_ARG_INT:         n = LoggerPrint(at, left, conversion, spec.stars, star, LoggerGet<int>(args)); break;
+      case LOG_ARG_LONG:        n = LoggerPrint(at, left, conversion, spec.stars, star, LoggerGet<long>(args)); break;
+      case LOG_ARG_LONG_LONG:   n = LoggerPrint(at, left, conversion, spec.stars, star, LoggerGet<long long>(args)); break;
+      case LOG_ARG_SIZE:        n = LoggerPrint(at, left, conversion, spec.stars, star, LoggerGet<size_t>(args)); break;
+      case LOG_ARG_PTRDIFF:     n = LoggerPrint(at, left, conversion, spec.stars, star, LoggerGet<ptrdiff_t>(args)); break;
+      case LOG_ARG_DOUBLE:      n = LoggerPrint(at, left, conversion, spec.stars, star, LoggerGet<double>(args)); break;
+      case LOG_ARG_LONG_DOUBLE: n = LoggerPrint(at, left, conversion, spec.stars, star, LoggerGet<long double>(args)); break;
+      case LOG_ARG_POINTER:     n = LoggerPrint(at, left, conversion, spec.stars, star, LoggerGet<void*>(args)); break;
+      case LOG_ARG_STRING:
+        n = LoggerPrint(at, left, conversion, spec.stars, star, (const char*)args);
+        args += strlen((const char*)args) + 1;
+        break;
+    }
+    if (n > 0)
+      length += ((size_t)n < left) ? (size_t)n : left - 1;
+  }
+  out[length] = 0;
+  return length;
+}
+
+static void LoggerTask(void* param)
+{
+  uint32_t reported = 0;
+  while (true)
+  {
+    log_record& record = s_records[s_tail & (LOGGER_RECORDS - 1)];
+    uint32_t lap = s_tail & ~(uint32_t)(LOGGER_RECORDS - 1);
+    if (!s_hold.load(std::memory_order_relaxed) && record.sequence.load(std::memory_order_acquire) == lap + 1)
+    {
+      size_t length = LoggerFormat(s_line, sizeof(s_line), record.format, record.args);
+      record.sequence.store(lap + LOGGER_RECORDS, std::memory_order_release);
+      s_tail++;
+      //The UART blocks this task only
+      Serial.write((const uint8_t*)s_line, length);
+      continue;
+    }
+
+    uint32_t dropped = s_dropped.load(std::memory_order_relaxed);
+    if (dropped != reported && !s_hold.load(std::memory_order_relaxed))
+    {
+      Serial.printf("[LOG] %u messages dropped, the serial port can't keep up (%u since boot)\n", dropped - reported, dropped);
+      reported = dropped;
+    }
+    ulTaskNotifyTake(pdTRUE, LOGGER_IDLE_ms / portTICK_PERIOD_MS);
+  }
+}
+
+void logger_setup(void)
+{
+#ifndef LOGGER_SYNC
+  s_running = true;
+  //Below the stratum and monitor tasks, shares the core with the software miners
+  if (xTaskCreate(LoggerTask, "Logger", 3072, NULL, 1, &s_task) != pdPASS)
+  {
+    s_running = false;
+    Serial.println("Logger task not started, logging synchronously");
+  }
+#endif
+}
+
+void logger_hold(bool hold)
+{
+  s_hold = hold;
+}
+
+uint32_t logger_dropped(void)
+{
+  return s_dropped.load(std::memory_order_relaxed);
+}
+
+void logger_write(const char* format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  if (!s_running.load(std::memory_order_relaxed))
+  {
+    char line[2 * LOGGER_RECORD_SIZE];
+    int length = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if (length > 0)
+      Serial.write((const uint8_t*)line, ((size_t)length < sizeof(line)) ? (size_t)length : sizeof(line) - 1);
+    return;
+  }
+
+  uint32_t position = s_head.load(std::memory_order_relaxed);
+  log_record* record;
+  while (true)
+  {
+    record = &s_records[position & (LOGGER_RECORDS - 1)];
+    uint32_t lap = position & ~(uint32_t)(LOGGER_RECORDS - 1);
+    int32_t diff = (int32_t)(record->sequence.load(std::memory_order_acquire) - lap);
+    if (diff == 0)
+    {
+      if (s_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+        break;
+    } else if (diff < 0)
+    {
+      //Record of the previous lap not printed yet: full
+      va_end(args);
+      s_dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    } else
+      position = s_head.load(std::memory_order_relaxed);
+  }
+
+  record->format = format;
+  if (!LoggerPack(record->args, sizeof(record->args), format, args))
+    record->format = "[LOG] Record too small for a message\n";
+  va_end(args);
+  record->sequence.store((position & ~(uint32_t)(LOGGER_RECORDS - 1)) + 1, std::memory_order_release);
+  //Burst: wake the logger task every half ring instead of waiting for its idle poll
+  if ((position & (LOGGER_RECORDS / 2 - 1)) == LOGGER_RECORDS / 2 - 1 && s_task != NULL)
+    xTaskNotifyGive(s_task);
+}
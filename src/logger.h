@@ -0,0 +1,86 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <Arduino.h>
+
+/************************************************************************************
+*   Deferred serial logger for the stratum, miner and monitor tasks.
+*
+*   LOG_x() takes a printf format and returns without formatting nor touching the
+*   UART: the format pointer and a copy of the arguments go to a ring of fixed size
+*   records, the low priority logger task formats and prints them. At 115200 bauds
+*   a 200 chars line takes 17ms, the caller no longer waits for it.
+*
+*   - The format must be a string literal (or outlive the record), %s arguments are
+*     copied and cut with ".." when they don't fit in the record.
+*   - Producers never block: when the ring is full (UART slower than the logs) the
+*     record is dropped and counted, the logger task prints the count.
+*   - Levels above LOGGER_LEVEL compile to nothing.
+*   - Before logger_setup(), or built with -D LOGGER_SYNC, lines print right away.
+*   - Records still in the ring are lost on a crash, use LOGGER_SYNC to debug one.
+*
+*   Build with -D LOGGER_LEVEL=LOGGER_DEBUG to get the DEBUG_MINING dumps.
+*************************************************************************************/
+
+#define LOGGER_NONE       0
+#define LOGGER_ERROR      1
+#define LOGGER_WARN       2
+#define LOGGER_INFO       3
+#define LOGGER_DEBUG      4
+#define LOGGER_VERBOSE    5
+
+#ifndef LOGGER_LEVEL
+#ifdef DEBUG_MINING
+#define LOGGER_LEVEL      LOGGER_DEBUG
+#else
+#define LOGGER_LEVEL      LOGGER_INFO
+#endif
+#endif
+
+#ifndef LOGGER_RECORDS
+#define LOGGER_RECORDS    16      //Power of 2
+#endif
+#ifndef LOGGER_RECORD_SIZE
+#define LOGGER_RECORD_SIZE 256    //Bytes, with the format pointer and the arguments
+#endif
+#define LOGGER_IDLE_ms    20
+
+//Starts the logger task
+void logger_setup(void);
+
+void logger_write(const char* format, ...) __attribute__((format(printf, 1, 2)));
+
+//Records dropped since boot, the ring was full
+uint32_t logger_dropped(void);
+
+//Holds the queued records while another task owns the serial port (records past
+//the ring are dropped), releases them with false
+void logger_hold(bool hold);
+
+#if LOGGER_LEVEL >= LOGGER_ERROR
+#define LOG_E(...)        logger_write(__VA_ARGS__)
+#else
+#define LOG_E(...)        do {} while (0)
+#endif
+#if LOGGER_LEVEL >= LOGGER_WARN
+#define LOG_W(...)        logger_write(__VA_ARGS__)
+#else
+#define LOG_W(...)        do {} while (0)
+#endif
+#if LOGGER_LEVEL >= LOGGER_INFO
+#define LOG_I(...)        logger_write(__VA_ARGS__)
+#else
+#define LOG_I(...)        do {} while (0)
+#endif
+#if LOGGER_LEVEL >= LOGGER_DEBUG
+#define LOG_D(...)        logger_write(__VA_ARGS__)
+#else
+#define LOG_D(...)        do {} while (0)
+#endif
+#if LOGGER_LEVEL >= LOGGER_VERBOSE
+#define LOG_V(...)        logger_write(__VA_ARGS__)
+#else
+#define LOG_V(...)        do {} while (0)
+#endif
+
+#endif // LOGGER_H
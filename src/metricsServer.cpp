@@ -0,0 +1,282 @@
+#include <Arduino.h>
+#include <WiFi.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+#include <stdarg.h>
+#include <mutex>
+#include "metricsServer.h"
+#include "logger.h"
+#include "hashrateHistory.h"
+
+static uint16_t s_port = 0;
+static std::mutex s_metrics_mutex;
+static mining_metrics s_published;
+static bool s_has_metrics = false;
+
+static const char* const s_latency_names[METRICS_LATENCIES] = {
+  "switch_parsed",      //Pool data seen to the job parsed
+  "switch_built",       //Pool data seen to the header built
+  "switch_published",   //Pool data seen to the requests queued for the miners
+  "dispatch",           //Pool data seen to a miner taking the new job
+  "dispatch_all",       //Pool data seen to the last miner taking the new job
+  "result",             //Result posted to the stratum task handling it
+  "message_parse",      //Reading and parsing one pool message
+  "job_build",          //Pool job to the header the miners hash
+};
+
+//Response written in TCP segment sized pieces
+typedef struct {
+  WiFiClient* client;
+  char data[1024];
+  size_t length;
+} metrics_output;
+
+static void MetricsFlush(metrics_output& out)
+{
+  if (out.length > 0)
+    out.client->write((const uint8_t*)out.data, out.length);
+  out.length = 0;
+}
+
+static void MetricsPrint(metrics_output& out, const char* format, ...) __attribute__((format(printf, 2, 3)));
+static void MetricsPrint(metrics_output& out, const char* format, ...)
+{
+  for (int attempt = 0; attempt < 2; ++attempt)
+  {
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(out.data + out.length, sizeof(out.data) - out.length, format, args);
+    va_end(args);
+    if (length >= 0 && out.length + length < sizeof(out.data))
+    {
+      out.length += length;
+      return;
+    }
+    MetricsFlush(out);
+  }
+}
+
+static void MetricsHeader(metrics_output& out, const char* name, const char* type, const char* help)
+{
+  MetricsPrint(out, "# HELP nerdminer_%s %s\n# TYPE nerdminer_%s %s\n", name, help, name, type);
+}
+
+static void MetricsWrite(metrics_output& out, const mining_metrics& m)
+{
+  MetricsHeader(out, "hashes_total", "counter", "Nonces hashed by each miner task");
+  for (int i = 0; i < MINING_WORKERS; ++i)
+    if (m.worker_names[i] != NULL)
+      MetricsPrint(out, "nerdminer_hashes_total{worker=\"%s\"} %llu\n", m.worker_names[i], (unsigned long long)m.worker_hashes[i]);
+
+  MetricsHeader(out, "pool_difficulty", "gauge", "Share difficulty set by the pool");
+  MetricsPrint(out, "nerdminer_pool_difficulty %.12g\n", m.pool_difficulty);
+  MetricsHeader(out, "best_difficulty", "gauge", "Best share difficulty since boot");
+  MetricsPrint(out, "nerdminer_best_difficulty %.12g\n", m.best_diff);
+
+  MetricsHeader(out, "shares_submitted_total", "counter", "Shares sent to the pool");
+  MetricsPrint(out, "nerdminer_shares_submitted_total %u\n", m.shares_submitted);
+  MetricsHeader(out, "shares_accepted_total", "counter", "Shares accepted by the pool");
+  MetricsPrint(out, "nerdminer_shares_accepted_total %u\n", m.shares_accepted);
+  MetricsHeader(out, "shares_rejected_total", "counter", "Shares rejected by the pool");
+  MetricsPrint(out, "nerdminer_shares_rejected_total %u\n", m.shares_rejected);
+  MetricsHeader(out, "shares_rejected_reason_total", "counter", "Shares rejected by the pool, by reason");
+  for (int r = 0; r < SHARE_REJECT_REASONS; ++r)
+    MetricsPrint(out, "nerdminer_shares_rejected_reason_total{reason=\"%s\"} %u\n", share_reject_name((share_reject)r), m.shares_rejected_by[r]);
+  MetricsHeader(out, "shares_stale_total", "counter", "Shares answered after the pool moved to a new block");
+  MetricsPrint(out, "nerdminer_shares_stale_total %u\n", m.shares_stale);
+  MetricsHeader(out, "shares_lost_total", "counter", "Shares without an answer: timed out or the connection was lost");
+  MetricsPrint(out, "nerdminer_shares_lost_total %u\n", m.shares_lost);
+  MetricsHeader(out, "shares_answered_late_total", "counter", "Answers to shares already counted lost");
+  MetricsPrint(out, "nerdminer_shares_answered_late_total %u\n", m.shares_answered_late);
+  MetricsHeader(out, "difficulty_submitted_total", "counter", "Pool difficulty of the shares sent");
+  MetricsPrint(out, "nerdminer_difficulty_submitted_total %.12g\n", m.difficulty_submitted);
+  MetricsHeader(out, "difficulty_accepted_total", "counter", "Pool difficulty of the shares accepted");
+  MetricsPrint(out, "nerdminer_difficulty_accepted_total %.12g\n", m.difficulty_accepted);
+
+  //Bucket n ends at 2^n ms
+  MetricsHeader(out, "share_rtt_seconds", "histogram", "Share submit to the pool answer");
+  {
+    const latency_histogram& h = m.share_rtt;
+    uint32_t count = 0;
+    for (int i = 0; i < LATENCY_BUCKETS - 1; ++i)
+    {
+      count += h.count[i];
+      MetricsPrint(out, "nerdminer_share_rtt_seconds_bucket{le=\"%g\"} %u\n", (1u << i) / 1e3, count);
+    }
+    MetricsPrint(out, "nerdminer_share_rtt_seconds_bucket{le=\"+Inf\"} %u\n", h.samples);
+    MetricsPrint(out, "nerdminer_share_rtt_seconds_sum %.3f\n", h.total_us / 1e3);
+    MetricsPrint(out, "nerdminer_share_rtt_seconds_count %u\n", h.samples);
+  }
+  MetricsHeader(out, "shares_32bit_total", "counter", "Accepted shares with 32 zero bits");
+  MetricsPrint(out, "nerdminer_shares_32bit_total %u\n", m.shares_32bit);
+  MetricsHeader(out, "blocks_found_total", "counter", "Valid blocks found");
+  MetricsPrint(out, "nerdminer_blocks_found_total %u\n", m.blocks);
+
+  MetricsHeader(out, "job_switches_total", "counter", "Pool jobs replacing the mined one");
+  MetricsPrint(out, "nerdminer_job_switches_total %u\n", m.job_switches);
+  MetricsHeader(out, "stale_hashes_total", "counter", "Nonces hashed on a job after it was replaced");
+  MetricsPrint(out, "nerdminer_stale_hashes_total %llu\n", (unsigned long long)m.stale_nonces);
+
+  MetricsHeader(out, "pool_disconnects_total", "counter", "Pool connections lost");
+  MetricsPrint(out, "nerdminer_pool_disconnects_total %u\n", m.pool_disconnects);
+  MetricsHeader(out, "pool_failovers_total", "counter", "Moves to another pool of the list");
+  MetricsPrint(out, "nerdminer_pool_failovers_total %u\n", m.pool_failovers);
+  MetricsHeader(out, "pool_redirects_total", "counter", "client.reconnect requests followed");
+  MetricsPrint(out, "nerdminer_pool_redirects_total %u\n", m.pool_redirects);
+  MetricsHeader(out, "pool_downtime_seconds_total", "counter", "Time without a pool connection");
+  MetricsPrint(out, "nerdminer_pool_downtime_seconds_total %.3f\n", m.pool_downtime_ms / 1000.0);
+
+  //Bucket n of the histogram ends at 2^n us, the last one is +Inf
+  MetricsHeader(out, "latency_seconds", "histogram", "Stratum task latencies, job switch stages and message handling");
+  for (int l = 0; l < METRICS_LATENCIES; ++l)
+  {
+    const latency_histogram& h = m.latency[l];
+    uint32_t count = 0;
+    for (int i = 0; i < LATENCY_BUCKETS - 1; ++i)
+    {
+      count += h.count[i];
+      MetricsPrint(out, "nerdminer_latency_seconds_bucket{stage=\"%s\",le=\"%g\"} %u\n", s_latency_names[l], (1u << i) / 1e6, count);
+    }
+    MetricsPrint(out, "nerdminer_latency_seconds_bucket{stage=\"%s\",le=\"+Inf\"} %u\n", s_latency_names[l], h.samples);
+    MetricsPrint(out, "nerdminer_latency_seconds_sum{stage=\"%s\"} %.6f\n", s_latency_names[l], h.total_us / 1e6);
+    MetricsPrint(out, "nerdminer_latency_seconds_count{stage=\"%s\"} %u\n", s_latency_names[l], h.samples);
+  }
+
+  MetricsHeader(out, "heap_free_bytes", "gauge", "Free internal heap");
+  MetricsPrint(out, "nerdminer_heap_free_bytes %u\n", (unsigned)heap_caps_get_free_size(MALLOC_CAP_INTERNAL));
+  MetricsHeader(out, "heap_min_free_bytes", "gauge", "Lowest free internal heap since boot");
+  MetricsPrint(out, "nerdminer_heap_min_free_bytes %u\n", (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL));
+  MetricsHeader(out, "heap_largest_free_block_bytes", "gauge", "Largest free internal heap block");
+  MetricsPrint(out, "nerdminer_heap_largest_free_block_bytes %u\n", (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL));
+#ifndef NERDMINER_HOST
+  MetricsHeader(out, "temperature_celsius", "gauge", "Chip temperature");
+  MetricsPrint(out, "nerdminer_temperature_celsius %.1f\n", temperatureRead());
+#endif
+  MetricsHeader(out, "uptime_seconds", "counter", "Time since boot");
+  MetricsPrint(out, "nerdminer_uptime_seconds %llu\n", (unsigned long long)(esp_timer_get_time() / 1000000));
+}
+
+#ifdef HASHRATE_HISTORY
+static void MetricsHistoryLine(const char* text, void* context)
+{
+  MetricsPrint(*(metrics_output*)context, "%s\n", text);
+}
+#endif
+
+static void MetricsServe(WiFiClient& client, uint32_t& last_scrape)
+{
+  client.setTimeout(1);
+  String request = client.readStringUntil('\n');
+  //Headers are not used, read them so the close is clean
+  while (client.connected())
+  {
+    String header = client.readStringUntil('\n');
+    if (header.length() <= 1)
+      break;
+  }
+
+#ifdef HASHRATE_HISTORY
+  //GET /history?s|m|q, the 1s archive without a query
+  int history = -1;
+  if (request.startsWith("GET /history"))
+  {
+    int end = request.indexOf(' ', 4);
+    String query = request.substring(12, end < 0 ? request.length() : end);
+    history = history_archive_from(query.startsWith("?") ? query.c_str() + 1 : "s");
+  }
+  if (history < 0 && !request.startsWith("GET /metrics"))
+#else
+  if (!request.startsWith("GET /metrics"))
+#endif
+  {
+    client.print("HTTP/1.1 404 Not Found\r\nContent-Type: text/plain\r\nConnection: close\r\n\r\nTry /metrics\n");
+    return;
+  }
+  uint32_t since = millis() - last_scrape;
+  if (last_scrape != 0 && since < METRICS_MIN_INTERVAL_ms)
+  {
+    char response[128];
+    snprintf(response, sizeof(response), "HTTP/1.1 429 Too Many Requests\r\nRetry-After: %u\r\nConnection: close\r\n\r\n",
+             (unsigned)((METRICS_MIN_INTERVAL_ms - since + 999) / 1000));
+    client.print(response);
+    return;
+  }
+  last_scrape = millis();
+  if (last_scrape == 0)
+    last_scrape = 1;
+
+  static metrics_output out;
+  out.client = &client;
+  out.length = 0;
+#ifdef HASHRATE_HISTORY
+  if (history >= 0)
+  {
+    MetricsPrint(out, "HTTP/1.1 200 OK\r\nContent-Type: text/csv\r\nConnection: close\r\n\r\n");
+    history_csv(history, MetricsHistoryLine, &out);
+    MetricsFlush(out);
+    return;
+  }
+#endif
+
+  static mining_metrics metrics;
+  {
+    std::lock_guard<std::mutex> lock(s_metrics_mutex);
+    if (!s_has_metrics)
+    {
+      client.print("HTTP/1.1 503 Service Unavailable\r\nRetry-After: 1\r\nConnection: close\r\n\r\n");
+      return;
+    }
+    metrics = s_published;
+  }
+
+  MetricsPrint(out, "HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nConnection: close\r\n\r\n");
+  MetricsWrite(out, metrics);
+  MetricsFlush(out);
+}
+
+static void MetricsTask(void* param)
+{
+  WiFiServer* server = NULL;
+  uint32_t last_scrape = 0;
+  while (true)
+  {
+    vTaskDelay(METRICS_POLL_ms / portTICK_PERIOD_MS);
+    if (server == NULL)
+    {
+      if (WiFi.status() != WL_CONNECTED)
+        continue;
+      server = new WiFiServer(s_port);
+      server->begin();
+      LOG_I("[METRICS] Serving http://%s:%d/metrics\n", WiFi.localIP().toString().c_str(), s_port);
+    }
+    WiFiClient client = server->available();
+    if (client)
+    {
+      MetricsServe(client, last_scrape);
+      client.stop();
+    }
+  }
+}
+
+void metrics_setup(uint16_t port)
+{
+  s_port = port;
+  //Lowest priority with the software miners, formatting happens in scraping time slices
+  if (xTaskCreate(MetricsTask, "Metrics", 4096, NULL, 1, NULL) != pdPASS)
+  {
+    Serial.println("Metrics server not started");
+    s_port = 0;
+  }
+}
+
+bool metrics_enabled(void)
+{
+  return s_port != 0;
+}
+
+void metrics_publish(const mining_metrics& metrics)
+{
+  std::lock_guard<std::mutex> lock(s_metrics_mutex);
+  s_published = metrics;
+  s_has_metrics = true;
+}
@@ -0,0 +1,73 @@
+#ifndef METRICS_SERVER_H
+#define METRICS_SERVER_H
+
+#include <Arduino.h>
+#include "mining.h"
+#include "stratum.h"
+
+/************************************************************************************
+*   Prometheus /metrics endpoint, telemetry of the headless boards.
+*
+*   The stratum task copies its totals here every METRICS_PUBLISH_ms. A low priority
+*   task polls the listening socket and answers GET /metrics in the Prometheus text
+*   format from that copy: it never touches the mining state and serves at most one
+*   scrape per METRICS_MIN_INTERVAL_ms, faster scrapers get 429.
+*
+*   With HASHRATE_HISTORY, GET /history?s|m|q serves the hashrate history as CSV.
+*
+*   Device: build with -D METRICS_PORT=9100
+*   Host:   program --pool <pool:port> --wallet <address> --metrics 9100
+*************************************************************************************/
+
+#define METRICS_PUBLISH_ms        1000
+#define METRICS_POLL_ms           250
+#ifndef METRICS_MIN_INTERVAL_ms
+#define METRICS_MIN_INTERVAL_ms   5000
+#endif
+
+//Latency histograms of the stratum task
+enum {
+  METRICS_SWITCH_PARSE = 0,
+  METRICS_SWITCH_BUILD,
+  METRICS_SWITCH_PUBLISH,
+  METRICS_DISPATCH,
+  METRICS_DISPATCH_ALL,
+  METRICS_RESULT,
+  METRICS_PARSE,
+  METRICS_BUILD,
+  METRICS_LATENCIES
+};
+
+typedef struct {
+  uint64_t worker_hashes[MINING_WORKERS];
+  const char* worker_names[MINING_WORKERS];
+  double pool_difficulty;
+  double best_diff;
+  uint32_t shares_submitted;
+  uint32_t shares_accepted;
+  uint32_t shares_rejected;
+  uint32_t shares_rejected_by[SHARE_REJECT_REASONS];
+  uint32_t shares_stale;        //Answered after the pool moved to a new block
+  uint32_t shares_lost;         //No answer: timed out, or the connection went away
+  uint32_t shares_answered_late; //Answers to shares already counted lost
+  double difficulty_submitted;
+  double difficulty_accepted;
+  uint32_t shares_32bit;
+  uint32_t blocks;
+  uint32_t job_switches;
+  uint64_t stale_nonces;
+  uint32_t pool_disconnects;
+  uint32_t pool_failovers;
+  uint32_t pool_redirects;      //client.reconnect
+  uint64_t pool_downtime_ms;
+  latency_histogram latency[METRICS_LATENCIES];
+  latency_histogram share_rtt;  //Submit to the pool answer, in ms: bucket n ends at 2^n ms
+} mining_metrics;
+
+void metrics_setup(uint16_t port);
+bool metrics_enabled(void);
+
+//Totals since boot, from the stratum task
+void metrics_publish(const mining_metrics& metrics);
+
+#endif // METRICS_SERVER_H
@@ -10,12 +10,84 @@
 #define KEEPALIVE_TIME_ms       30000
 #define POOLINACTIVITY_TIME_ms  60000
 
+// Stratum task, sleeps in select() until the pool or a miner has something
+#define STRATUM_IDLE_ms             1000    //Longest wait, keepalive and failover checks run at least this often
+#define STRATUM_POLL_ms             50      //Wait when results can't wake the task (no eventfd, proxy clients)
+#define STRATUM_LATENCY_STATS_ms    60000
+
+// Shares waiting for the pool answer
+#define SUBMIT_PENDING_MAX          32
+#define SUBMIT_TIMEOUT_ms           60000   //Unanswered this long, counted lost
+
+// Suggested difficulty, from the measured hashrate
+#ifndef SUGGEST_SHARES_PER_MINUTE
+#define SUGGEST_SHARES_PER_MINUTE   4
+#endif
+#define SUGGEST_PERIOD_ms           60000
+#define SUGGEST_HYSTERESIS          0.25    //Re-suggest when the target moves more than 25%
+
+// Pool failover
+#define MAX_POOLS               4           //Settings.PoolAddress + backups
+#define POOL_STANDBY_RETRY_ms   30000       //Wait between standby connection attempts
+//StandbyTask stack, deepest chain by -fstack-usage: tx_mining_subscribe 1.2KB, parse_mining_subscribe
+//0.5KB, checkError 0.4KB, logger_write 0.8KB, plus printf and lwIP. DEBUG_MEMORY logs what is left.
+#define POOL_STANDBY_STACK      8192
+#define POOL_FAILBACK_ms        (2*60*1000) //Primary stable this long before moving back, 0 never fails back
+
 //#if defined(CONFIG_IDF_TARGET_ESP32S2) || defined(CONFIG_IDF_TARGET_ESP32S3) || defined(CONFIG_IDF_TARGET_ESP32C3)
+#ifndef NERDMINER_HOST
 #define HARDWARE_SHA265
+#endif
 //#endif
 
 #define TARGET_BUFFER_SIZE 64
 
+#define LATENCY_BUCKETS 16  //Bucket n counts [2^(n-1), 2^n) us, the last one everything over 16ms
+
+#define MINING_WORKERS  8   //Miner tasks with their own hash counter
+
+//SHA engine of a miner
+enum {
+  ENGINE_SOFTWARE = 0,
+  ENGINE_HARDWARE,
+  ENGINE_I2C,           //Slaves on the I2C bus
+  ENGINES
+};
+
+typedef struct {
+  const char* name;
+  uint8_t engine;
+  uint32_t hashes;      //Wraps around, for the rates
+} mining_worker;
+
+//Miners and their hashes so far, returns how many
+int mining_workers(mining_worker* workers);
+
+//Totals of the stratum task, copied out every loop turn. Read them with
+//mining_counters_get() from the other tasks: the globals change under them
+//(hashes rolls into Mhashes, best_diff is two words).
+typedef struct {
+  uint32_t hashes;            //Under a million, the rest is in Mhashes
+  uint32_t Mhashes;
+  uint32_t templates;
+  uint32_t shares;            //32 bit shares
+  uint32_t valids;
+  uint32_t shares_accepted;
+  uint32_t pool_incidents;
+  uint64_t pool_downtime_ms;
+  double best_diff;
+  double pool_difficulty;
+} mining_counters;
+
+mining_counters mining_counters_get(void);
+
+typedef struct {
+  uint32_t count[LATENCY_BUCKETS];
+  uint32_t samples;
+  uint32_t max_us;
+  uint64_t total_us;
+} latency_histogram;
+
 void runMonitor(void *name);
 
 void runStratumWorker(void *name);
@@ -4,25 +4,18 @@
 #include "HTTPClient.h"
 #include <NTPClient.h>
 #include <WiFiUdp.h>
-#include <list>
 #include "mining.h"
 #include "utils.h"
 #include "monitor.h"
+#include "hashrateStats.h"
+#include "nonceCoverage.h"
+#include "eventTrace.h"
 #include "drivers/storage/storage.h"
 #include "drivers/devices/device.h"
 
-extern uint32_t templates;
-extern uint32_t hashes;
-extern uint32_t Mhashes;
 extern uint32_t totalKHashes;
-extern uint32_t elapsedKHs;
 extern uint64_t upTime;
 
-extern uint32_t shares; // increase if blockhash has 32 bits of zeroes
-extern uint32_t valids; // increased if blockhash <= targethalfshares
-
-extern double best_diff; // track best diff
-
 extern monitor_data mMonitor;
 
 //from saved config
@@ -32,7 +25,7 @@ bool invertColors = false;
 WiFiUDP ntpUDP;
 NTPClient timeClient(ntpUDP, "europe.pool.ntp.org", 3600, 60000);
 unsigned int bitcoin_price=0;
-String current_block = "793261";
+char current_block[12] = "793261";
 global_data gData;
 pool_data pData;
 String poolAPIUrl;
@@ -67,7 +60,9 @@ void updateGlobalData(void){
         http.setTimeout(10000);
         try {
         http.begin(getGlobalHash);
+        TRACE_BEGIN("http global hash");
         int httpCode = http.GET();
+        TRACE_END("http global hash");
 
         if (httpCode == HTTP_CODE_OK) {
             String payload = http.getString();
@@ -77,11 +72,11 @@ void updateGlobalData(void){
             String temp = "";
             if (doc.containsKey("currentHashrate")) temp = String(doc["currentHashrate"].as<float>());
             if(temp.length()>18 + 3) //Exahashes more than 18 digits + 3 digits decimals
-              gData.globalHash = temp.substring(0,temp.length()-18 - 3);
+              gData.globalHash = temp.substring(0,temp.length()-18 - 3).c_str();
             if (doc.containsKey("currentDifficulty")) temp = String(doc["currentDifficulty"].as<float>());
             if(temp.length()>10 + 3){ //Terahash more than 10 digits + 3 digit decimals
               temp = temp.substring(0,temp.length()-10 - 3);
-              gData.difficulty = temp.substring(0,temp.length()-2) + "." + temp.substring(temp.length()-2,temp.length()) + "T";
+              gData.difficulty.format("%s.%sT", temp.substring(0,temp.length()-2).c_str(), temp.substring(temp.length()-2,temp.length()).c_str());
             }
             doc.clear();
 
@@ -92,7 +87,9 @@ void updateGlobalData(void){
       
         //Make third API call to get fees
         http.begin(getFees);
+        TRACE_BEGIN("http fees");
         httpCode = http.GET();
+        TRACE_END("http fees");
 
         if (httpCode == HTTP_CODE_OK) {
             String payload = http.getString();
@@ -122,7 +119,7 @@ void updateGlobalData(void){
 
 unsigned long mHeightUpdate = 0;
 
-String getBlockHeight(void){
+const char* getBlockHeight(void){
     
     if((mHeightUpdate == 0) || (millis() - mHeightUpdate > UPDATE_Height_min * 60 * 1000)){
     
@@ -132,13 +129,15 @@ String getBlockHeight(void){
         http.setTimeout(10000);
         try {
         http.begin(getHeightAPI);
+        TRACE_BEGIN("http height");
         int httpCode = http.GET();
+        TRACE_END("http height");
 
         if (httpCode == HTTP_CODE_OK) {
             String payload = http.getString();
             payload.trim();
 
-            current_block = payload;
+            snprintf(current_block, sizeof(current_block), "%s", payload.c_str());
 
             mHeightUpdate = millis();
         }        
@@ -154,14 +153,14 @@ String getBlockHeight(void){
 
 unsigned long mBTCUpdate = 0;
 
-String getBTCprice(void){
+const char* getBTCprice(void){
+    static char price_buffer[16];
     
     if((mBTCUpdate == 0) || (millis() - mBTCUpdate > UPDATE_BTC_min * 60 * 1000)){
     
         if (WiFi.status() != WL_CONNECTED) {
-            static char price_buffer[16];
             snprintf(price_buffer, sizeof(price_buffer), "$%u", bitcoin_price);
-            return String(price_buffer);
+            return price_buffer;
         }
         
         HTTPClient http;
@@ -170,7 +169,9 @@ String getBTCprice(void){
 
         try {
         http.begin(getBTCAPI);
+        TRACE_BEGIN("http btc price");
         int httpCode = http.GET();
+        TRACE_END("http btc price");
 
         if (httpCode == HTTP_CODE_OK) {
             String payload = http.getString();
@@ -194,9 +195,8 @@ String getBTCprice(void){
         }
     }  
   
-  static char price_buffer[16];
   snprintf(price_buffer, sizeof(price_buffer), "$%u", bitcoin_price);
-  return String(price_buffer);
+  return price_buffer;
 }
 
 unsigned long mTriggerUpdate = 0;
@@ -224,7 +224,7 @@ void getTime(unsigned long* currentHours, unsigned long* currentMinutes, unsigne
   *currentSeconds = currentTime % 60;
 }
 
-String getDate(){
+const char* getDate(){
   
   unsigned long elapsedTime = (millis() - mTriggerUpdate) / 1000; // Tiempo transcurrido en segundos
   unsigned long currentTime = initialTime + elapsedTime; // La hora actual
@@ -236,96 +236,39 @@ String getDate(){
   int month = tm->tm_mon + 1;    // tm_mon es el mes del año desde 0 (enero) hasta 11 (diciembre)
   int day = tm->tm_mday;         // tm_mday es el día del mes
 
-  char currentDate[20];
+  static char currentDate[20];
   sprintf(currentDate, "%02d/%02d/%04d", tm->tm_mday, tm->tm_mon + 1, tm->tm_year + 1900);
 
-  return String(currentDate);
+  return currentDate;
 }
 
-String getTime(void){
+const char* getTime(void){
   unsigned long currentHours, currentMinutes, currentSeconds;
   getTime(&currentHours, &currentMinutes, &currentSeconds);
 
-  char LocalHour[10];
-  sprintf(LocalHour, "%02d:%02d", currentHours, currentMinutes);
-  
-  String mystring(LocalHour);
+  static char LocalHour[10];
+  sprintf(LocalHour, "%02lu:%02lu", currentHours, currentMinutes);
   return LocalHour;
 }
 
-enum EHashRateScale
-{
-  HashRateScale_99KH,
-  HashRateScale_999KH,
-  HashRateScale_9MH
-};
-
-static EHashRateScale s_hashrate_scale = HashRateScale_99KH;
-static uint32_t s_skip_first = 3;
-static double s_top_hashrate = 0.0;
-
-static std::list<double> s_hashrate_avg_list;
-static double s_hashrate_summ = 0.0;
-static uint8_t s_hashrate_recalc = 0;
-
-String getCurrentHashRate(unsigned long mElapsed)
+//Average of the last ticks, as precise as the top hashrate allows
+void getCurrentHashRate(monitor_text<16>& text)
 {
-  double hashrate = (double)elapsedKHs * 1000.0 / (double)mElapsed;
-
-  s_hashrate_summ += hashrate;
-  s_hashrate_avg_list.push_back(hashrate);
-  if (s_hashrate_avg_list.size() > 10)
-  {
-    s_hashrate_summ -= s_hashrate_avg_list.front();
-    s_hashrate_avg_list.pop_front();
-  }
-
-  ++s_hashrate_recalc;
-  if (s_hashrate_recalc == 0)
-  {
-    s_hashrate_summ = 0.0;
-    for (auto itt = s_hashrate_avg_list.begin(); itt != s_hashrate_avg_list.end(); ++itt)
-      s_hashrate_summ += *itt;
-  }
-
-  double avg_hashrate = s_hashrate_summ / (double)s_hashrate_avg_list.size();
-  if (avg_hashrate < 0.0)
-    avg_hashrate = 0.0;
-
-  if (s_skip_first > 0)
-  {
-    s_skip_first--;
-  } else
-  {
-    if (avg_hashrate > s_top_hashrate)
-    {
-      s_top_hashrate = avg_hashrate;
-      if (avg_hashrate > 999.9)
-        s_hashrate_scale = HashRateScale_9MH;
-      else if (avg_hashrate > 99.9)
-        s_hashrate_scale = HashRateScale_999KH;
-    }
-  }
-
-  switch (s_hashrate_scale)
-  {
-    case HashRateScale_99KH:
-      return String(avg_hashrate, 2);
-    case HashRateScale_999KH:
-      return String(avg_hashrate, 1);
-    default:
-      return String((int)avg_hashrate );
-  }
+  const hashrate_stats& stats = hashrate_stats_get();
+  if (stats.decimals == 0)
+    text.format("%d", (int)stats.current);
+  else
+    text.format("%.*f", (int)stats.decimals, stats.current);
 }
 
 mining_data getMiningData(unsigned long mElapsed)
 {
-  mining_data data;
+  mining_data data = {};
+  mining_counters counters = mining_counters_get();
 
   char best_diff_string[16] = {0};
-  suffix_string(best_diff, best_diff_string, 16, 0);
+  suffix_string(counters.best_diff, best_diff_string, 16, 0);
 
-  char timeMining[15] = {0};
   uint64_t tm = upTime;
   int secs = tm % 60;
   tm /= 60;
@@ -333,29 +276,34 @@ mining_data getMiningData(unsigned long mElapsed)
   tm /= 60;
   int hours = tm % 24;
   int days = tm / 24;
-  sprintf(timeMining, "%01d  %02d:%02d:%02d", days, hours, mins, secs);
+  data.timeMining.format("%01d  %02d:%02d:%02d", days, hours, mins, secs);
 
-  data.completedShares = shares;
-  data.totalMHashes = Mhashes;
-  data.totalKHashes = totalKHashes;
-  data.currentHashRate = getCurrentHashRate(mElapsed);
-  data.templates = templates;
+  data.completedShares.format("%u", counters.shares);
+  data.totalMHashes.format("%u", counters.Mhashes);
+  data.totalKHashes.format("%u", totalKHashes);
+  getCurrentHashRate(data.currentHashRate);
+  data.templates.format("%u", counters.templates);
   data.bestDiff = best_diff_string;
-  data.timeMining = timeMining;
-  data.valids = valids;
-  data.temp = String(temperatureRead(), 0);
+  data.valids.format("%u", counters.valids);
+  data.temp.format("%.0f", temperatureRead());
   data.currentTime = getTime();
+  data.poolIncidents.format("%u", counters.pool_incidents);
+  data.poolDowntime.format("%u", (uint32_t)(counters.pool_downtime_ms / 1000));
+#ifdef NONCE_COVERAGE
+  nonce_coverage_summary(data.nonceCoverage.text, sizeof(data.nonceCoverage.text));
+#endif
 
   return data;
 }
 
 clock_data getClockData(unsigned long mElapsed)
 {
-  clock_data data;
+  clock_data data = {};
+  mining_counters counters = mining_counters_get();
 
-  data.completedShares = shares;
-  data.totalKHashes = totalKHashes;
-  data.currentHashRate = getCurrentHashRate(mElapsed);
+  data.completedShares.format("%u", counters.shares);
+  data.totalKHashes.format("%u", totalKHashes);
+  getCurrentHashRate(data.currentHashRate);
   data.btcPrice = getBTCprice();
   data.blockHeight = getBlockHeight();
   data.currentTime = getTime();
@@ -366,10 +314,10 @@ clock_data getClockData(unsigned long mElapsed)
 
 clock_data_t getClockData_t(unsigned long mElapsed)
 {
-  clock_data_t data;
+  clock_data_t data = {};
 
-  data.valids = valids;
-  data.currentHashRate = getCurrentHashRate(mElapsed);
+  data.valids.format("%u", mining_counters_get().valids);
+  getCurrentHashRate(data.currentHashRate);
   getTime(&data.currentHours, &data.currentMinutes, &data.currentSeconds);
 
   return data;
@@ -377,22 +325,23 @@ clock_data_t getClockData_t(unsigned long mElapsed)
 
 coin_data getCoinData(unsigned long mElapsed)
 {
-  coin_data data;
+  coin_data data = {};
+  mining_counters counters = mining_counters_get();
 
   updateGlobalData(); // Update gData vars asking mempool APIs
 
-  data.completedShares = shares;
-  data.totalKHashes = totalKHashes;
-  data.currentHashRate = getCurrentHashRate(mElapsed);
+  data.completedShares.format("%u", counters.shares);
+  data.totalKHashes.format("%u", totalKHashes);
+  getCurrentHashRate(data.currentHashRate);
   data.btcPrice = getBTCprice();
   data.currentTime = getTime();
 #ifdef SCREEN_FEES_ENABLE
-  data.hourFee = String(gData.hourFee);
-  data.fastestFee = String(gData.fastestFee);
-  data.economyFee = String(gData.economyFee);
-  data.minimumFee = String(gData.minimumFee);
+  data.hourFee.format("%d", gData.hourFee);
+  data.fastestFee.format("%d", gData.fastestFee);
+  data.economyFee.format("%d", gData.economyFee);
+  data.minimumFee.format("%d", gData.minimumFee);
 #endif
-  data.halfHourFee = String(gData.halfHourFee) + " sat/vB";
+  data.halfHourFee.format("%d sat/vB", gData.halfHourFee);
   data.netwrokDifficulty = gData.difficulty;
   data.globalHashRate = gData.globalHash;
   data.blockHeight = getBlockHeight();
@@ -400,7 +349,7 @@ coin_data getCoinData(unsigned long mElapsed)
   unsigned long currentBlock = data.blockHeight.toInt();
   unsigned long remainingBlocks = (((currentBlock / HALVING_BLOCKS) + 1) * HALVING_BLOCKS) - currentBlock;
   data.progressPercent = (HALVING_BLOCKS - remainingBlocks) * 100 / HALVING_BLOCKS;
-  data.remainingBlocks = String(remainingBlocks) + " BLOCKS";
+  data.remainingBlocks.format("%lu BLOCKS", remainingBlocks);
 
   return data;
 }
@@ -453,7 +402,9 @@ pool_data getPoolData(void){
 #else
           http.begin(String(getPublicPool)+btcWallet);
 #endif
+          TRACE_BEGIN("http pool");
           int httpCode = http.GET();
+          TRACE_END("http pool");
           if (httpCode == HTTP_CODE_OK) {
               String payload = http.getString();
               // Serial.println(payload);
@@ -476,14 +427,14 @@ pool_data getPoolData(void){
               }
               char totalhashs_s[16] = {0};
               suffix_string(totalhashs, totalhashs_s, 16, 0);
-              pData.workersHash = String(totalhashs_s);
+              pData.workersHash = totalhashs_s;
 
               double temp;
               if (doc.containsKey("bestDifficulty")) {
               temp = doc["bestDifficulty"].as<double>();            
               char best_diff_string[16] = {0};
               suffix_string(temp, best_diff_string, 16, 0);
-              pData.bestDifficulty = String(best_diff_string);
+              pData.bestDifficulty = best_diff_string;
               }
               doc.clear();
               mPoolUpdate = millis();
@@ -2,6 +2,7 @@
 #define MONITOR_API_H
 
 #include <Arduino.h>
+#include <stdarg.h>
 
 // Monitor states
 #define SCREEN_MINING   0
@@ -50,11 +51,29 @@ typedef struct{
   NMState NerdStatus;
 }monitor_data;
 
+//Text of the screen snapshots below: a char buffer in the struct, building or
+//copying a snapshot doesn't allocate. Reads like the String it replaces.
+template <size_t N>
+struct monitor_text {
+  char text[N];
+
+  const char* c_str() const { return text; }
+  operator const char*() const { return text; }
+  size_t length() const { return strlen(text); }
+  long toInt() const { return atol(text); }
+  monitor_text& operator=(const char* value) { snprintf(text, N, "%s", value); return *this; }
+  void format(const char* pattern, ...) __attribute__((format(printf, 2, 3)))
+  {
+    va_list args;
+    va_start(args, pattern);
+    vsnprintf(text, N, pattern, args);
+    va_end(args);
+  }
+};
+
 typedef struct{
-  String globalHash; //hexahashes
-  String currentBlock;
-  String difficulty;
-  String blocksHalving;
+  monitor_text<16> globalHash; //hexahashes
+  monitor_text<16> difficulty;
   float progressPercent;
   int remainingBlocks;
   int halfHourFee;
@@ -67,60 +86,63 @@ typedef struct{
 }global_data;
 
 typedef struct {
-  String completedShares;
-  String totalMHashes;
-  String totalKHashes;
-  String currentHashRate;
-  String templates;
-  String bestDiff;
-  String timeMining;
-  String valids;
-  String temp;
-  String currentTime;
+  monitor_text<12> completedShares;
+  monitor_text<12> totalMHashes;
+  monitor_text<16> totalKHashes;
+  monitor_text<16> currentHashRate;
+  monitor_text<12> templates;
+  monitor_text<16> bestDiff;
+  monitor_text<20> timeMining;
+  monitor_text<12> valids;
+  monitor_text<8> temp;
+  monitor_text<8> currentTime;
+  monitor_text<12> poolIncidents;
+  monitor_text<12> poolDowntime;    //total seconds without a pool job
+  monitor_text<48> nonceCoverage;   //searched / overlap / abandoned % of the nonces handed out, NONCE_COVERAGE builds
 }mining_data;
 
 typedef struct {
-  String completedShares;
-  String totalKHashes;
-  String currentHashRate;
-  String btcPrice;
-  String blockHeight;
-  String currentTime;  
-  String currentDate;
+  monitor_text<12> completedShares;
+  monitor_text<16> totalKHashes;
+  monitor_text<16> currentHashRate;
+  monitor_text<16> btcPrice;
+  monitor_text<12> blockHeight;
+  monitor_text<8> currentTime;
+  monitor_text<12> currentDate;
 }clock_data;
 
 typedef struct {
-  String currentHashRate;
-  String valids;
+  monitor_text<16> currentHashRate;
+  monitor_text<12> valids;
   unsigned long currentHours;
   unsigned long currentMinutes;
   unsigned long currentSeconds;
 }clock_data_t;
 
 typedef struct {
-  String completedShares;
-  String totalKHashes;
-  String currentHashRate;
-  String btcPrice;
-  String currentTime;
-  String halfHourFee;
+  monitor_text<12> completedShares;
+  monitor_text<16> totalKHashes;
+  monitor_text<16> currentHashRate;
+  monitor_text<16> btcPrice;
+  monitor_text<8> currentTime;
+  monitor_text<16> halfHourFee;
 #ifdef NERDMINER_T_HMI
-  String hourFee;
-  String fastestFee;
-  String economyFee;
-  String minimumFee;
+  monitor_text<8> hourFee;
+  monitor_text<8> fastestFee;
+  monitor_text<8> economyFee;
+  monitor_text<8> minimumFee;
 #endif
-  String netwrokDifficulty;
-  String globalHashRate;
-  String blockHeight;
+  monitor_text<16> netwrokDifficulty;
+  monitor_text<16> globalHashRate;
+  monitor_text<12> blockHeight;
   float progressPercent;
-  String remainingBlocks;
+  monitor_text<20> remainingBlocks;
 }coin_data;
 
 typedef struct{
   int workersCount;       // Workers count, how many nerdminers using your address
-  String workersHash;     // Workers Total Hash Rate
-  String bestDifficulty;  // Your miners best difficulty
+  monitor_text<16> workersHash;     // Workers Total Hash Rate
+  monitor_text<16> bestDifficulty;  // Your miners best difficulty
 }pool_data;
 
 void setup_monitor(void);
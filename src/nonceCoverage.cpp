@@ -0,0 +1,141 @@
+#ifdef NONCE_COVERAGE
+
+#include <Arduino.h>
+#include "nonceCoverage.h"
+
+//Nonce ranges of one job: disjoint, not touching, sorted. Position is version bits << 32 | nonce.
+typedef struct {
+  uint64_t start;
+  uint64_t end;
+} nonce_interval;
+
+typedef struct {
+  bool active;
+  uint32_t job_id;
+  nonce_interval intervals[NONCE_COVERAGE_INTERVALS];
+  int count;
+  nonce_coverage_stats stats;
+} nonce_coverage_job;
+
+nonce_coverage_stats nonce_coverage_total = { 0 };
+
+//Only the stratum task calls in, no locking
+static nonce_coverage_job s_current = { false };
+static nonce_coverage_job s_previous = { false };
+
+static nonce_coverage_job* CoverageJob(uint32_t job_id)
+{
+  if (s_current.active && s_current.job_id == job_id)
+    return &s_current;
+  if (s_previous.active && s_previous.job_id == job_id)
+    return &s_previous;
+  return NULL;
+}
+
+static inline double Percent(uint64_t part, uint64_t whole)
+{
+  return whole ? 100.0 * part / whole : 0.0;
+}
+
+//Distinct nonces of [start, end) not in the set yet, the set then covers it
+static uint64_t CoverageInsert(nonce_coverage_job& job, uint64_t start, uint64_t end)
+{
+  //Intervals touching [start, end): first..last-1
+  int first = 0;
+  while (first < job.count && job.intervals[first].end < start)
+    first++;
+  int last = first;
+  uint64_t known = 0;
+  while (last < job.count && job.intervals[last].start <= end)
+  {
+    uint64_t lo = job.intervals[last].start > start ? job.intervals[last].start : start;
+    uint64_t hi = job.intervals[last].end < end ? job.intervals[last].end : end;
+    if (hi > lo)
+      known += hi - lo;
+    last++;
+  }
+
+  if (first == last && job.count == NONCE_COVERAGE_INTERVALS)
+  {
+    job.stats.untracked += end - start;
+    return end - start;
+  }
+
+  nonce_interval merged = { start, end };
+  if (first < last)
+  {
+    if (job.intervals[first].start < merged.start)
+      merged.start = job.intervals[first].start;
+    if (job.intervals[last - 1].end > merged.end)
+      merged.end = job.intervals[last - 1].end;
+  }
+  //Replace first..last-1 by the merged one
+  int removed = last - first;
+  memmove(&job.intervals[first + 1], &job.intervals[last], (job.count - last) * sizeof(nonce_interval));
+  job.intervals[first] = merged;
+  job.count += 1 - removed;
+  return (end - start) - known;
+}
+
+static void CoverageReport(const nonce_coverage_job& job)
+{
+  const nonce_coverage_stats& s = job.stats;
+  if (s.handed == 0)
+    return;
+  Serial.printf("[NONCE] Job %u: %llu nonces handed out, searched %.1f%% | overlap %.2f%% | abandoned %.1f%% (partial %.1f%%, never started %.1f%%) | %d intervals%s\n",
+                job.job_id, s.handed, Percent(s.distinct, s.handed), Percent(s.done - s.distinct, s.done),
+                Percent(s.handed > s.done ? s.handed - s.done : 0, s.handed), Percent(s.started - s.done, s.handed),
+                Percent(s.handed > s.started ? s.handed - s.started : 0, s.handed), job.count, s.untracked ? ", some untracked" : "");
+
+  nonce_coverage_total.handed += s.handed;
+  nonce_coverage_total.started += s.started;
+  nonce_coverage_total.done += s.done;
+  nonce_coverage_total.distinct += s.distinct;
+  nonce_coverage_total.untracked += s.untracked;
+  nonce_coverage_total.jobs++;
+}
+
+void nonce_coverage_switch(uint32_t job_id)
+{
+  if (s_previous.active)
+    CoverageReport(s_previous);
+  s_previous = s_current;
+  memset(&s_current, 0, sizeof(s_current));
+  s_current.active = true;
+  s_current.job_id = job_id;
+}
+
+void nonce_coverage_handed(uint32_t job_id, uint32_t nonce_count)
+{
+  nonce_coverage_job* job = CoverageJob(job_id);
+  if (job != NULL)
+    job->stats.handed += nonce_count;
+}
+
+void nonce_coverage_done(uint32_t job_id, uint32_t version_bits, uint32_t nonce_start, uint32_t nonce_count, uint32_t nonce_total)
+{
+  nonce_coverage_job* job = CoverageJob(job_id);
+  if (job == NULL || nonce_total == 0)
+    return;
+  job->stats.started += nonce_total;
+  job->stats.done += nonce_count;
+
+  //The nonce wraps within the same version
+  uint64_t base = (uint64_t)version_bits << 32;
+  uint64_t end = (uint64_t)nonce_start + nonce_count;
+  if (end > 0x100000000ull)
+  {
+    job->stats.distinct += CoverageInsert(*job, base, base + (end - 0x100000000ull));
+    end = 0x100000000ull;
+  }
+  job->stats.distinct += CoverageInsert(*job, base + nonce_start, base + end);
+}
+
+void nonce_coverage_summary(char* text, size_t size)
+{
+  const nonce_coverage_stats& s = nonce_coverage_total;
+  snprintf(text, size, "%.1f%% / %.2f%% / %.1f%%", Percent(s.distinct, s.handed), Percent(s.done - s.distinct, s.done),
+           Percent(s.handed > s.done ? s.handed - s.done : 0, s.handed));
+}
+
+#endif // NONCE_COVERAGE
@@ -0,0 +1,53 @@
+#ifndef NONCE_COVERAGE_H
+#define NONCE_COVERAGE_H
+
+#include <Arduino.h>
+
+/************************************************************************************
+*   Nonce space coverage of the jobs mined, instrumentation only.
+*
+*   The stratum task hands out nonce ranges to the SW and HW miners and gets back how
+*   many of each they hashed (a job switch stops a range every 256 nonces). Per job:
+*     searched   distinct nonces hashed / nonces handed out
+*     overlap    nonces hashed more than once (RANDOM_NONCE) / nonces hashed
+*     abandoned  nonces handed out but not hashed / nonces handed out: the rest of
+*                ranges stopped by the job switch (partial) and ranges still queued
+*                or whose result was lost (never started)
+*   Ranges are kept as a sorted set of intervals over (version bits, nonce), so the
+*   overlap is exact until NONCE_COVERAGE_INTERVALS disjoint pieces, past that the
+*   ranges are counted as distinct (untracked).
+*
+*   A job is reported one switch late, once the results still in flight came back.
+*
+*   Build with -D NONCE_COVERAGE
+*************************************************************************************/
+
+#ifndef NONCE_COVERAGE_INTERVALS
+#define NONCE_COVERAGE_INTERVALS    64
+#endif
+
+typedef struct {
+  uint64_t handed;
+  uint64_t started;       //Nonces of the ranges with a result
+  uint64_t done;
+  uint64_t distinct;
+  uint64_t untracked;     //Counted in distinct, the interval set was full
+  uint32_t jobs;
+} nonce_coverage_stats;
+
+//Totals of the jobs reported so far
+extern nonce_coverage_stats nonce_coverage_total;
+
+//Job of the stratum task replaced by job_id, reports the job before the previous one
+void nonce_coverage_switch(uint32_t job_id);
+
+//Range handed out to a miner
+void nonce_coverage_handed(uint32_t job_id, uint32_t nonce_count);
+
+//Result of a range: nonce_count of the nonce_total from nonce_start hashed
+void nonce_coverage_done(uint32_t job_id, uint32_t version_bits, uint32_t nonce_start, uint32_t nonce_count, uint32_t nonce_total);
+
+//Searched / overlap / abandoned percentages of the totals
+void nonce_coverage_summary(char* text, size_t size);
+
+#endif // NONCE_COVERAGE_H
@@ -0,0 +1,59 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <string.h>
+#include <type_traits>
+
+/************************************************************************************
+*   Sequence lock of a plain struct: the task owning the values publishes a copy,
+*   any other task reads a consistent one. No mutex and no allocation, the writer
+*   never waits; a reader whose copy overlapped a write takes it again.
+*
+*   One writer task per Seqlock.
+*************************************************************************************/
+
+template <typename T>
+class Seqlock
+{
+  static_assert(std::is_trivially_copyable<T>::value, "Seqlock values are copied with memcpy");
+
+public:
+  void write(const T& value)
+  {
+    uint32_t sequence = _sequence.load(std::memory_order_relaxed);
+    //Odd while the copy is written
+    _sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&_value, &value, sizeof(T));
+    _sequence.store(sequence + 2, std::memory_order_release);
+  }
+
+  T read(void) const
+  {
+    T value;
+    while (true)
+    {
+      uint32_t sequence = _sequence.load(std::memory_order_acquire);
+      if ((sequence & 1) == 0)
+      {
+        memcpy(&value, &_value, sizeof(T));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_sequence.load(std::memory_order_relaxed) == sequence)
+          return value;
+      }
+      //The writer may be a lower priority task on this core, let it finish
+      delay(1);
+    }
+  }
+
+  //Writes so far, a reader can tell whether anything changed
+  uint32_t version(void) const { return _sequence.load(std::memory_order_acquire) / 2; }
+
+private:
+  std::atomic<uint32_t> _sequence{0};
+  T _value{};
+};
+
+#endif // SEQLOCK_H
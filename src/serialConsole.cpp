@@ -0,0 +1,97 @@
+#include <Arduino.h>
+#include "serialConsole.h"
+#include "eventTrace.h"
+#include "taskProfiler.h"
+#include "cycleProfiler.h"
+#include "hashrateStats.h"
+#include "hashrateHistory.h"
+#include "ShaTests/shaBenchmark.h"
+
+#ifdef SERIAL_CONSOLE
+
+typedef struct {
+  const char* name;
+  const char* help;
+  void (*run)(const char* args);
+} console_command;
+
+static void ConsoleHelp(const char* args);
+
+static const console_command s_commands[] = {
+#ifdef TRACE_EVENTS
+  { "trace", "trace [clear]   timeline of the tasks as Chrome trace JSON", trace_command },
+#endif
+#ifdef TASK_PROFILER
+  { "tasks", "tasks           CPU share, min free stack, core and priority of the tasks", profiler_tasks_command },
+  { "heap",  "heap            heap by capability, min free and largest block", profiler_heap_command },
+#endif
+#ifdef CYCLE_PROFILER
+  { "cycles", "cycles [reset]  cycles per hash of each SHA kernel, by core and network traffic", cycles_command },
+#endif
+  { "hashrate", "hashrate        averages, miner tasks and SHA engines", hashrate_stats_command },
+#ifdef HASHRATE_HISTORY
+  { "history", "history [s|m|q] hashrate, shares, difficulty and temperature as CSV", history_command },
+#endif
+#ifdef SHA_BENCHMARK
+  { "bench", "bench [seconds] restart into the SHA benchmark, CSV of every engine and load", sha_benchmark_command },
+#endif
+  { "help",  "help            this list", ConsoleHelp },
+};
+
+static void ConsoleHelp(const char* args)
+{
+  for (const console_command& command : s_commands)
+    Serial.printf("  %s\n", command.help);
+}
+
+static void ConsoleRun(char* line)
+{
+  char* args = line;
+  while (*args && *args != ' ')
+    args++;
+  if (*args)
+    *args++ = 0;
+  while (*args == ' ')
+    args++;
+
+  for (const console_command& command : s_commands)
+  {
+    if (strcmp(command.name, line) == 0)
+    {
+      command.run(args);
+      return;
+    }
+  }
+  Serial.printf("Unknown command %s, try help\n", line);
+}
+
+static void ConsoleTask(void* param)
+{
+  char line[CONSOLE_LINE_SIZE];
+  size_t length = 0;
+  while (true)
+  {
+    while (Serial.available() > 0)
+    {
+      int c = Serial.read();
+      if (c == '\r' || c == '\n')
+      {
+        line[length] = 0;
+        if (length > 0)
+          ConsoleRun(line);
+        length = 0;
+      } else if (c >= 0 && length + 1 < sizeof(line))
+        line[length++] = (char)c;
+    }
+    vTaskDelay(CONSOLE_POLL_ms / portTICK_PERIOD_MS);
+  }
+}
+
+void console_setup(void)
+{
+  //The trace dump formats with snprintf
+  if (xTaskCreate(ConsoleTask, "Console", 4096, NULL, 1, NULL) != pdPASS)
+    Serial.println("Serial console not started");
+}
+
+#endif // SERIAL_CONSOLE
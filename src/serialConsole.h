@@ -0,0 +1,28 @@
+#ifndef SERIAL_CONSOLE_H
+#define SERIAL_CONSOLE_H
+
+#include <Arduino.h>
+
+/************************************************************************************
+*   Serial console of the diagnostics: one command per line on the monitor port,
+*   read by a low priority task. "help" lists the commands of the build.
+*
+*   Built when a diagnostic with a command is (TRACE_EVENTS, TASK_PROFILER,
+*   CYCLE_PROFILER, HASHRATE_HISTORY, SHA_BENCHMARK), or with -D SERIAL_CONSOLE
+*************************************************************************************/
+
+#if (defined(TRACE_EVENTS) || defined(TASK_PROFILER) || defined(CYCLE_PROFILER) || defined(HASHRATE_HISTORY) || defined(SHA_BENCHMARK)) && !defined(SERIAL_CONSOLE)
+#define SERIAL_CONSOLE
+#endif
+
+#ifdef SERIAL_CONSOLE
+
+#define CONSOLE_POLL_ms     100
+#define CONSOLE_LINE_SIZE   64
+
+//Starts the console task
+void console_setup(void);
+
+#endif // SERIAL_CONSOLE
+
+#endif // SERIAL_CONSOLE_H
@@ -9,11 +9,25 @@
 #include "lwip/sockets.h"
 #include "utils.h"
 #include "version.h"
+#include "stratumCapture.h"
+#include "logger.h"
 
 
 
-StaticJsonDocument<BUFFER_JSON_DOC> doc;
-unsigned long id = 1;
+
+//Every pool line goes through these two, for the capture
+static size_t stratum_send(WiFiClient& client, const char* payload)
+{
+    capture_line(client, 't', payload);
+    return client.print(payload);
+}
+
+String stratum_read_line(WiFiClient& client)
+{
+    String line = client.readStringUntil('\n');
+    capture_line(client, 'r', line.c_str());
+    return line;
+}
 
 //Get next JSON RPC Id
 unsigned long getNextId(unsigned long id) {
@@ -33,71 +47,153 @@ bool verifyPayload (String* line){
   
 }
 
-bool checkError(const StaticJsonDocument<BUFFER_JSON_DOC> doc) {
+bool checkError(const StaticJsonDocument<BUFFER_JSON_DOC>& doc) {
   
   if (!doc.containsKey("error")) return false;
   
   if (doc["error"].size() == 0) return false;
 
-  Serial.printf("ERROR: %d | reason: %s \n", (const int) doc["error"][0], (const char*) doc["error"][1]);
+  LOG_E("ERROR: %d | reason: %s \n", (const int) doc["error"][0], (const char*) doc["error"][1]);
 
   return true;  
 }
 
 
+// STEP 0: Version rolling negotiation (CONFIGURE), sent before subscribe
+    // Docs:
+    // - https://github.com/bitcoin/bips/blob/master/bip-0310.mediawiki
+    // - https://github.com/bitcoin/bips/blob/master/bip-0320.mediawiki
+bool tx_mining_configure(WiFiClient& client, stratum_session& session, mining_subscribe& mSubscribe)
+{
+    char payload[BUFFER] = {0};
+
+    // Configure
+    session.id = getNextId(session.id);
+    mSubscribe.version_mask = 0;
+    sprintf(payload, "{\"id\": %u, \"method\": \"mining.configure\", \"params\": [[\"version-rolling\"], {\"version-rolling.mask\": \"%08x\", \"version-rolling.min-bit-count\": %d}]}\n",
+      session.id, VERSION_ROLLING_MASK, VERSION_ROLLING_MIN_BITS);
+
+    LOG_I("[WORKER] ==> Mining configure\n");
+    LOG_I("  Sending  : %s", payload);
+    stratum_send(client, payload);
+
+    vTaskDelay(200 / portTICK_PERIOD_MS); //Small delay
+
+    //Pool can push mining.set_version_mask before the answer, pools without BIP310 may not answer at all
+    for (int n = 0; n < 2; ++n)
+    {
+        String line = stratum_read_line(client);
+        if(!verifyPayload(&line)) break;
+        if (parse_extract_id(session, line) == session.id)
+            return parse_mining_configure(session, line, mSubscribe);
+        if (parse_mining_method(session, line) == MINING_SET_VERSION_MASK)
+            parse_mining_set_version_mask(session, line, mSubscribe.version_mask);
+    }
+    LOG_I("    version rolling not supported by pool\n");
+    return false;
+}
+
+bool parse_mining_configure(stratum_session& session, String line, mining_subscribe& mSubscribe)
+{
+    if(!verifyPayload(&line)) return false;
+    LOG_I("  Receiving: %s\n", line.c_str());
+
+    DeserializationError error = deserializeJson(session.doc, line);
+
+    if (error || checkError(session.doc)) return false;
+    if (!session.doc.containsKey("result")) return false;
+    if (!session.doc["result"]["version-rolling"].as<bool>()) return false;
+
+    const char* mask = session.doc["result"]["version-rolling.mask"];
+    if (mask == NULL) return false;
+    //Never roll bits we didn't ask for
+    mSubscribe.version_mask = strtoul(mask, NULL, 16) & VERSION_ROLLING_MASK;
+    LOG_I("    version_mask: %08x\n", mSubscribe.version_mask);
+
+    return mSubscribe.version_mask != 0;
+}
+
+bool parse_mining_set_version_mask(stratum_session& session, String line, uint32_t& version_mask)
+{
+    LOG_I("    Parsing Method [SET VERSION MASK]\n");
+    if(!verifyPayload(&line)) return false;
+
+    DeserializationError error = deserializeJson(session.doc, line);
+
+    if (error) return false;
+    if (!session.doc.containsKey("params")) return false;
+
+    const char* mask = session.doc["params"][0];
+    if (mask == NULL) return false;
+    version_mask = strtoul(mask, NULL, 16) & VERSION_ROLLING_MASK;
+    LOG_I("    version_mask: %08x\n", version_mask);
+
+    return true;
+}
+
 // STEP 1: Pool server connection (SUBSCRIBE)
     // Docs: 
     // - https://cs.braiins.com/stratum-v1/docs
     // - https://github.com/aeternity/protocol/blob/master/STRATUM.md#mining-subscribe
-bool tx_mining_subscribe(WiFiClient& client, mining_subscribe& mSubscribe)
+bool tx_mining_subscribe(WiFiClient& client, stratum_session& session, mining_subscribe& mSubscribe)
 {
     char payload[BUFFER] = {0};
     
     // Subscribe
-    id = 1; //Initialize id messages
+    session.id = getNextId(session.id);
+    unsigned long subscribe_id = session.id;
     #ifndef HAN
-    sprintf(payload, "{\"id\": %u, \"method\": \"mining.subscribe\", \"params\": [\"NerdMinerV2/%s\"]}\n", id, CURRENT_VERSION);
+    sprintf(payload, "{\"id\": %u, \"method\": \"mining.subscribe\", \"params\": [\"NerdMinerV2/%s\"]}\n", session.id, CURRENT_VERSION);
     #else
-    sprintf(payload, "{\"id\": %u, \"method\": \"mining.subscribe\", \"params\": [\"HAN_SOLOminer/%s\"]}\n", id, CURRENT_VERSION);
+    sprintf(payload, "{\"id\": %u, \"method\": \"mining.subscribe\", \"params\": [\"HAN_SOLOminer/%s\"]}\n", session.id, CURRENT_VERSION);
     #endif
     
-    Serial.printf("[WORKER] ==> Mining subscribe\n");
-    Serial.print("  Sending  : "); Serial.println(payload);
-    client.print(payload);
+    LOG_I("[WORKER] ==> Mining subscribe\n");
+    LOG_I("  Sending  : %s", payload);
+    stratum_send(client, payload);
     
     vTaskDelay(200 / portTICK_PERIOD_MS); //Small delay
     
-    String line = client.readStringUntil('\n');
-    if(!parse_mining_subscribe(line, mSubscribe)) return false;
+    //Skip a late mining.configure answer or a version mask pushed before the subscribe result
+    String line;
+    for (int n = 0; n < 3; ++n)
+    {
+        line = stratum_read_line(client);
+        if (parse_extract_id(session, line) == subscribe_id)
+            break;
+        if (parse_mining_method(session, line) == MINING_SET_VERSION_MASK)
+            parse_mining_set_version_mask(session, line, mSubscribe.version_mask);
+    }
+    if(!parse_mining_subscribe(session, line, mSubscribe)) return false;
 
   
-    Serial.print("    sub_details: "); Serial.println(mSubscribe.sub_details);
-    Serial.print("    extranonce1: "); Serial.println(mSubscribe.extranonce1);
-    Serial.print("    extranonce2_size: "); Serial.println(mSubscribe.extranonce2_size);
+    LOG_I("    sub_details: %s\n", mSubscribe.sub_details.c_str());
+    LOG_I("    extranonce1: %s\n", mSubscribe.extranonce1.c_str());
+    LOG_I("    extranonce2_size: %d\n", mSubscribe.extranonce2_size);
 
     if((mSubscribe.extranonce1.length() == 0) ) { 
-        Serial.printf("[WORKER] >>>>>>>>> Work aborted\n"); 
-        Serial.printf("extranonce1 length: %u \n", mSubscribe.extranonce1.length());
-        doc.clear();
-        doc.garbageCollect();
+        LOG_W("[WORKER] >>>>>>>>> Work aborted\n"); 
+        LOG_W("extranonce1 length: %u \n", mSubscribe.extranonce1.length());
+        session.doc.clear();
+        session.doc.garbageCollect();
         return false; 
     }
     return true;
 }
 
-bool parse_mining_subscribe(String line, mining_subscribe& mSubscribe)
+bool parse_mining_subscribe(stratum_session& session, String line, mining_subscribe& mSubscribe)
 {
     if(!verifyPayload(&line)) return false;
-    Serial.print("  Receiving: "); Serial.println(line);
+    LOG_I("  Receiving: %s\n", line.c_str());
    
-    DeserializationError error = deserializeJson(doc, line);
+    DeserializationError error = deserializeJson(session.doc, line);
 
-    if (error || checkError(doc)) return false;
-    if (!doc.containsKey("result")) return false;
+    if (error || checkError(session.doc)) return false;
+    if (!session.doc.containsKey("result")) return false;
 
-    mSubscribe.sub_details = String((const char*) doc["result"][0][0][1]);
-    mSubscribe.extranonce1 = String((const char*) doc["result"][1]);
-    mSubscribe.extranonce2_size = doc["result"][2];
+    mSubscribe.sub_details = String((const char*) session.doc["result"][0][0][1]);
+    mSubscribe.extranonce1 = String((const char*) session.doc["result"][1]);
+    mSubscribe.extranonce2_size = session.doc["result"][2];
 
     return true;
 }
@@ -109,6 +205,7 @@ mining_subscribe init_mining_subscribe(void)
     new_mSub.extranonce1 = "";
     new_mSub.extranonce2 = "";
     new_mSub.extranonce2_size = 0;
+    new_mSub.version_mask = 0;
     new_mSub.sub_details = "";
 
 
@@ -116,18 +213,18 @@ mining_subscribe init_mining_subscribe(void)
 }
 
 // STEP 2: Pool server auth (authorize)
-bool tx_mining_auth(WiFiClient& client, const char * user, const char * pass)
+bool tx_mining_auth(WiFiClient& client, stratum_session& session, const char * user, const char * pass)
 {
     char payload[BUFFER] = {0};
 
     // Authorize
-    id = getNextId(id);
+    session.id = getNextId(session.id);
     sprintf(payload, "{\"params\": [\"%s\", \"%s\"], \"id\": %u, \"method\": \"mining.authorize\"}\n", 
-      user, pass, id);
+      user, pass, session.id);
     
-    Serial.printf("[WORKER] ==> Autorize work\n");
-    Serial.print("  Sending  : "); Serial.println(payload);
-    client.print(payload);
+    LOG_I("[WORKER] ==> Autorize work\n");
+    LOG_I("  Sending  : %s", payload);
+    stratum_send(client, payload);
 
     vTaskDelay(200 / portTICK_PERIOD_MS); //Small delay
 
@@ -138,134 +235,446 @@ bool tx_mining_auth(WiFiClient& client, const char * user, const char * pass)
 }
 
 
-stratum_method parse_mining_method(String line)
+stratum_method parse_mining_method(stratum_session& session, String line)
 {
     if(!verifyPayload(&line)) return STRATUM_PARSE_ERROR;
-    Serial.print("  Receiving: "); Serial.println(line);
+    LOG_I("  Receiving: %s\n", line.c_str());
     
-    DeserializationError error = deserializeJson(doc, line);
+    DeserializationError error = deserializeJson(session.doc, line);
 
-    if (error || checkError(doc)) return STRATUM_PARSE_ERROR;
+    if (error || checkError(session.doc)) return STRATUM_PARSE_ERROR;
 
-    if (!doc.containsKey("method")) {
+    if (!session.doc.containsKey("method")) {
       // "error":null means success
-      if (doc["error"].isNull())
+      if (session.doc["error"].isNull())
         return STRATUM_SUCCESS;
       else
         return STRATUM_UNKNOWN;
     }
     stratum_method result = STRATUM_UNKNOWN;
 
-    if (strcmp("mining.notify", (const char*) doc["method"]) == 0) {
+    if (strcmp("mining.notify", (const char*) session.doc["method"]) == 0) {
         result = MINING_NOTIFY;
-    } else if (strcmp("mining.set_difficulty", (const char*) doc["method"]) == 0) {
+    } else if (strcmp("mining.set_difficulty", (const char*) session.doc["method"]) == 0) {
         result = MINING_SET_DIFFICULTY;
+    } else if (strcmp("mining.set_version_mask", (const char*) session.doc["method"]) == 0) {
+        result = MINING_SET_VERSION_MASK;
+    } else if (strcmp("mining.set_extranonce", (const char*) session.doc["method"]) == 0) {
+        result = MINING_SET_EXTRANONCE;
+    } else if (strcmp("client.reconnect", (const char*) session.doc["method"]) == 0) {
+        result = CLIENT_RECONNECT;
+    } else if (strcmp("mining.configure", (const char*) session.doc["method"]) == 0) {
+        result = MINING_CONFIGURE;
+    } else if (strcmp("mining.subscribe", (const char*) session.doc["method"]) == 0) {
+        result = MINING_SUBSCRIBE;
+    } else if (strcmp("mining.authorize", (const char*) session.doc["method"]) == 0) {
+        result = MINING_AUTHORIZE;
+    } else if (strcmp("mining.submit", (const char*) session.doc["method"]) == 0) {
+        result = MINING_SUBMIT;
+    } else if (strcmp("mining.suggest_difficulty", (const char*) session.doc["method"]) == 0) {
+        result = MINING_SUGGEST_DIFFICULTY;
+    } else if (strcmp("mining.extranonce.subscribe", (const char*) session.doc["method"]) == 0) {
+        result = MINING_EXTRANONCE_SUBSCRIBE;
     }
 
     return result;
 }
 
-bool parse_mining_notify(String line, mining_job& mJob)
+bool parse_mining_notify(stratum_session& session, String line, mining_job& mJob)
 {
-    Serial.println("    Parsing Method [MINING NOTIFY]");
+    LOG_I("    Parsing Method [MINING NOTIFY]\n");
     if(!verifyPayload(&line)) return false;
    
-    DeserializationError error = deserializeJson(doc, line);
+    DeserializationError error = deserializeJson(session.doc, line);
 
     if (error) return false;
-    if (!doc.containsKey("params")) return false;
-
-    mJob.job_id = String((const char*) doc["params"][0]);
-    mJob.prev_block_hash = String((const char*) doc["params"][1]);
-    mJob.coinb1 = String((const char*) doc["params"][2]);
-    mJob.coinb2 = String((const char*) doc["params"][3]);
-    mJob.merkle_branch = doc["params"][4];
-    mJob.version = String((const char*) doc["params"][5]);
-    mJob.nbits = String((const char*) doc["params"][6]);
-    mJob.ntime = String((const char*) doc["params"][7]);
-    mJob.clean_jobs = doc["params"][8]; //bool
-
-    #ifdef DEBUG_MINING
-    Serial.print("    job_id: "); Serial.println(mJob.job_id);
-    Serial.print("    prevhash: "); Serial.println(mJob.prev_block_hash);
-    Serial.print("    coinb1: "); Serial.println(mJob.coinb1);
-    Serial.print("    coinb2: "); Serial.println(mJob.coinb2);
-    Serial.print("    merkle_branch size: "); Serial.println(mJob.merkle_branch.size());
-    Serial.print("    version: "); Serial.println(mJob.version);
-    Serial.print("    nbits: "); Serial.println(mJob.nbits);
-    Serial.print("    ntime: "); Serial.println(mJob.ntime);
-    Serial.print("    clean_jobs: "); Serial.println(mJob.clean_jobs);
-    #endif
+    if (!session.doc.containsKey("params")) return false;
+
+    mJob.job_id = String((const char*) session.doc["params"][0]);
+    mJob.prev_block_hash = String((const char*) session.doc["params"][1]);
+    mJob.coinb1 = String((const char*) session.doc["params"][2]);
+    mJob.coinb2 = String((const char*) session.doc["params"][3]);
+    JsonArray merkle_branch = session.doc["params"][4];
+    mJob.merkle_branch.clear();
+    for (size_t k = 0; k < merkle_branch.size() && k < MAX_MERKLE_BRANCHES; k++)
+        mJob.merkle_branch.push_back(String((const char*) merkle_branch[k]));
+    mJob.version = String((const char*) session.doc["params"][5]);
+    mJob.nbits = String((const char*) session.doc["params"][6]);
+    mJob.ntime = String((const char*) session.doc["params"][7]);
+    mJob.clean_jobs = session.doc["params"][8]; //bool
+
+    LOG_D("    job_id: %s\n", mJob.job_id.c_str());
+    LOG_D("    prevhash: %s\n", mJob.prev_block_hash.c_str());
+    LOG_D("    coinb1: %s\n", mJob.coinb1.c_str());
+    LOG_D("    coinb2: %s\n", mJob.coinb2.c_str());
+    LOG_D("    merkle_branch size: %u\n", (unsigned int)mJob.merkle_branch.size());
+    LOG_D("    version: %s\n", mJob.version.c_str());
+    LOG_D("    nbits: %s\n", mJob.nbits.c_str());
+    LOG_D("    ntime: %s\n", mJob.ntime.c_str());
+    LOG_D("    clean_jobs: %d\n", (int)mJob.clean_jobs);
     //Check if parameters where correctly received
-    if (checkError(doc)) {
-      Serial.printf("[WORKER] >>>>>>>>> Work aborted\n"); 
+    if (checkError(session.doc)) {
+      LOG_W("[WORKER] >>>>>>>>> Work aborted\n"); 
       return false;
     }
     return true;
 }
 
 
-bool tx_mining_submit(WiFiClient& client, mining_subscribe mWorker, mining_job mJob, unsigned long nonce, unsigned long &submit_id)
+bool tx_mining_submit(WiFiClient& client, stratum_session& session, mining_subscribe mWorker, mining_job mJob, unsigned long nonce, uint32_t version_bits, unsigned long &submit_id)
 {
     char payload[BUFFER] = {0};
+    char version_param[16] = {0};
+
+    //BIP310: 6th param carries the rolled version bits, only once the pool agreed to version rolling
+    if (mWorker.version_mask != 0)
+        sprintf(version_param, ",\"%08x\"", version_bits & mWorker.version_mask);
 
     // Submit
-    id = getNextId(id);
-    submit_id = id;
-    sprintf(payload, "{\"id\":%u,\"method\":\"mining.submit\",\"params\":[\"%s\",\"%s\",\"%s\",\"%s\",\"%s\"]}\n",
-        id,
+    session.id = getNextId(session.id);
+    submit_id = session.id;
+    sprintf(payload, "{\"id\":%u,\"method\":\"mining.submit\",\"params\":[\"%s\",\"%s\",\"%s\",\"%s\",\"%s\"%s]}\n",
+        session.id,
         mWorker.wName,//"bc1qvv469gmw4zz6qa4u4dsezvrlmqcqszwyfzhgwj", //mWorker.name,
         mJob.job_id.c_str(),
         mWorker.extranonce2.c_str(),
         mJob.ntime.c_str(),
-        String(nonce, HEX).c_str()
+        String(nonce, HEX).c_str(),
+        version_param
         );
-    Serial.print("  Sending  : "); Serial.print(payload);
-    client.print(payload);
+    //Socket first, the serial echo takes longer than the send at 115200 bauds
+    stratum_send(client, payload);
+    LOG_I("  Sending  : %s", payload);
     //Serial.print("  Receiving: "); Serial.println(client.readStringUntil('\n'));
 
     return true;
 }
 
-bool parse_mining_set_difficulty(String line, double& difficulty)
+bool parse_mining_set_difficulty(stratum_session& session, String line, double& difficulty)
 {
-    Serial.println("    Parsing Method [SET DIFFICULTY]");
+    LOG_I("    Parsing Method [SET DIFFICULTY]\n");
     if(!verifyPayload(&line)) return false;
    
-    DeserializationError error = deserializeJson(doc, line);
+    DeserializationError error = deserializeJson(session.doc, line);
 
     if (error) return false;
-    if (!doc.containsKey("params")) return false;
+    if (!session.doc.containsKey("params")) return false;
 
-    Serial.print("    difficulty: "); Serial.println((double)doc["params"][0],12);
-    difficulty = (double)doc["params"][0];
+    LOG_I("    difficulty: %.12f\n", (double)session.doc["params"][0]);
+    difficulty = (double)session.doc["params"][0];
 
     return true;
 }
 
-bool tx_suggest_difficulty(WiFiClient& client, double difficulty)
+// Session control
+    // Docs:
+    // - https://github.com/nicehash/Specifications/blob/master/NiceHash_extranonce_subscribe_extension.txt
+    // - https://cs.braiins.com/stratum-v1/docs (client.reconnect)
+bool tx_extranonce_subscribe(WiFiClient& client, stratum_session& session)
 {
     char payload[BUFFER] = {0};
 
-    id = getNextId(id);
-    sprintf(payload, "{\"id\":%d,\"method\":\"mining.suggest_difficulty\",\"params\":[%.10g]}\n", id, difficulty);
+    session.id = getNextId(session.id);
+    sprintf(payload, "{\"id\":%u,\"method\":\"mining.extranonce.subscribe\",\"params\":[]}\n", session.id);
+
+    LOG_I("  Sending  : %s", payload);
+    return stratum_send(client, payload);
+}
+
+bool parse_mining_set_extranonce(stratum_session& session, String line, mining_subscribe& mSubscribe)
+{
+    LOG_I("    Parsing Method [SET EXTRANONCE]\n");
+    if(!verifyPayload(&line)) return false;
+
+    DeserializationError error = deserializeJson(session.doc, line);
+
+    if (error) return false;
+    if (!session.doc.containsKey("params")) return false;
+
+    const char* extranonce1 = session.doc["params"][0];
+    if (extranonce1 == NULL) return false;
+    mSubscribe.extranonce1 = String(extranonce1);
+    //extranonce2_size is optional, keep the current one if missing
+    if (!session.doc["params"][1].isNull())
+        mSubscribe.extranonce2_size = session.doc["params"][1];
+
+    LOG_I("    extranonce1: %s\n", mSubscribe.extranonce1.c_str());
+    LOG_I("    extranonce2_size: %d\n", mSubscribe.extranonce2_size);
+
+    return true;
+}
+
+bool parse_client_reconnect(stratum_session& session, String line, String& host, int& port, uint32_t& wait_seconds)
+{
+    LOG_I("    Parsing Method [CLIENT RECONNECT]\n");
+    if(!verifyPayload(&line)) return false;
+
+    DeserializationError error = deserializeJson(session.doc, line);
+
+    if (error) return false;
+
+    //All params are optional: missing host/port mean reconnect to the same pool
+    host = "";
+    port = 0;
+    wait_seconds = 0;
+    if (session.doc["params"][0].is<const char*>())
+        host = String((const char*) session.doc["params"][0]);
+    if (session.doc["params"][1].is<const char*>())
+        port = atoi((const char*) session.doc["params"][1]);
+    else if (!session.doc["params"][1].isNull())
+        port = session.doc["params"][1];
+    if (!session.doc["params"][2].isNull())
+        wait_seconds = session.doc["params"][2];
+
+    LOG_I("    host: %s\n", host.c_str());
+    LOG_I("    port: %d\n", port);
+    LOG_I("    wait: %u\n", wait_seconds);
+
+    return true;
+}
+
+bool tx_suggest_difficulty(WiFiClient& client, stratum_session& session, double difficulty)
+{
+    char payload[BUFFER] = {0};
+
+    session.id = getNextId(session.id);
+    sprintf(payload, "{\"id\":%d,\"method\":\"mining.suggest_difficulty\",\"params\":[%.10g]}\n", session.id, difficulty);
     
-    Serial.print("  Sending  : "); Serial.print(payload);
-    return client.print(payload);
+    LOG_I("  Sending  : %s", payload);
+    return stratum_send(client, payload);
 
 }
 
 
-unsigned long parse_extract_id(const String &line)
+unsigned long parse_extract_id(stratum_session& session, const String &line)
 {
-    DeserializationError error = deserializeJson(doc, line);
+    DeserializationError error = deserializeJson(session.doc, line);
     if (error)
         return 0;
     
-    if (!doc.containsKey("id"))
+    if (!session.doc.containsKey("id"))
         return 0;
 
-    unsigned long id = doc["id"];
+    unsigned long id = session.doc["id"];
 
     return id;
-}
\ No newline at end of file
+}
+
+bool parse_submit_result(stratum_session& session, const String &line, unsigned long &id, int &code, String &message)
+{
+    id = 0;
+    code = 0;
+    message = "";
+    DeserializationError error = deserializeJson(session.doc, line);
+    if (error)
+        return false;
+    id = session.doc["id"];
+
+    //[code, "message", traceback] by the spec, some pools send {"code":..,"message":..}
+    JsonVariant err = session.doc["error"];
+    if (err.is<JsonArray>() && err.size() > 0)
+    {
+        code = err[0] | 0;
+        message = err[1] | "";
+        return false;
+    }
+    if (err.is<JsonObject>())
+    {
+        code = err["code"] | 0;
+        message = err["message"] | "";
+        return false;
+    }
+    if (!err.isNull())
+    {
+        message = err | "error";
+        return false;
+    }
+    if (session.doc["result"].is<bool>() && !session.doc["result"].as<bool>())
+    {
+        message = "result false";
+        return false;
+    }
+    return true;
+}
+
+share_reject share_reject_reason(int code, const char* message)
+{
+    //Stratum v1 error codes
+    switch (code)
+    {
+        case 21: return SHARE_REJECT_STALE;
+        case 22: return SHARE_REJECT_DUPLICATE;
+        case 23: return SHARE_REJECT_LOW_DIFFICULTY;
+        case 24:
+        case 25: return SHARE_REJECT_UNAUTHORIZED;
+    }
+    //Pools with their own codes, SV2 error codes and BIP22 submitblock results
+    static const struct { const char* text; share_reject reason; } s_reasons[] = {
+        { "stale", SHARE_REJECT_STALE },
+        { "job not found", SHARE_REJECT_STALE },
+        { "invalid-job", SHARE_REJECT_STALE },
+        { "prevblk", SHARE_REJECT_STALE },
+        { "duplicate", SHARE_REJECT_DUPLICATE },
+        { "low diff", SHARE_REJECT_LOW_DIFFICULTY },
+        { "difficulty-too-low", SHARE_REJECT_LOW_DIFFICULTY },
+        { "high-hash", SHARE_REJECT_LOW_DIFFICULTY },
+        { "unauthorized", SHARE_REJECT_UNAUTHORIZED },
+        { "not subscribed", SHARE_REJECT_UNAUTHORIZED },
+    };
+    String text(message != NULL ? message : "");
+    text.toLowerCase();
+    for (size_t i = 0; i < sizeof(s_reasons) / sizeof(s_reasons[0]); ++i)
+        if (strstr(text.c_str(), s_reasons[i].text) != NULL)
+            return s_reasons[i].reason;
+    return SHARE_REJECT_OTHER;
+}
+
+const char* share_reject_name(share_reject reason)
+{
+    static const char* const s_names[SHARE_REJECT_REASONS] = { "stale", "duplicate", "low_difficulty", "unauthorized", "other" };
+    return reason < SHARE_REJECT_REASONS ? s_names[reason] : "other";
+}
+
+// Server side: requests from downstream miners and our answers, used by the local proxy
+    // Same messages as above seen from the pool side, answers are not echoed to Serial
+bool parse_mining_configure_request(stratum_session& session, String line, uint32_t& version_mask)
+{
+    if(!verifyPayload(&line)) return false;
+
+    DeserializationError error = deserializeJson(session.doc, line);
+
+    if (error) return false;
+
+    bool version_rolling = false;
+    JsonArray extensions = session.doc["params"][0];
+    for (size_t i = 0; i < extensions.size(); i++)
+        if (strcmp("version-rolling", extensions[i] | "") == 0)
+            version_rolling = true;
+    if (!version_rolling) return false;
+
+    const char* mask = session.doc["params"][1]["version-rolling.mask"];
+    version_mask = (mask != NULL) ? strtoul(mask, NULL, 16) : 0xFFFFFFFF;
+    return true;
+}
+
+bool parse_mining_suggest_difficulty(stratum_session& session, String line, double& difficulty)
+{
+    if(!verifyPayload(&line)) return false;
+
+    DeserializationError error = deserializeJson(session.doc, line);
+
+    if (error) return false;
+    if (!session.doc["params"][0].is<double>()) return false;
+
+    double diff = session.doc["params"][0];
+    if (diff <= 0) return false;
+    difficulty = diff;
+    return true;
+}
+
+bool parse_mining_submit(stratum_session& session, String line, mining_submit& submit)
+{
+    if(!verifyPayload(&line)) return false;
+
+    DeserializationError error = deserializeJson(session.doc, line);
+
+    if (error) return false;
+    if (session.doc["params"].size() < 5) return false;
+
+    submit.id = session.doc["id"];
+    submit.worker = String(session.doc["params"][0] | "");
+    submit.job_id = String(session.doc["params"][1] | "");
+    submit.extranonce2 = String(session.doc["params"][2] | "");
+    submit.ntime = String(session.doc["params"][3] | "");
+    submit.nonce = String(session.doc["params"][4] | "");
+    submit.version_bits = 0;
+    if (session.doc["params"].size() > 5)
+        submit.version_bits = strtoul(session.doc["params"][5] | "0", NULL, 16);
+
+    return submit.job_id.length() > 0 && submit.ntime.length() == 8 && submit.nonce.length() > 0 && submit.nonce.length() <= 8;
+}
+
+//Forward a downstream share to the pool, under our worker name
+bool tx_mining_submit(WiFiClient& client, stratum_session& session, const char* wName, const mining_submit& submit, uint32_t version_mask, unsigned long &submit_id)
+{
+    char payload[BUFFER] = {0};
+    char version_param[16] = {0};
+
+    if (version_mask != 0)
+        sprintf(version_param, ",\"%08x\"", submit.version_bits & version_mask);
+
+    session.id = getNextId(session.id);
+    submit_id = session.id;
+    snprintf(payload, sizeof(payload), "{\"id\":%lu,\"method\":\"mining.submit\",\"params\":[\"%s\",\"%s\",\"%s\",\"%s\",\"%s\"%s]}\n",
+        session.id, wName, submit.job_id.c_str(), submit.extranonce2.c_str(), submit.ntime.c_str(), submit.nonce.c_str(), version_param);
+    bool sent = stratum_send(client, payload);
+    LOG_I("  Sending  : %s", payload);
+    return sent;
+}
+
+bool tx_result(WiFiClient& client, unsigned long id, const char* result)
+{
+    char payload[BUFFER] = {0};
+
+    snprintf(payload, sizeof(payload), "{\"id\":%lu,\"result\":%s,\"error\":null}\n", id, result);
+    return stratum_send(client, payload);
+}
+
+bool tx_error(WiFiClient& client, unsigned long id, int code, const char* message)
+{
+    char payload[BUFFER] = {0};
+
+    snprintf(payload, sizeof(payload), "{\"id\":%lu,\"result\":null,\"error\":[%d,\"%s\",null]}\n", id, code, message);
+    return stratum_send(client, payload);
+}
+
+bool tx_mining_configure_result(WiFiClient& client, unsigned long id, uint32_t version_mask)
+{
+    char result[128] = {0};
+
+    if (version_mask != 0)
+        sprintf(result, "{\"version-rolling\":true,\"version-rolling.mask\":\"%08x\"}", version_mask);
+    else
+        sprintf(result, "{\"version-rolling\":false}");
+    return tx_result(client, id, result);
+}
+
+bool tx_mining_subscribe_result(WiFiClient& client, unsigned long id, const String& extranonce1, int extranonce2_size)
+{
+    char result[256] = {0};
+
+    snprintf(result, sizeof(result), "[[[\"mining.notify\",\"%s\"]],\"%s\",%d]", extranonce1.c_str(), extranonce1.c_str(), extranonce2_size);
+    return tx_result(client, id, result);
+}
+
+bool tx_mining_set_difficulty(WiFiClient& client, double difficulty)
+{
+    char payload[BUFFER] = {0};
+
+    sprintf(payload, "{\"id\":null,\"method\":\"mining.set_difficulty\",\"params\":[%.10g]}\n", difficulty);
+    return stratum_send(client, payload);
+}
+
+bool tx_mining_set_extranonce(WiFiClient& client, const String& extranonce1, int extranonce2_size)
+{
+    char payload[BUFFER] = {0};
+
+    snprintf(payload, sizeof(payload), "{\"id\":null,\"method\":\"mining.set_extranonce\",\"params\":[\"%s\",%d]}\n", extranonce1.c_str(), extranonce2_size);
+    return stratum_send(client, payload);
+}
+
+bool tx_mining_notify(WiFiClient& client, const mining_job& mJob, bool clean_jobs)
+{
+    //Coinbase and merkle branches don't fit in BUFFER
+    String payload = String("{\"id\":null,\"method\":\"mining.notify\",\"params\":[\"") + mJob.job_id + "\",\"" + mJob.prev_block_hash + "\",\"" +
+                     mJob.coinb1 + "\",\"" + mJob.coinb2 + "\",[";
+    for (size_t k = 0; k < mJob.merkle_branch.size(); k++)
+    {
+        if (k) payload += ",";
+        payload += "\"";
+        payload += mJob.merkle_branch[k];
+        payload += "\"";
+    }
+    payload += String("],\"") + mJob.version + "\",\"" + mJob.nbits + "\",\"" + mJob.ntime + "\"," + (clean_jobs ? "true" : "false") + "]}\n";
+    return stratum_send(client, payload.c_str());
+}
@@ -6,6 +6,7 @@
 #include <Arduino.h>
 #include <ArduinoJson.h>
 #include <WiFi.h>
+#include <vector>
 
 #define MAX_MERKLE_BRANCHES 32
 #define HASH_SIZE 32
@@ -15,11 +16,16 @@
 #define BUFFER_JSON_DOC 4096
 #define BUFFER 1024
 
+//BIP320 general purpose version bits requested with mining.configure (BIP310)
+#define VERSION_ROLLING_MASK 0x1FFFE000
+#define VERSION_ROLLING_MIN_BITS 2
+
 typedef struct {
     String sub_details;
     String extranonce1;
     String extranonce2;
     int extranonce2_size;
+    uint32_t version_mask;  //0 if the pool doesn't allow version rolling
     char wName[80];
     char wPass[20];
 } mining_subscribe;
@@ -30,42 +36,108 @@ typedef struct {
     String coinb1;
     String coinb2;
     String nbits;
-    JsonArray merkle_branch;
+    std::vector<String> merkle_branch;  //copied out of the json doc, the job outlives the next parse
     String version;
     uint32_t target;
     String ntime;
     bool clean_jobs;
 } mining_job;
 
+//One connection to a pool: the id of its last request and the document its lines are
+//parsed into. The active and the standby pool each have their own.
+typedef struct {
+    unsigned long id;
+    StaticJsonDocument<BUFFER_JSON_DOC> doc;
+} stratum_session;
+
 typedef enum {
     STRATUM_SUCCESS,
     STRATUM_UNKNOWN,
     STRATUM_PARSE_ERROR,
     MINING_NOTIFY,
-    MINING_SET_DIFFICULTY
+    MINING_SET_DIFFICULTY,
+    MINING_SET_VERSION_MASK,
+    MINING_SET_EXTRANONCE,
+    CLIENT_RECONNECT,
+    //Requests, received by the local proxy
+    MINING_CONFIGURE,
+    MINING_SUBSCRIBE,
+    MINING_AUTHORIZE,
+    MINING_SUBMIT,
+    MINING_SUGGEST_DIFFICULTY,
+    MINING_EXTRANONCE_SUBSCRIBE
 } stratum_method;
 
+typedef struct {
+    unsigned long id;
+    String worker;
+    String job_id;
+    String extranonce2;
+    String ntime;
+    String nonce;
+    uint32_t version_bits;  //only with version rolling
+} mining_submit;
+
+//Why the pool refused a share, from the error code (v1) or the reason text (all protocols)
+typedef enum {
+    SHARE_REJECT_STALE = 0,         //Job unknown or the block moved on
+    SHARE_REJECT_DUPLICATE,
+    SHARE_REJECT_LOW_DIFFICULTY,
+    SHARE_REJECT_UNAUTHORIZED,      //Worker not authorized or not subscribed
+    SHARE_REJECT_OTHER,
+    SHARE_REJECT_REASONS
+} share_reject;
+
 unsigned long getNextId(unsigned long id);
+String stratum_read_line(WiFiClient& client);
 bool verifyPayload (String* line);
-bool checkError(const StaticJsonDocument<BUFFER_JSON_DOC> doc);
+bool checkError(const StaticJsonDocument<BUFFER_JSON_DOC>& doc);
+
+//Method Mining.configure (version rolling)
+bool tx_mining_configure(WiFiClient& client, stratum_session& session, mining_subscribe& mSubscribe);
+bool parse_mining_configure(stratum_session& session, String line, mining_subscribe& mSubscribe);
+bool parse_mining_set_version_mask(stratum_session& session, String line, uint32_t& version_mask);
 
 //Method Mining.subscribe
 mining_subscribe init_mining_subscribe(void);
-bool tx_mining_subscribe(WiFiClient& client, mining_subscribe& mSubscribe);
-bool parse_mining_subscribe(String line, mining_subscribe& mSubscribe);
+bool tx_mining_subscribe(WiFiClient& client, stratum_session& session, mining_subscribe& mSubscribe);
+bool parse_mining_subscribe(stratum_session& session, String line, mining_subscribe& mSubscribe);
 
 //Method Mining.authorise
-bool tx_mining_auth(WiFiClient& client, const char * user, const char * pass);
-stratum_method parse_mining_method(String line);
-bool parse_mining_notify(String line, mining_job& mJob);
+bool tx_mining_auth(WiFiClient& client, stratum_session& session, const char * user, const char * pass);
+stratum_method parse_mining_method(stratum_session& session, String line);
+bool parse_mining_notify(stratum_session& session, String line, mining_job& mJob);
 
 //Method Mining.submit
-bool tx_mining_submit(WiFiClient& client, mining_subscribe mWorker, mining_job mJob, unsigned long nonce, unsigned long &submit_id);
+bool tx_mining_submit(WiFiClient& client, stratum_session& session, mining_subscribe mWorker, mining_job mJob, unsigned long nonce, uint32_t version_bits, unsigned long &submit_id);
+
+//Session control: extranonce updates and pool redirection
+bool tx_extranonce_subscribe(WiFiClient& client, stratum_session& session);
+bool parse_mining_set_extranonce(stratum_session& session, String line, mining_subscribe& mSubscribe);
+bool parse_client_reconnect(stratum_session& session, String line, String& host, int& port, uint32_t& wait_seconds);
 
 //Difficulty Methods 
-bool tx_suggest_difficulty(WiFiClient& client, double difficulty);
-bool parse_mining_set_difficulty(String line, double& difficulty);
+bool tx_suggest_difficulty(WiFiClient& client, stratum_session& session, double difficulty);
+bool parse_mining_set_difficulty(stratum_session& session, String line, double& difficulty);
+
+unsigned long parse_extract_id(stratum_session& session, const String &line);
+//Answer to a mining.submit: false with the pool error code (0 if none) and message
+//when refused, "error":null with "result":false is a refusal too
+bool parse_submit_result(stratum_session& session, const String &line, unsigned long &id, int &code, String &message);
+share_reject share_reject_reason(int code, const char* message);
+const char* share_reject_name(share_reject reason);
 
-unsigned long parse_extract_id(const String &line);
+//Server side, used by the local proxy to talk to downstream miners
+bool parse_mining_configure_request(stratum_session& session, String line, uint32_t& version_mask);
+bool parse_mining_suggest_difficulty(stratum_session& session, String line, double& difficulty);
+bool parse_mining_submit(stratum_session& session, String line, mining_submit& submit);
+bool tx_mining_submit(WiFiClient& client, stratum_session& session, const char* wName, const mining_submit& submit, uint32_t version_mask, unsigned long &submit_id);
+bool tx_result(WiFiClient& client, unsigned long id, const char* result);
+bool tx_error(WiFiClient& client, unsigned long id, int code, const char* message);
+bool tx_mining_configure_result(WiFiClient& client, unsigned long id, uint32_t version_mask);
+bool tx_mining_subscribe_result(WiFiClient& client, unsigned long id, const String& extranonce1, int extranonce2_size);
+bool tx_mining_set_difficulty(WiFiClient& client, double difficulty);
+bool tx_mining_set_extranonce(WiFiClient& client, const String& extranonce1, int extranonce2_size);
+bool tx_mining_notify(WiFiClient& client, const mining_job& mJob, bool clean_jobs);
 
 #endif // STRATUM_API_H
\ No newline at end of file
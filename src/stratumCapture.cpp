@@ -0,0 +1,83 @@
+#include <Arduino.h>
+#include <WiFi.h>
+#include <stdio.h>
+#include "stratumCapture.h"
+
+static String s_path;
+static FILE* s_file = NULL;
+static const WiFiClient* s_client = NULL;
+static uint32_t s_start_time = 0;
+static uint32_t s_flush_time = 0;
+static uint32_t s_bytes = 0;
+static bool s_failed = false;
+
+void capture_setup(const char* path)
+{
+  s_path = path;
+}
+
+bool capture_enabled(void)
+{
+  return s_path.length() > 0 && !s_failed;
+}
+
+void capture_attach(WiFiClient* client)
+{
+  s_client = client;
+}
+
+static bool CaptureOpen(void)
+{
+  s_file = fopen(s_path.c_str(), "w");
+  if (s_file == NULL)
+  {
+    Serial.printf("[CAPTURE] Unable to open %s, capture disabled\n", s_path.c_str());
+    s_failed = true;
+    return false;
+  }
+  setvbuf(s_file, NULL, _IOFBF, 4096);
+  s_start_time = millis();
+  s_flush_time = s_start_time;
+  Serial.printf("[CAPTURE] Recording stratum session to %s\n", s_path.c_str());
+  return true;
+}
+
+void capture_line(const WiFiClient& client, char direction, const char* line)
+{
+  if (&client != s_client || !capture_enabled())
+    return;
+  if (s_file == NULL && !CaptureOpen())
+    return;
+
+  size_t len = strlen(line);
+  while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r'))
+    len--;
+  if (len == 0)
+    return;
+
+  if (CAPTURE_MAX_KB > 0 && s_bytes + len + 16 > (uint32_t)CAPTURE_MAX_KB * 1024)
+  {
+    Serial.printf("[CAPTURE] %s full (%u bytes), capture stopped\n", s_path.c_str(), s_bytes);
+    fclose(s_file);
+    s_file = NULL;
+    s_failed = true;
+    return;
+  }
+
+  int header = fprintf(s_file, "%u %c ", millis() - s_start_time, direction);
+  fwrite(line, 1, len, s_file);
+  fputc('\n', s_file);
+  s_bytes += (header > 0 ? header : 0) + len + 1;
+}
+
+void capture_poll(void)
+{
+  if (s_file == NULL)
+    return;
+  uint32_t time_now = millis();
+  if (time_now - s_flush_time >= CAPTURE_FLUSH_ms)
+  {
+    s_flush_time = time_now;
+    fflush(s_file);
+  }
+}
@@ -0,0 +1,39 @@
+#ifndef STRATUM_CAPTURE_H
+#define STRATUM_CAPTURE_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+
+/************************************************************************************
+*   Stratum traffic recorder: every line of the pool session, as sent and received.
+*
+*   One line per message: <ms since capture start> <r|t> <raw json>
+*   The file is opened with stdio, SPIFFS and SD card are both in the VFS on the
+*   device (/spiffs/..., /sd/...). Writes are buffered and flushed by the stratum task.
+*
+*   Device: build with -D STRATUM_CAPTURE=\"/spiffs/stratum.cap\"
+*   Host:   program --pool <pool:port> --wallet <address> --capture stratum.cap
+*   Replay: program --replay stratum.cap [--listen 3333] [--speed 10]
+*           program --replay-bench stratum.cap [loops]
+*************************************************************************************/
+
+#define CAPTURE_FLUSH_ms        10000
+#ifndef CAPTURE_MAX_KB
+#ifdef NERDMINER_HOST
+#define CAPTURE_MAX_KB          0       //No limit
+#else
+#define CAPTURE_MAX_KB          256     //Keep room in SPIFFS for the config
+#endif
+#endif
+
+void capture_setup(const char* path);
+bool capture_enabled(void);
+
+//Only the attached client is recorded, proxy miners and the standby session are not
+void capture_attach(WiFiClient* client);
+void capture_line(const WiFiClient& client, char direction, const char* line);
+
+//Flush the buffered lines, called from the stratum task loop
+void capture_poll(void);
+
+#endif // STRATUM_CAPTURE_H
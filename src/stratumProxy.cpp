@@ -0,0 +1,333 @@
+#include <Arduino.h>
+#include <WiFi.h>
+#include <list>
+#include <memory>
+#include "stratumProxy.h"
+#include "mining.h"
+#include "utils.h"
+
+struct ProxyClient
+{
+  WiFiClient client;
+  uint16_t slice;             //Our part of the pool extranonce2
+  bool subscribed;
+  bool authorized;
+  bool extranonce_subscribe;  //Gets mining.set_extranonce, else reconnects on pool extranonce change
+  uint32_t version_mask;
+  double difficulty;
+  bool suggested;             //Difficulty chosen by the miner, else follow the pool
+  uint32_t accepted;
+  uint32_t rejected;
+  String pending;             //Start of a line, parsed once its newline comes in
+};
+
+static uint16_t s_port = 0;
+static WiFiServer* s_server = NULL;
+static std::list<std::shared_ptr<ProxyClient>> s_clients;
+static uint16_t s_next_slice = 0;
+
+//Upstream state last sent to the downstream miners
+static String s_extranonce1;
+static int s_extranonce2_size = 0;
+static uint32_t s_job_pool = 0xFFFFFFFF;
+static double s_pool_difficulty = 0;
+static std::list<mining_job> s_jobs;
+static stratum_session s_downstream;  //Requests of the downstream miners are parsed here, ids are theirs
+
+uint32_t proxy_accepted = 0;
+uint32_t proxy_rejected = 0;
+uint32_t proxy_forwarded = 0;
+uint64_t proxy_hashes = 0;    //Expected hashes behind the accepted downstream shares
+static uint32_t s_stats_time = 0;
+
+void proxy_setup(uint16_t port)
+{
+  s_port = port;
+}
+
+bool proxy_enabled(void)
+{
+  return s_port != 0;
+}
+
+static String ProxySliceHex(uint16_t slice)
+{
+  char hex[2 * PROXY_EXTRANONCE_BYTES + 1];
+  snprintf(hex, sizeof(hex), "%0*x", 2 * PROXY_EXTRANONCE_BYTES, slice);
+  return String(hex);
+}
+
+static bool ProxySliceUsed(uint16_t slice)
+{
+  for (auto it = s_clients.begin(); it != s_clients.end(); ++it)
+    if ((*it)->subscribed && (*it)->slice == slice)
+      return true;
+  return false;
+}
+
+static const mining_job* ProxyFindJob(const String& job_id)
+{
+  for (auto it = s_jobs.rbegin(); it != s_jobs.rend(); ++it)
+    if (it->job_id == job_id)
+      return &(*it);
+  return NULL;
+}
+
+static void ProxySubmit(ProxyClient& c, const String& line, WiFiClient& upstream, stratum_session& session, mining_subscribe& mWorker, double pool_difficulty,
+                        std::vector<proxy_share>& forwarded)
+{
+  mining_submit submit;
+  if (!parse_mining_submit(s_downstream, line, submit))
+  {
+    tx_error(c.client, parse_extract_id(s_downstream, line), 20, "Bad submit");
+    return;
+  }
+  if (!c.authorized)
+  {
+    tx_error(c.client, submit.id, 24, "Unauthorized worker");
+    return;
+  }
+
+  const mining_job* job = ProxyFindJob(submit.job_id);
+  if (job == NULL || !upstream.connected())
+  {
+    c.rejected++;
+    proxy_rejected++;
+    tx_error(c.client, submit.id, 21, "Job not found");
+    return;
+  }
+  if (submit.extranonce2.length() != 2 * (s_extranonce2_size - PROXY_EXTRANONCE_BYTES) || (submit.version_bits & ~c.version_mask) != 0)
+  {
+    c.rejected++;
+    proxy_rejected++;
+    tx_error(c.client, submit.id, 20, "Bad extranonce2 or version bits");
+    return;
+  }
+
+  //Pool extranonce2 = our slice + the miner extranonce2
+  submit.extranonce2 = ProxySliceHex(c.slice) + submit.extranonce2;
+
+  proxy_share share;
+  share.difficulty = calculateShareDifficulty(s_extranonce1, s_extranonce2_size, *job, submit, c.version_mask, share.hash);
+  if (share.difficulty < c.difficulty)
+  {
+    c.rejected++;
+    proxy_rejected++;
+    tx_error(c.client, submit.id, 23, "Low difficulty share");
+    return;
+  }
+
+  c.accepted++;
+  proxy_accepted++;
+  proxy_hashes += (uint64_t)(c.difficulty * 4294967296.0);
+  tx_result(c.client, submit.id, "true");
+
+  if (share.difficulty >= pool_difficulty)
+  {
+    tx_mining_submit(upstream, session, mWorker.wName, submit, mWorker.version_mask, share.submit_id);
+    proxy_forwarded++;
+    forwarded.push_back(share);
+  }
+}
+
+static void ProxyHandleLine(ProxyClient& c, String& line, bool upstream_ready, WiFiClient& upstream, stratum_session& session,
+                            mining_subscribe& mWorker, double pool_difficulty, std::vector<proxy_share>& forwarded)
+{
+  stratum_method method = parse_mining_method(s_downstream, line);
+  unsigned long id = parse_extract_id(s_downstream, line);
+
+  switch (method)
+  {
+      case MINING_CONFIGURE:          {
+                                        uint32_t version_mask = 0;
+                                        if (parse_mining_configure_request(s_downstream, line, version_mask))
+                                          c.version_mask = version_mask & mWorker.version_mask;
+                                        tx_mining_configure_result(c.client, id, c.version_mask);
+                                      }
+                                      break;
+      case MINING_SUBSCRIBE:          if (!upstream_ready)
+                                      {
+                                        tx_error(c.client, id, 20, "Pool not connected");
+                                        break;
+                                      }
+                                      if (!c.subscribed)
+                                      {
+                                        while (ProxySliceUsed(s_next_slice))
+                                          s_next_slice++;
+                                        c.slice = s_next_slice++;
+                                        c.subscribed = true;
+                                      }
+                                      tx_mining_subscribe_result(c.client, id, s_extranonce1 + ProxySliceHex(c.slice), s_extranonce2_size - PROXY_EXTRANONCE_BYTES);
+                                      break;
+      case MINING_AUTHORIZE:          if (!c.subscribed)
+                                      {
+                                        tx_error(c.client, id, 25, "Not subscribed");
+                                        break;
+                                      }
+                                      c.authorized = true;
+                                      tx_result(c.client, id, "true");
+                                      tx_mining_set_difficulty(c.client, c.difficulty);
+                                      if (!s_jobs.empty())
+                                        tx_mining_notify(c.client, s_jobs.back(), true);
+                                      break;
+      case MINING_SUGGEST_DIFFICULTY: {
+                                        double difficulty;
+                                        if (parse_mining_suggest_difficulty(s_downstream, line, difficulty) && difficulty != c.difficulty)
+                                        {
+                                          c.difficulty = difficulty;
+                                          c.suggested = true;
+                                          if (c.authorized)
+                                            tx_mining_set_difficulty(c.client, c.difficulty);
+                                        }
+                                        tx_result(c.client, id, "true");
+                                      }
+                                      break;
+      case MINING_EXTRANONCE_SUBSCRIBE:
+                                      c.extranonce_subscribe = true;
+                                      tx_result(c.client, id, "true");
+                                      break;
+      case MINING_SUBMIT:             ProxySubmit(c, line, upstream, session, mWorker, pool_difficulty, forwarded);
+                                      break;
+      case STRATUM_SUCCESS:           break;
+      default:                        if (id != 0)
+                                        tx_error(c.client, id, 20, "Unknown method");
+                                      break;
+  }
+}
+
+void proxy_poll(WiFiClient& upstream, stratum_session& session, mining_subscribe& mWorker, mining_job& mJob, uint32_t job_pool, double pool_difficulty,
+                std::vector<proxy_share>& forwarded)
+{
+  if (s_port == 0)
+    return;
+
+  if (s_server == NULL)
+  {
+    if (WiFi.status() != WL_CONNECTED)
+      return;
+    s_server = new WiFiServer(s_port);
+    s_server->begin();
+    s_server->setNoDelay(true);
+    Serial.printf("[PROXY] Listening on port %d\n", s_port);
+  }
+
+  bool upstream_ready = upstream.connected() && job_pool != 0xFFFFFFFF && mWorker.extranonce2_size > PROXY_EXTRANONCE_BYTES;
+
+  //Pool changed extranonce1 (set_extranonce or failover), every slice changes with it
+  if (upstream_ready && (mWorker.extranonce1 != s_extranonce1 || mWorker.extranonce2_size != s_extranonce2_size))
+  {
+    s_extranonce1 = mWorker.extranonce1;
+    s_extranonce2_size = mWorker.extranonce2_size;
+    s_jobs.clear();
+    for (auto it = s_clients.begin(); it != s_clients.end(); ++it)
+    {
+      ProxyClient& c = **it;
+      if (!c.subscribed)
+        continue;
+      if (c.extranonce_subscribe)
+        tx_mining_set_extranonce(c.client, s_extranonce1 + ProxySliceHex(c.slice), s_extranonce2_size - PROXY_EXTRANONCE_BYTES);
+      else
+        c.client.stop();
+    }
+  }
+
+  if (upstream_ready && pool_difficulty != s_pool_difficulty)
+  {
+    s_pool_difficulty = pool_difficulty;
+    for (auto it = s_clients.begin(); it != s_clients.end(); ++it)
+    {
+      ProxyClient& c = **it;
+      if (c.suggested)
+        continue;
+      c.difficulty = pool_difficulty;
+      if (c.authorized)
+        tx_mining_set_difficulty(c.client, c.difficulty);
+    }
+  }
+
+  //New job, or the current one restarted
+  if (upstream_ready && job_pool != s_job_pool)
+  {
+    s_job_pool = job_pool;
+    if (s_jobs.empty() || s_jobs.back().job_id != mJob.job_id)
+    {
+      s_jobs.push_back(mJob);
+      if (s_jobs.size() > PROXY_JOB_HISTORY)
+        s_jobs.pop_front();
+    } else
+      s_jobs.back() = mJob;
+    for (auto it = s_clients.begin(); it != s_clients.end(); ++it)
+      if ((*it)->authorized)
+        tx_mining_notify((*it)->client, s_jobs.back(), mJob.clean_jobs);
+  }
+
+  //New miners
+  WiFiClient incoming = s_server->available();
+  while (incoming)
+  {
+    if (s_clients.size() >= PROXY_MAX_CLIENTS)
+    {
+      Serial.println("[PROXY] Too many miners, connection refused");
+      incoming.stop();
+    } else
+    {
+      std::shared_ptr<ProxyClient> c = std::make_shared<ProxyClient>();
+      c->client = incoming;
+      c->slice = 0;
+      c->subscribed = false;
+      c->authorized = false;
+      c->extranonce_subscribe = false;
+      c->version_mask = 0;
+      c->difficulty = upstream_ready ? pool_difficulty : DEFAULT_DIFFICULTY;
+      c->suggested = false;
+      c->accepted = 0;
+      c->rejected = 0;
+      c->pending = "";
+      s_clients.push_back(c);
+    }
+    incoming = s_server->available();
+  }
+
+  for (auto it = s_clients.begin(); it != s_clients.end(); )
+  {
+    ProxyClient& c = **it;
+    //Only what is already in, a miner sending half a line must not hold the stratum task
+    uint8_t buffer[256];
+    int available;
+    while (c.client.connected() && (available = c.client.available()) > 0)
+    {
+      int len = c.client.read(buffer, (available < (int)sizeof(buffer)) ? available : sizeof(buffer));
+      for (int i = 0; i < len; ++i)
+      {
+        if (buffer[i] != '\n')
+        {
+          c.pending += (char)buffer[i];
+          continue;
+        }
+        String line = c.pending;
+        c.pending = "";
+        if (verifyPayload(&line))
+          ProxyHandleLine(c, line, upstream_ready, upstream, session, mWorker, pool_difficulty, forwarded);
+      }
+      if (c.pending.length() > PROXY_LINE_MAX)
+      {
+        Serial.println("[PROXY] Line too long, miner disconnected");
+        c.client.stop();
+      }
+    }
+    if (!c.client.connected())
+    {
+      c.client.stop();
+      it = s_clients.erase(it);
+    } else
+      ++it;
+  }
+
+  uint32_t time_now = millis();
+  if (time_now - s_stats_time >= PROXY_STATS_ms)
+  {
+    s_stats_time = time_now;
+    Serial.printf("[PROXY] %u miners | accepted %u | rejected %u | forwarded %u\n",
+                  (uint32_t)s_clients.size(), proxy_accepted, proxy_rejected, proxy_forwarded);
+  }
+}
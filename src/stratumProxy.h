@@ -0,0 +1,48 @@
+#ifndef STRATUM_PROXY_H
+#define STRATUM_PROXY_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <vector>
+#include "stratum.h"
+
+/************************************************************************************
+*   Local Stratum proxy: downstream miners connect to us instead of the pool.
+*
+*   The upstream session is the one of runStratumWorker. Each downstream miner gets
+*   extranonce1 = pool extranonce1 + a 2 byte slice of the pool extranonce2, so all of
+*   them mine distinct coinbases. Shares are checked here against the downstream
+*   difficulty and only the ones over the pool difficulty are forwarded.
+*
+*   Device: build with -D STRATUM_PROXY_PORT=3333
+*   Host:   program --pool <pool:port> --wallet <address> --proxy 3333
+*************************************************************************************/
+
+#define PROXY_EXTRANONCE_BYTES  2   //Pool extranonce2 bytes used for the downstream slice
+#define PROXY_JOB_HISTORY       4   //Jobs kept to check late shares
+#define PROXY_STATS_ms          60000
+#define PROXY_LINE_MAX          BUFFER  //Longest request of a miner, longer ones without a newline drop it
+
+#ifdef NERDMINER_HOST
+#define PROXY_MAX_CLIENTS       256
+#else
+#define PROXY_MAX_CLIENTS       6   //lwIP socket limit, the pool sessions need theirs
+#endif
+
+typedef struct {
+    unsigned long submit_id;    //Id of the forwarded mining.submit
+    double difficulty;
+    uint8_t hash[32];
+} proxy_share;
+
+extern uint64_t proxy_hashes;
+
+void proxy_setup(uint16_t port);
+bool proxy_enabled(void);
+
+//Serve downstream miners, called from the stratum task loop.
+//Shares forwarded to the pool are appended to forwarded.
+void proxy_poll(WiFiClient& upstream, stratum_session& session, mining_subscribe& mWorker, mining_job& mJob, uint32_t job_pool, double pool_difficulty,
+                std::vector<proxy_share>& forwarded);
+
+#endif // STRATUM_PROXY_H
@@ -0,0 +1,728 @@
+#include <Arduino.h>
+#include <WiFi.h>
+#include <string.h>
+#include <time.h>
+#include "esp_system.h"
+#include "mbedtls/sha256.h"
+#include "crypto/chachapoly.h"
+#include "crypto/secp256k1.h"
+#include "stratumV2.h"
+#include "utils.h"
+#include "version.h"
+
+#define SV2_PROTOCOL_NAME   "Noise_NX_Secp256k1+EllSwift_ChaChaPoly_SHA256"
+
+#ifdef NERDMINER_HOST
+#define SV2_HARDWARE        "host"
+#else
+#define SV2_HARDWARE        CONFIG_IDF_TARGET
+#endif
+
+//////////////////////////// Noise ///////////////////////////////
+
+typedef struct {
+  uint8_t h[32];
+  uint8_t ck[32];
+  uint8_t k[32];
+  uint64_t n;
+} noise_state;
+
+static void NoiseNonce(uint8_t nonce[12], uint64_t n)
+{
+  memset(nonce, 0, 4);
+  for (int i = 0; i < 8; ++i)
+    nonce[4 + i] = (uint8_t)(n >> (8 * i));
+}
+
+static void HmacSha256(uint8_t out[32], const uint8_t key[32], const uint8_t* data, size_t len)
+{
+  uint8_t pad[64], inner[32];
+  mbedtls_sha256_context ctx;
+  mbedtls_sha256_init(&ctx);
+
+  memset(pad, 0x36, sizeof(pad));
+  for (int i = 0; i < 32; ++i)
+    pad[i] ^= key[i];
+  mbedtls_sha256_starts_ret(&ctx, 0);
+  mbedtls_sha256_update_ret(&ctx, pad, sizeof(pad));
+  mbedtls_sha256_update_ret(&ctx, data, len);
+  mbedtls_sha256_finish_ret(&ctx, inner);
+
+  memset(pad, 0x5c, sizeof(pad));
+  for (int i = 0; i < 32; ++i)
+    pad[i] ^= key[i];
+  mbedtls_sha256_starts_ret(&ctx, 0);
+  mbedtls_sha256_update_ret(&ctx, pad, sizeof(pad));
+  mbedtls_sha256_update_ret(&ctx, inner, sizeof(inner));
+  mbedtls_sha256_finish_ret(&ctx, out);
+  mbedtls_sha256_free(&ctx);
+}
+
+//HKDF with two outputs, as used by MixKey and Split
+static void NoiseHkdf(const uint8_t ck[32], const uint8_t* ikm, size_t ikm_len, uint8_t out1[32], uint8_t out2[32])
+{
+  uint8_t temp[32], data[33];
+  HmacSha256(temp, ck, ikm, ikm_len);
+  data[0] = 0x01;
+  HmacSha256(out1, temp, data, 1);
+  memcpy(data, out1, 32);
+  data[32] = 0x02;
+  HmacSha256(out2, temp, data, 33);
+  memset(temp, 0, sizeof(temp));
+}
+
+static void NoiseMixHash(noise_state& st, const uint8_t* data, size_t len)
+{
+  mbedtls_sha256_context ctx;
+  mbedtls_sha256_init(&ctx);
+  mbedtls_sha256_starts_ret(&ctx, 0);
+  mbedtls_sha256_update_ret(&ctx, st.h, 32);
+  mbedtls_sha256_update_ret(&ctx, data, len);
+  mbedtls_sha256_finish_ret(&ctx, st.h);
+  mbedtls_sha256_free(&ctx);
+}
+
+static void NoiseMixKey(noise_state& st, const uint8_t ikm[32])
+{
+  uint8_t ck[32];
+  NoiseHkdf(st.ck, ikm, 32, ck, st.k);
+  memcpy(st.ck, ck, 32);
+  st.n = 0;
+}
+
+static void NoiseInit(noise_state& st)
+{
+  memset(&st, 0, sizeof(st));
+  mbedtls_sha256_ret((const unsigned char*)SV2_PROTOCOL_NAME, strlen(SV2_PROTOCOL_NAME), st.h, 0);
+  memcpy(st.ck, st.h, 32);
+  NoiseMixHash(st, NULL, 0);  //Empty prologue
+}
+
+static void NoiseEncryptAndHash(noise_state& st, const uint8_t* in, size_t len, uint8_t* out)
+{
+  uint8_t nonce[12];
+  NoiseNonce(nonce, st.n++);
+  chachapoly_seal(st.k, nonce, st.h, 32, in, len, out);
+  NoiseMixHash(st, out, len + SV2_MAC_SIZE);
+}
+
+static bool NoiseDecryptAndHash(noise_state& st, const uint8_t* in, size_t len, uint8_t* out)
+{
+  uint8_t nonce[12];
+  NoiseNonce(nonce, st.n++);
+  if (!chachapoly_open(st.k, nonce, st.h, 32, in, len, out))
+    return false;
+  NoiseMixHash(st, in, len);
+  return true;
+}
+
+static void NoiseSplit(noise_state& st, sv2_session& s, bool initiator)
+{
+  uint8_t k1[32], k2[32];
+  NoiseHkdf(st.ck, NULL, 0, k1, k2);
+  memcpy(s.tx.key, initiator ? k1 : k2, 32);
+  memcpy(s.rx.key, initiator ? k2 : k1, 32);
+  s.tx.nonce = 0;
+  s.rx.nonce = 0;
+  memset(&st, 0, sizeof(st));
+}
+
+//Ephemeral key and its encoding
+static bool NoiseEphemeral(uint8_t seckey[32], uint8_t ell[64])
+{
+  for (int i = 0; i < 8; ++i)
+  {
+    uint8_t rnd[32];
+    esp_fill_random(seckey, 32);
+    esp_fill_random(rnd, sizeof(rnd));
+    if (secp256k1_ellswift_create(ell, seckey, rnd))
+      return true;
+  }
+  return false;
+}
+
+//Signed part of SIGNATURE_NOISE_MESSAGE: SHA256(version || valid_from || not_valid_after || server key x)
+static void CertMessage(uint8_t msg[32], const uint8_t* cert, const uint8_t server_x[32])
+{
+  uint8_t data[10 + 32];
+  memcpy(data, cert, 10);
+  memcpy(data + 10, server_x, 32);
+  mbedtls_sha256_ret(data, sizeof(data), msg, 0);
+}
+
+//////////////////////////// Authority key ///////////////////////////////
+
+static const char BASE58[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+
+static void Sha256d(uint8_t out[32], const uint8_t* data, size_t len)
+{
+  mbedtls_sha256_ret(data, len, out, 0);
+  mbedtls_sha256_ret(out, 32, out, 0);
+}
+
+//base58check of version (u16, 1) || x-only key
+String sv2_authority_key_encode(const uint8_t xonly[32])
+{
+  uint8_t data[38], h[32];
+  data[0] = 1;
+  data[1] = 0;
+  memcpy(data + 2, xonly, 32);
+  Sha256d(h, data, 34);
+  memcpy(data + 34, h, 4);
+
+  uint8_t digits[64] = { 0 };
+  size_t len = 0;
+  for (size_t i = 0; i < sizeof(data); ++i)
+  {
+    uint32_t carry = data[i];
+    for (size_t j = 0; j < len; ++j)
+    {
+      carry += (uint32_t)digits[j] << 8;
+      digits[j] = carry % 58;
+      carry /= 58;
+    }
+    while (carry > 0)
+    {
+      digits[len++] = carry % 58;
+      carry /= 58;
+    }
+  }
+  String key;
+  for (size_t i = 0; i < sizeof(data) && data[i] == 0; ++i)
+    key += '1';
+  while (len > 0)
+    key += BASE58[digits[--len]];
+  return key;
+}
+
+static bool AuthorityKeyDecode(const String& key, uint8_t xonly[32])
+{
+  uint8_t data[38] = { 0 };
+  for (size_t i = 0; i < key.length(); ++i)
+  {
+    const char* digit = strchr(BASE58, key[i]);
+    if (digit == NULL || key[i] == 0)
+      return false;
+    uint32_t carry = digit - BASE58;
+    for (int j = sizeof(data) - 1; j >= 0; --j)
+    {
+      carry += (uint32_t)data[j] * 58;
+      data[j] = carry & 0xFF;
+      carry >>= 8;
+    }
+    if (carry != 0)
+      return false;
+  }
+  uint8_t h[32];
+  Sha256d(h, data, 34);
+  if (memcmp(h, data + 34, 4) != 0 || data[0] != 1 || data[1] != 0)
+    return false;
+  memcpy(xonly, data + 2, 32);
+  return true;
+}
+
+bool sv2_parse_url(const String& url, String& host, String& authority_key)
+{
+  if (!url.startsWith(SV2_URL_SCHEME))
+    return false;
+  host = url.substring(strlen(SV2_URL_SCHEME));
+  authority_key = "";
+  int slash = host.indexOf('/');
+  if (slash >= 0)
+  {
+    authority_key = host.substring(slash + 1);
+    host = host.substring(0, slash);
+  }
+  return true;
+}
+
+//////////////////////////// Frames ///////////////////////////////
+
+void sv2_session_init(sv2_session& s)
+{
+  memset(s.frame, 0, sizeof(s.frame));
+  s.frame_len = 0;
+  s.header_done = false;
+  s.channel_id = 0;
+  s.extranonce_prefix_len = 0;
+  memset(s.target, 0xFF, sizeof(s.target));
+  s.sequence = 0;
+  s.prev_hash_valid = false;
+  s.job_valid = false;
+  s.future_count = 0;
+  s.reconnect_host = "";
+  s.reconnect_port = 0;
+  s.rx_bytes = 0;
+  s.tx_bytes = 0;
+}
+
+//Payload length on the wire, every chunk of up to 65535 bytes has its MAC
+static size_t Sv2EncryptedLength(uint32_t len)
+{
+  const uint32_t chunk = 65535 - SV2_MAC_SIZE;
+  return len + SV2_MAC_SIZE * ((len + chunk - 1) / chunk);
+}
+
+static bool Sv2Write(WiFiClient& client, sv2_session& s, const uint8_t* data, size_t len)
+{
+  size_t sent = client.write(data, len);
+  s.tx_bytes += sent;
+  return sent == len;
+}
+
+bool sv2_send(WiFiClient& client, sv2_session& s, uint16_t extension, uint8_t msg_type, const uint8_t* payload, size_t len)
+{
+  if (len > SV2_PAYLOAD_MAX)
+    return false;
+  uint8_t frame[SV2_HEADER_SIZE + SV2_MAC_SIZE + SV2_PAYLOAD_MAX + SV2_MAC_SIZE];
+  uint8_t header[SV2_HEADER_SIZE] = { (uint8_t)extension, (uint8_t)(extension >> 8), msg_type,
+                                      (uint8_t)len, (uint8_t)(len >> 8), (uint8_t)(len >> 16) };
+  uint8_t nonce[12];
+  NoiseNonce(nonce, s.tx.nonce++);
+  chachapoly_seal(s.tx.key, nonce, NULL, 0, header, sizeof(header), frame);
+  size_t frame_len = SV2_HEADER_SIZE + SV2_MAC_SIZE;
+  if (len > 0)
+  {
+    NoiseNonce(nonce, s.tx.nonce++);
+    chachapoly_seal(s.tx.key, nonce, NULL, 0, payload, len, frame + frame_len);
+    frame_len += len + SV2_MAC_SIZE;
+  }
+  //Header and payload in one write, one segment
+  return Sv2Write(client, s, frame, frame_len);
+}
+
+bool sv2_read_frame(WiFiClient& client, sv2_session& s, const uint8_t*& payload, bool& error)
+{
+  error = false;
+  while (true)
+  {
+    size_t need = SV2_HEADER_SIZE + SV2_MAC_SIZE;
+    if (s.header_done)
+      need += Sv2EncryptedLength(s.msg_length);
+    if (s.frame_len < need)
+    {
+      int n = client.available() ? client.read(s.frame + s.frame_len, need - s.frame_len) : 0;
+      if (n <= 0)
+        return false;
+      s.frame_len += n;
+      s.rx_bytes += n;
+      if (s.frame_len < need)
+        return false;
+    }
+
+    uint8_t nonce[12];
+    if (!s.header_done)
+    {
+      uint8_t header[SV2_HEADER_SIZE];
+      NoiseNonce(nonce, s.rx.nonce++);
+      if (!chachapoly_open(s.rx.key, nonce, NULL, 0, s.frame, SV2_HEADER_SIZE + SV2_MAC_SIZE, header))
+      {
+        Serial.println("  [SV2] Frame header failed authentication");
+        error = true;
+        return false;
+      }
+      s.extension = header[0] | (header[1] << 8);
+      s.msg_type = header[2];
+      s.msg_length = header[3] | (header[4] << 8) | ((uint32_t)header[5] << 16);
+      if (s.msg_length > SV2_PAYLOAD_MAX)
+      {
+        Serial.printf("  [SV2] Message 0x%02x too long (%u bytes)\n", s.msg_type, s.msg_length);
+        error = true;
+        return false;
+      }
+      s.header_done = true;
+      if (s.msg_length > 0)
+        continue;
+    } else
+    {
+      uint8_t* data = s.frame + SV2_HEADER_SIZE + SV2_MAC_SIZE;
+      NoiseNonce(nonce, s.rx.nonce++);
+      if (!chachapoly_open(s.rx.key, nonce, NULL, 0, data, s.msg_length + SV2_MAC_SIZE, data))
+      {
+        Serial.println("  [SV2] Frame payload failed authentication");
+        error = true;
+        return false;
+      }
+    }
+    payload = s.frame + SV2_HEADER_SIZE + SV2_MAC_SIZE;
+    s.header_done = false;
+    s.frame_len = 0;
+    return true;
+  }
+}
+
+//Blocking read for the handshake
+static bool Sv2ReadExact(WiFiClient& client, sv2_session& s, uint8_t* data, size_t len, uint32_t timeout_ms)
+{
+  uint32_t start = millis();
+  size_t done = 0;
+  while (done < len)
+  {
+    if (!client.connected() || millis() - start > timeout_ms)
+      return false;
+    int n = client.available() ? client.read(data + done, len - done) : 0;
+    if (n > 0)
+    {
+      done += n;
+      s.rx_bytes += n;
+    } else
+      delay(1);
+  }
+  return true;
+}
+
+static bool Sv2WaitFrame(WiFiClient& client, sv2_session& s, const uint8_t*& payload, uint32_t timeout_ms)
+{
+  uint32_t start = millis();
+  bool error = false;
+  while (!sv2_read_frame(client, s, payload, error))
+  {
+    if (error || !client.connected() || millis() - start > timeout_ms)
+      return false;
+    delay(1);
+  }
+  return true;
+}
+
+//////////////////////////// Handshake ///////////////////////////////
+
+//Initiator: -> e, <- e, ee, s, es, certificate
+static bool Sv2Handshake(WiFiClient& client, sv2_session& s, const String& authority_key)
+{
+  uint8_t authority[32];
+  bool check_authority = authority_key.length() > 0;
+  if (check_authority && !AuthorityKeyDecode(authority_key, authority))
+  {
+    Serial.printf("  [SV2] Invalid authority key %s\n", authority_key.c_str());
+    return false;
+  }
+
+  noise_state st;
+  NoiseInit(st);
+  uint8_t e[32], e_ell[64];
+  if (!NoiseEphemeral(e, e_ell))
+    return false;
+  NoiseMixHash(st, e_ell, sizeof(e_ell));
+  NoiseMixHash(st, NULL, 0);  //Empty payload
+  if (!Sv2Write(client, s, e_ell, sizeof(e_ell)))
+    return false;
+
+  uint8_t act2[SV2_ACT2_SIZE];
+  if (!Sv2ReadExact(client, s, act2, sizeof(act2), SV2_HANDSHAKE_TIMEOUT_ms))
+  {
+    Serial.println("  [SV2] No handshake answer from pool");
+    return false;
+  }
+  const uint8_t* re = act2;
+  const uint8_t* enc_s = act2 + SV2_ELLSWIFT_SIZE;
+  const uint8_t* enc_cert = enc_s + SV2_ELLSWIFT_SIZE + SV2_MAC_SIZE;
+
+  uint8_t shared[32], rs[64], cert[SV2_CERT_SIZE];
+  NoiseMixHash(st, re, SV2_ELLSWIFT_SIZE);
+  bool ok = secp256k1_ellswift_xdh(shared, e_ell, re, e, false);
+  if (ok)
+    NoiseMixKey(st, shared);
+  ok = ok && NoiseDecryptAndHash(st, enc_s, SV2_ELLSWIFT_SIZE + SV2_MAC_SIZE, rs);
+  ok = ok && secp256k1_ellswift_xdh(shared, e_ell, rs, e, false);
+  if (ok)
+    NoiseMixKey(st, shared);
+  ok = ok && NoiseDecryptAndHash(st, enc_cert, SV2_CERT_SIZE + SV2_MAC_SIZE, cert);
+  memset(e, 0, sizeof(e));
+  memset(shared, 0, sizeof(shared));
+  if (!ok)
+  {
+    Serial.println("  [SV2] Handshake failed, pool answer doesn't authenticate");
+    return false;
+  }
+
+  uint32_t valid_from = cert[2] | (cert[3] << 8) | (cert[4] << 16) | ((uint32_t)cert[5] << 24);
+  uint32_t not_valid_after = cert[6] | (cert[7] << 8) | (cert[8] << 16) | ((uint32_t)cert[9] << 24);
+  if (check_authority)
+  {
+    uint8_t server_x[32], msg[32];
+    secp256k1_ellswift_decode(server_x, rs);
+    CertMessage(msg, cert, server_x);
+    if (!secp256k1_schnorr_verify(cert + 10, msg, authority))
+    {
+      Serial.println("  [SV2] Pool certificate not signed by the authority key");
+      return false;
+    }
+    //Validity only means something with a synced clock
+    uint32_t now = time(NULL);
+    if (now > 1600000000 && (now < valid_from || now > not_valid_after))
+    {
+      Serial.printf("  [SV2] Pool certificate out of its validity (%u..%u, now %u)\n", valid_from, not_valid_after, now);
+      return false;
+    }
+    Serial.println("  [SV2] Pool certificate checked");
+  } else
+    Serial.println("  [SV2] No authority key, pool certificate not checked");
+
+  NoiseSplit(st, s, true);
+  return true;
+}
+
+//Responder: <- e, -> e, ee, s, es, certificate
+bool sv2_accept(WiFiClient& client, sv2_session& s, const uint8_t static_key[32], const uint8_t authority_key[32],
+                uint32_t valid_from, uint32_t not_valid_after)
+{
+  sv2_session_init(s);
+  noise_state st;
+  NoiseInit(st);
+  uint8_t re[64];
+  if (!Sv2ReadExact(client, s, re, sizeof(re), SV2_HANDSHAKE_TIMEOUT_ms))
+    return false;
+  NoiseMixHash(st, re, sizeof(re));
+  NoiseMixHash(st, NULL, 0);
+
+  uint8_t e[32], shared[32], s_ell[64], rnd[32];
+  uint8_t act2[SV2_ACT2_SIZE];
+  if (!NoiseEphemeral(e, act2))
+    return false;
+  esp_fill_random(rnd, sizeof(rnd));
+  if (!secp256k1_ellswift_create(s_ell, static_key, rnd))
+    return false;
+  NoiseMixHash(st, act2, SV2_ELLSWIFT_SIZE);
+  if (!secp256k1_ellswift_xdh(shared, re, act2, e, true))
+    return false;
+  NoiseMixKey(st, shared);
+  NoiseEncryptAndHash(st, s_ell, sizeof(s_ell), act2 + SV2_ELLSWIFT_SIZE);
+  if (!secp256k1_ellswift_xdh(shared, re, s_ell, static_key, true))
+    return false;
+  NoiseMixKey(st, shared);
+
+  uint8_t cert[SV2_CERT_SIZE], server_x[32], msg[32];
+  Sv2Writer w(cert, sizeof(cert));
+  w.u16(0);
+  w.u32(valid_from);
+  w.u32(not_valid_after);
+  secp256k1_pubkey_xonly(server_x, static_key);
+  CertMessage(msg, cert, server_x);
+  esp_fill_random(rnd, sizeof(rnd));
+  if (!secp256k1_schnorr_sign(cert + 10, msg, authority_key, rnd))
+    return false;
+  NoiseEncryptAndHash(st, cert, sizeof(cert), act2 + 2 * SV2_ELLSWIFT_SIZE + SV2_MAC_SIZE);
+  memset(e, 0, sizeof(e));
+  memset(shared, 0, sizeof(shared));
+
+  if (!Sv2Write(client, s, act2, sizeof(act2)))
+    return false;
+  NoiseSplit(st, s, false);
+  return true;
+}
+
+//////////////////////////// Mining protocol ///////////////////////////////
+
+static sv2_event Sv2Handle(sv2_session& s, const uint8_t* payload, sv2_result& result)
+{
+  Sv2Reader r(payload, s.msg_length);
+  switch (s.msg_type)
+  {
+    case SV2_NEW_MINING_JOB: {
+      uint32_t channel_id = r.u32();
+      sv2_job job;
+      job.job_id = r.u32();
+      bool active = r.option_u32(job.min_ntime);
+      job.version = r.u32();
+      bool root_ok = r.b032(job.merkle_root) == 32;
+      if (!r.ok() || !root_ok || channel_id != s.channel_id)
+        return SV2_EVENT_OTHER;
+      if (!active)
+      {
+        //Future job, mined once SetNewPrevHash names it
+        if (s.future_count == SV2_FUTURE_JOBS)
+        {
+          memmove(&s.future[0], &s.future[1], sizeof(sv2_job) * (SV2_FUTURE_JOBS - 1));
+          s.future_count--;
+        }
+        s.future[s.future_count++] = job;
+        return SV2_EVENT_OTHER;
+      }
+      s.job = job;
+      s.job_valid = s.prev_hash_valid;
+      return s.job_valid ? SV2_EVENT_NEW_JOB : SV2_EVENT_OTHER;
+    }
+    case SV2_SET_NEW_PREV_HASH: {
+      uint32_t channel_id = r.u32();
+      uint32_t job_id = r.u32();
+      uint8_t prev_hash[32];
+      r.u256(prev_hash);
+      uint32_t min_ntime = r.u32();
+      uint32_t nbits = r.u32();
+      if (!r.ok() || channel_id != s.channel_id)
+        return SV2_EVENT_OTHER;
+      memcpy(s.prev_hash, prev_hash, 32);
+      s.min_ntime = min_ntime;
+      s.nbits = nbits;
+      s.prev_hash_valid = true;
+      //Jobs of the previous block are gone, mine the named one if we have it
+      s.job_valid = false;
+      for (int i = 0; i < s.future_count; ++i)
+        if (s.future[i].job_id == job_id)
+        {
+          s.job = s.future[i];
+          s.job.min_ntime = min_ntime;
+          s.job_valid = true;
+        }
+      s.future_count = 0;
+      if (!s.job_valid)
+        Serial.printf("  [SV2] SetNewPrevHash for unknown job %u\n", job_id);
+      return SV2_EVENT_NEW_JOB;
+    }
+    case SV2_SET_TARGET: {
+      uint32_t channel_id = r.u32();
+      uint8_t target[32];
+      r.u256(target);
+      if (!r.ok() || channel_id != s.channel_id)
+        return SV2_EVENT_OTHER;
+      memcpy(s.target, target, 32);
+      return SV2_EVENT_SET_TARGET;
+    }
+    case SV2_SUBMIT_SHARES_SUCCESS:
+      r.u32();
+      result.last_sequence = r.u32();
+      result.accepted_count = r.u32();
+      r.u64();
+      return r.ok() ? SV2_EVENT_SHARES_ACCEPTED : SV2_EVENT_OTHER;
+    case SV2_SUBMIT_SHARES_ERROR:
+      r.u32();
+      result.sequence = r.u32();
+      result.error = r.str();
+      return r.ok() ? SV2_EVENT_SHARE_REJECTED : SV2_EVENT_OTHER;
+    case SV2_SET_EXTRANONCE_PREFIX:
+      //The pool builds the merkle root of standard jobs, nothing to redo here
+      r.u32();
+      s.extranonce_prefix_len = r.b032(s.extranonce_prefix);
+      return SV2_EVENT_OTHER;
+    case SV2_UPDATE_CHANNEL_ERROR:
+      r.u32();
+      Serial.printf("  [SV2] UpdateChannel refused: %s\n", r.str().c_str());
+      return SV2_EVENT_OTHER;
+    case SV2_CLOSE_CHANNEL:
+      r.u32();
+      Serial.printf("  [SV2] Channel closed by pool: %s\n", r.str().c_str());
+      return SV2_EVENT_CLOSE;
+    case SV2_RECONNECT:
+      s.reconnect_host = r.str();
+      s.reconnect_port = r.u16();
+      return r.ok() ? SV2_EVENT_RECONNECT : SV2_EVENT_OTHER;
+    default:
+      Serial.printf("  [SV2] Message 0x%02x ignored\n", s.msg_type);
+      return SV2_EVENT_OTHER;
+  }
+}
+
+sv2_event sv2_poll(WiFiClient& client, sv2_session& s, sv2_result& result)
+{
+  const uint8_t* payload;
+  bool error;
+  if (!sv2_read_frame(client, s, payload, error))
+    return error ? SV2_EVENT_CLOSE : SV2_EVENT_NONE;
+  return Sv2Handle(s, payload, result);
+}
+
+//Wait for the answer to a request, handling what the pool pushes meanwhile
+static bool Sv2WaitAnswer(WiFiClient& client, sv2_session& s, uint8_t success, const uint8_t*& payload)
+{
+  sv2_result result;
+  while (Sv2WaitFrame(client, s, payload, SV2_HANDSHAKE_TIMEOUT_ms))
+  {
+    if (s.msg_type == success)
+      return true;
+    if (s.msg_type == SV2_SETUP_CONNECTION_ERROR || s.msg_type == SV2_OPEN_CHANNEL_ERROR)
+    {
+      Sv2Reader r(payload, s.msg_length);
+      r.u32();                      //flags or request_id
+      Serial.printf("  [SV2] Pool refused: %s\n", r.str().c_str());
+      return false;
+    }
+    Sv2Handle(s, payload, result);
+  }
+  return false;
+}
+
+bool sv2_connect(WiFiClient& client, sv2_session& s, const char* host, uint16_t port, const String& authority_key,
+                 const char* user, float nominal_hashrate)
+{
+  sv2_session_init(s);
+  Serial.printf("[WORKER] ==> SV2 handshake with %s:%u\n", host, port);
+  if (!Sv2Handshake(client, s, authority_key))
+    return false;
+
+  uint8_t payload[SV2_PAYLOAD_MAX];
+  const uint8_t* answer;
+  Sv2Writer w(payload, sizeof(payload));
+  w.u8(0);                          //Mining protocol
+  w.u16(2);                         //min_version
+  w.u16(2);                         //max_version
+  w.u32(SV2_REQUIRES_STANDARD_JOBS);
+  w.str(host);
+  w.u16(port);
+  w.str("NerdMiner");
+  w.str(SV2_HARDWARE);
+  w.str(CURRENT_VERSION);
+  w.str("");
+  if (!w.ok() || !sv2_send(client, s, 0, SV2_SETUP_CONNECTION, payload, w.length()) ||
+      !Sv2WaitAnswer(client, s, SV2_SETUP_CONNECTION_SUCCESS, answer))
+    return false;
+
+  Sv2Writer open(payload, sizeof(payload));
+  uint8_t max_target[32];
+  memset(max_target, 0xFF, sizeof(max_target));
+  open.u32(1);                      //request_id
+  open.str(user);
+  open.f32(nominal_hashrate);
+  open.u256(max_target);
+  if (!open.ok() || !sv2_send(client, s, 0, SV2_OPEN_STANDARD_CHANNEL, payload, open.length()) ||
+      !Sv2WaitAnswer(client, s, SV2_OPEN_STANDARD_CHANNEL_SUCCESS, answer))
+    return false;
+
+  Sv2Reader r(answer, s.msg_length);
+  r.u32();
+  s.channel_id = r.u32();
+  r.u256(s.target);
+  s.extranonce_prefix_len = r.b032(s.extranonce_prefix);
+  r.u32();                          //group_channel_id
+  if (!r.ok())
+    return false;
+  Serial.printf("  [SV2] Standard channel %u open, target difficulty %.6g\n", s.channel_id, diff_from_target(s.target));
+  return true;
+}
+
+void sv2_mining_data(const sv2_session& s, miner_data& mMiner)
+{
+  uint8_t* header = mMiner.bytearray_blockheader;
+  Sv2Writer w(header, 80);
+  w.u32(s.job.version);
+  w.u256(s.prev_hash);
+  w.u256(s.job.merkle_root);
+  w.u32(s.job.min_ntime);
+  w.u32(s.nbits);
+  w.u32(0);
+  target_from_nbits(s.nbits, mMiner.bytearray_target);
+}
+
+bool sv2_submit_share(WiFiClient& client, sv2_session& s, uint32_t nonce, uint32_t version, uint32_t& sequence)
+{
+  uint8_t payload[32];
+  Sv2Writer w(payload, sizeof(payload));
+  sequence = s.sequence++;
+  w.u32(s.channel_id);
+  w.u32(sequence);
+  w.u32(s.job.job_id);
+  w.u32(nonce);
+  w.u32(s.job.min_ntime);
+  w.u32(version);
+  return sv2_send(client, s, SV2_CHANNEL_BIT, SV2_SUBMIT_SHARES_STANDARD, payload, w.length());
+}
+
+bool sv2_update_channel(WiFiClient& client, sv2_session& s, float nominal_hashrate)
+{
+  uint8_t payload[48], max_target[32];
+  memset(max_target, 0xFF, sizeof(max_target));
+  Sv2Writer w(payload, sizeof(payload));
+  w.u32(s.channel_id);
+  w.f32(nominal_hashrate);
+  w.u256(max_target);
+  return sv2_send(client, s, SV2_CHANNEL_BIT, SV2_UPDATE_CHANNEL, payload, w.length());
+}
@@ -0,0 +1,200 @@
+/************************************************************************************
+*   Stratum V2 mining protocol client, standard channel (header only mining).
+*
+*   Selected by the pool URL scheme: stratum2+tcp://host[:port][/authority_key]
+*   The session is encrypted by a Noise NX handshake (secp256k1 ElligatorSwift keys,
+*   ChaCha20-Poly1305, SHA256). When the authority key (base58check, as printed by
+*   the pool) is given, the pool certificate signed by it is checked too.
+*
+*   The pool sends the merkle root of every job, so the client only builds the 80
+*   byte header from binary fields: no coinbase, no merkle branches, no hex or JSON.
+*   Jobs come as NewMiningJob (for the current block, or future ones activated by
+*   SetNewPrevHash), the share difficulty as SetTarget. Shares are acknowledged in
+*   batches by SubmitShares.Success.
+*
+*   Frames and handshake of both roles, the local test pool uses the server side.
+*************************************************************************************/
+#ifndef STRATUM_V2_H_
+#define STRATUM_V2_H_
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <stdint.h>
+#include "mining.h"
+
+#define SV2_URL_SCHEME              "stratum2+tcp://"
+#define SV2_HANDSHAKE_TIMEOUT_ms    5000
+#define SV2_PAYLOAD_MAX             1024    //Standard channel messages are far smaller, bigger frames close the session
+#define SV2_FUTURE_JOBS             4
+
+//Frame header: extension_type (bit 15 = channel message), msg_type, msg_length
+#define SV2_HEADER_SIZE             6
+#define SV2_MAC_SIZE                16
+#define SV2_ELLSWIFT_SIZE           64
+#define SV2_CERT_SIZE               74      //version, valid_from, not_valid_after, signature
+#define SV2_ACT2_SIZE               (SV2_ELLSWIFT_SIZE + SV2_ELLSWIFT_SIZE + SV2_MAC_SIZE + SV2_CERT_SIZE + SV2_MAC_SIZE)
+#define SV2_CHANNEL_BIT             0x8000
+
+//Common and mining protocol messages
+#define SV2_SETUP_CONNECTION                0x00
+#define SV2_SETUP_CONNECTION_SUCCESS        0x01
+#define SV2_SETUP_CONNECTION_ERROR          0x02
+#define SV2_OPEN_STANDARD_CHANNEL           0x10
+#define SV2_OPEN_STANDARD_CHANNEL_SUCCESS   0x11
+#define SV2_OPEN_CHANNEL_ERROR              0x12
+#define SV2_NEW_MINING_JOB                  0x15
+#define SV2_UPDATE_CHANNEL                  0x16
+#define SV2_UPDATE_CHANNEL_ERROR            0x17
+#define SV2_CLOSE_CHANNEL                   0x18
+#define SV2_SET_EXTRANONCE_PREFIX           0x19
+#define SV2_SUBMIT_SHARES_STANDARD          0x1a
+#define SV2_SUBMIT_SHARES_SUCCESS           0x1c
+#define SV2_SUBMIT_SHARES_ERROR             0x1d
+#define SV2_SET_NEW_PREV_HASH               0x20
+#define SV2_SET_TARGET                      0x21
+#define SV2_RECONNECT                       0x25
+
+//SetupConnection flags of the mining protocol
+#define SV2_REQUIRES_STANDARD_JOBS          0x01
+
+typedef struct {
+  uint8_t key[32];
+  uint64_t nonce;
+} sv2_cipher;
+
+typedef struct {
+  uint32_t job_id;
+  uint32_t version;
+  uint8_t merkle_root[32];
+  uint32_t min_ntime;       //Jobs for the current block only
+} sv2_job;
+
+typedef struct {
+  //Noise transport, after the handshake
+  sv2_cipher tx;
+  sv2_cipher rx;
+
+  //Frame being received: encrypted header, then the payload
+  uint8_t frame[SV2_HEADER_SIZE + SV2_MAC_SIZE + SV2_PAYLOAD_MAX + SV2_MAC_SIZE];
+  size_t frame_len;
+  bool header_done;
+  uint16_t extension;
+  uint8_t msg_type;
+  uint32_t msg_length;
+
+  //Standard channel
+  uint32_t channel_id;
+  uint8_t extranonce_prefix[32];
+  uint8_t extranonce_prefix_len;
+  uint8_t target[32];       //Little endian, like the hashes
+  uint32_t sequence;        //Next share sequence number
+
+  //Current block and the job mined on it
+  bool prev_hash_valid;
+  uint8_t prev_hash[32];    //Header byte order
+  uint32_t nbits;
+  uint32_t min_ntime;
+  bool job_valid;
+  sv2_job job;
+  sv2_job future[SV2_FUTURE_JOBS];
+  int future_count;
+
+  //Reconnect request
+  String reconnect_host;
+  uint16_t reconnect_port;
+
+  uint64_t rx_bytes;
+  uint64_t tx_bytes;
+} sv2_session;
+
+typedef enum {
+  SV2_EVENT_NONE,           //No complete message yet
+  SV2_EVENT_OTHER,          //Handled, nothing for the miner
+  SV2_EVENT_NEW_JOB,        //session.job (or its block) changed
+  SV2_EVENT_SET_TARGET,
+  SV2_EVENT_SHARES_ACCEPTED,
+  SV2_EVENT_SHARE_REJECTED,
+  SV2_EVENT_RECONNECT,
+  SV2_EVENT_CLOSE           //Channel closed or protocol error, drop the connection
+} sv2_event;
+
+typedef struct {
+  uint32_t last_sequence;   //SHARES_ACCEPTED: every share up to this one
+  uint32_t accepted_count;
+  uint32_t sequence;        //SHARE_REJECTED
+  String error;
+} sv2_result;
+
+//Serialization of the SV2 data types, little endian
+class Sv2Writer
+{
+public:
+  Sv2Writer(uint8_t* data, size_t size) : _data(data), _size(size), _len(0), _overflow(false) {}
+  void u8(uint8_t v) { bytes(&v, 1); }
+  void u16(uint16_t v) { uint8_t b[2] = { (uint8_t)v, (uint8_t)(v >> 8) }; bytes(b, 2); }
+  void u32(uint32_t v) { uint8_t b[4] = { (uint8_t)v, (uint8_t)(v >> 8), (uint8_t)(v >> 16), (uint8_t)(v >> 24) }; bytes(b, 4); }
+  void f32(float v) { uint32_t b; memcpy(&b, &v, 4); u32(b); }
+  void u256(const uint8_t* v) { bytes(v, 32); }
+  void str(const char* v) { size_t n = strlen(v); if (n > 255) n = 255; u8((uint8_t)n); bytes((const uint8_t*)v, n); }  //STR0_255
+  void b032(const uint8_t* v, size_t n) { if (n > 32) n = 32; u8((uint8_t)n); bytes(v, n); }                              //B0_32
+  void bytes(const uint8_t* v, size_t n) { if (_len + n > _size) { _overflow = true; return; } memcpy(_data + _len, v, n); _len += n; }
+  size_t length() const { return _len; }
+  bool ok() const { return !_overflow; }
+private:
+  uint8_t* _data;
+  size_t _size;
+  size_t _len;
+  bool _overflow;
+};
+
+class Sv2Reader
+{
+public:
+  Sv2Reader(const uint8_t* data, size_t size) : _data(data), _size(size), _pos(0), _error(false) {}
+  uint8_t u8() { uint8_t v = 0; bytes(&v, 1); return v; }
+  uint16_t u16() { uint8_t b[2] = { 0 }; bytes(b, 2); return b[0] | (b[1] << 8); }
+  uint32_t u32() { uint8_t b[4] = { 0 }; bytes(b, 4); return b[0] | (b[1] << 8) | (b[2] << 16) | ((uint32_t)b[3] << 24); }
+  float f32() { uint32_t b = u32(); float v; memcpy(&v, &b, 4); return v; }
+  uint64_t u64() { uint64_t lo = u32(); return lo | ((uint64_t)u32() << 32); }
+  void u256(uint8_t* v) { bytes(v, 32); }
+  String str() { uint8_t n = u8(); String s; for (uint8_t i = 0; i < n && !_error; ++i) s += (char)u8(); return s; }
+  size_t b032(uint8_t* v) { uint8_t n = u8(); if (n > 32) { _error = true; return 0; } bytes(v, n); return n; }
+  bool option_u32(uint32_t &v) { uint8_t n = u8(); if (n == 0) return false; v = u32(); return true; }  //OPTION[u32]
+  void bytes(uint8_t* v, size_t n) { if (_pos + n > _size) { _error = true; return; } memcpy(v, _data + _pos, n); _pos += n; }
+  bool ok() const { return !_error; }
+private:
+  const uint8_t* _data;
+  size_t _size;
+  size_t _pos;
+  bool _error;
+};
+
+//Pool URL: true when it has the SV2 scheme, host and authority key (may be empty) split out
+bool sv2_parse_url(const String& url, String& host, String& authority_key);
+
+//Client: handshake, SetupConnection and OpenStandardMiningChannel, blocking
+bool sv2_connect(WiFiClient& client, sv2_session& s, const char* host, uint16_t port, const String& authority_key,
+                 const char* user, float nominal_hashrate);
+
+//Next pool message, non blocking. Keeps the session state (jobs, target) current.
+sv2_event sv2_poll(WiFiClient& client, sv2_session& s, sv2_result& result);
+
+//Header of session.job, target of its nbits
+void sv2_mining_data(const sv2_session& s, miner_data& mMiner);
+
+//Share of session.job, sequence is the id of the acknowledgement
+bool sv2_submit_share(WiFiClient& client, sv2_session& s, uint32_t nonce, uint32_t version, uint32_t& sequence);
+bool sv2_update_channel(WiFiClient& client, sv2_session& s, float nominal_hashrate);
+
+//Both roles: one encrypted frame, and the next complete one received (false while partial)
+bool sv2_send(WiFiClient& client, sv2_session& s, uint16_t extension, uint8_t msg_type, const uint8_t* payload, size_t len);
+bool sv2_read_frame(WiFiClient& client, sv2_session& s, const uint8_t*& payload, bool& error);
+
+//Server: responder side of the handshake, the certificate signed by the authority key
+bool sv2_accept(WiFiClient& client, sv2_session& s, const uint8_t static_key[32], const uint8_t authority_key[32],
+                uint32_t valid_from, uint32_t not_valid_after);
+String sv2_authority_key_encode(const uint8_t xonly[32]);
+
+void sv2_session_init(sv2_session& s);
+
+#endif // STRATUM_V2_H_
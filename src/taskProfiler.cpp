@@ -0,0 +1,166 @@
+#ifdef TASK_PROFILER
+
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include "taskProfiler.h"
+
+#define PROFILER_STACK_LOW    512     //Bytes, flagged in the list
+
+//Counters of the previous "tasks", the CPU share is the difference
+typedef struct {
+  TaskHandle_t task;
+  uint32_t run_time;
+} profiler_count;
+
+static profiler_count s_previous[PROFILER_TASKS];
+static uint32_t s_previous_total = 0;
+static uint32_t s_previous_ms = 0;
+
+#if configGENERATE_RUN_TIME_STATS
+
+void profiler_setup(void)
+{
+}
+
+static uint32_t ProfilerRunTime(const TaskStatus_t& status)
+{
+  return status.ulRunTimeCounter;
+}
+
+#else
+
+//The SDK is built without run time counters, sample the running tasks instead
+static TaskHandle_t volatile s_sampled[PROFILER_TASKS];
+static volatile uint32_t s_samples[PROFILER_TASKS];
+static volatile uint32_t s_sample_ticks = 0;
+static hw_timer_t* s_timer = NULL;
+
+static void IRAM_ATTR ProfilerSample(void)
+{
+  s_sample_ticks++;
+  for (int core = 0; core < portNUM_PROCESSORS; ++core)
+  {
+    TaskHandle_t task = xTaskGetCurrentTaskHandleForCPU(core);
+    for (int i = 0; i < PROFILER_TASKS; ++i)
+    {
+      if (s_sampled[i] == task)
+      {
+        s_samples[i]++;
+        break;
+      }
+      if (s_sampled[i] == NULL)
+      {
+        s_samples[i] = 1;
+        s_sampled[i] = task;
+        break;
+      }
+    }
+  }
+}
+
+void profiler_setup(void)
+{
+  //1MHz counter
+  s_timer = timerBegin(PROFILER_TIMER, getApbFrequency() / 1000000, true);
+  if (s_timer == NULL)
+  {
+    Serial.println("Task profiler: no hardware timer, CPU share not available");
+    return;
+  }
+  timerAttachInterrupt(s_timer, ProfilerSample, true);
+  timerAlarmWrite(s_timer, 1000000 / PROFILER_SAMPLE_HZ, true);
+  timerAlarmEnable(s_timer);
+}
+
+static uint32_t ProfilerRunTime(const TaskStatus_t& status)
+{
+  for (int i = 0; i < PROFILER_TASKS; ++i)
+    if (s_sampled[i] == status.xHandle)
+      return s_samples[i];
+  return 0;
+}
+
+#endif // configGENERATE_RUN_TIME_STATS
+
+void profiler_tasks_command(const char* args)
+{
+  static TaskStatus_t tasks[PROFILER_TASKS];
+  uint32_t total = 0;
+  UBaseType_t count = uxTaskGetSystemState(tasks, PROFILER_TASKS, &total);
+  if (count == 0)
+  {
+    Serial.printf("[TASKS] more than %d tasks, raise PROFILER_TASKS\n", PROFILER_TASKS);
+    return;
+  }
+#if !configGENERATE_RUN_TIME_STATS
+  total = s_sample_ticks;
+#endif
+
+  //Share of one core since the previous list
+  uint32_t elapsed = total - s_previous_total;
+  float cpu[PROFILER_TASKS];
+  uint8_t order[PROFILER_TASKS];
+  for (UBaseType_t i = 0; i < count; ++i)
+  {
+    uint32_t run_time = ProfilerRunTime(tasks[i]);
+    uint32_t previous = 0;
+    for (const profiler_count& counted : s_previous)
+      if (counted.task == tasks[i].xHandle)
+        previous = counted.run_time;
+    cpu[i] = elapsed ? 100.0f * (run_time - previous) / elapsed : 0.0f;
+
+    //Busiest first
+    UBaseType_t j = i;
+    for (; j > 0 && cpu[order[j - 1]] < cpu[i]; --j)
+      order[j] = order[j - 1];
+    order[j] = i;
+  }
+
+  uint32_t now = millis();
+  Serial.printf("[TASKS] %u tasks, CPU %% of one core over the last %.1fs\n", (unsigned)count, (now - s_previous_ms) / 1000.0f);
+  Serial.println("  Task              Core  Prio    CPU%  Min free stack");
+  for (UBaseType_t n = 0; n < count; ++n)
+  {
+    const TaskStatus_t& task = tasks[order[n]];
+    char core[4] = "-";
+    BaseType_t affinity = xTaskGetAffinity(task.xHandle);
+    if (affinity != tskNO_AFFINITY)
+      snprintf(core, sizeof(core), "%d", (int)affinity);
+    //No task runs with 0 bytes left, the host doesn't know the stacks
+    char stack[16] = "-";
+    if (task.usStackHighWaterMark > 0)
+      snprintf(stack, sizeof(stack), "%u%s", (unsigned)task.usStackHighWaterMark, task.usStackHighWaterMark < PROFILER_STACK_LOW ? " low" : "");
+    Serial.printf("  %-16s %5s %5u  %6.1f  %8s\n", task.pcTaskName, core, (unsigned)task.uxCurrentPriority, cpu[order[n]], stack);
+  }
+
+  memset(s_previous, 0, sizeof(s_previous));
+  for (UBaseType_t i = 0; i < count; ++i)
+  {
+    s_previous[i].task = tasks[i].xHandle;
+    s_previous[i].run_time = ProfilerRunTime(tasks[i]);
+  }
+  s_previous_total = total;
+  s_previous_ms = now;
+}
+
+static void HeapPrint(const char* name, uint32_t caps)
+{
+  size_t size = heap_caps_get_total_size(caps);
+  if (size == 0)
+  {
+    Serial.printf("  %-9s not present\n", name);
+    return;
+  }
+  Serial.printf("  %-9s %8u %8u %8u %8u\n", name, (unsigned)size, (unsigned)heap_caps_get_free_size(caps),
+                (unsigned)heap_caps_get_minimum_free_size(caps), (unsigned)heap_caps_get_largest_free_block(caps));
+}
+
+void profiler_heap_command(const char* args)
+{
+  Serial.println("[HEAP] bytes      Total     Free Min free  Largest");
+  HeapPrint("Internal", MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  HeapPrint("DMA", MALLOC_CAP_DMA);
+  HeapPrint("PSRAM", MALLOC_CAP_SPIRAM);
+}
+
+#endif // TASK_PROFILER
@@ -0,0 +1,41 @@
+#ifndef TASK_PROFILER_H
+#define TASK_PROFILER_H
+
+#include <Arduino.h>
+
+/************************************************************************************
+*   Task and heap profiler, to size the task stacks from measures.
+*
+*   "tasks" lists every FreeRTOS task: CPU share since the previous "tasks" (of one
+*   core, the idle tasks show what is left), minimum free stack since boot, core
+*   affinity and priority. The CPU share comes from the FreeRTOS run time counters
+*   when the SDK keeps them (configGENERATE_RUN_TIME_STATS), otherwise a hardware
+*   timer samples the task running on each core PROFILER_SAMPLE_HZ times a second.
+*
+*   "heap" shows the heap by capability (internal, DMA capable, PSRAM): total, free,
+*   minimum free since boot and largest free block.
+*
+*   Build with -D TASK_PROFILER
+*************************************************************************************/
+
+#ifdef TASK_PROFILER
+
+#define PROFILER_TASKS        24
+#ifndef PROFILER_SAMPLE_HZ
+#define PROFILER_SAMPLE_HZ    1000
+#endif
+#ifndef PROFILER_TIMER
+#define PROFILER_TIMER        1       //Hardware timer of the sampler, C3 and S3 have 0 and 1
+#endif
+
+//Starts the sampler when the run time counters are missing, from the task whose
+//core takes the timer interrupt
+void profiler_setup(void);
+
+//Serial console "tasks" and "heap"
+void profiler_tasks_command(const char* args);
+void profiler_heap_command(const char* args);
+
+#endif // TASK_PROFILER
+
+#endif // TASK_PROFILER_H
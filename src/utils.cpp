@@ -4,6 +4,7 @@
 #include "mining.h"
 #include "stratum.h"
 #include "mbedtls/sha256.h"
+#include "logger.h"
 
 #include <string.h>
 #include <stdio.h>
@@ -23,6 +24,17 @@ uint32_t swab32(uint32_t v) {
     return bswap_32(v);
 }
 
+//Lowercase hex of data into out (2 * size + 1 chars)
+const char* to_hex_string(const uint8_t* data, size_t size, char* out) {
+    static const char digits[] = "0123456789abcdef";
+    for (size_t i = 0; i < size; i++) {
+        out[2 * i] = digits[data[i] >> 4];
+        out[2 * i + 1] = digits[data[i] & 0x0F];
+    }
+    out[2 * size] = 0;
+    return out;
+}
+
 uint8_t hex(char ch) {
     uint8_t r = (ch > 57) ? (ch - 55) : (ch - 48);
     return r & 0x0F;
@@ -123,25 +135,19 @@ bool isSha256Valid(const void* sha256)
 
 
 bool checkValid(unsigned char* hash, unsigned char* target) {
+  //Both little endian (calculateMiningData swaps the target), compare from the most significant byte
   bool valid = true;
-  unsigned char diff_target[32];
-  memcpy(diff_target, &target, 32);
-  //convert target to little endian for comparison
-  reverse_bytes(diff_target, 32);
-
-  for(uint8_t i=31; i>=0; i--) {
-    if(hash[i] > diff_target[i]) {
-      valid = false;
+  for(int i=31; i>=0; i--) {
+    if(hash[i] != target[i]) {
+      valid = hash[i] < target[i];
       break;
     }
   }
 
-  #ifdef DEBUG_MINING
+  #if LOGGER_LEVEL >= LOGGER_DEBUG
   if (valid) {
-    Serial.print("\tvalid : ");
-    for (size_t i = 0; i < 32; i++)
-        Serial.printf("%02x ", hash[i]);
-    Serial.println();
+    char hash_hex[65];
+    LOG_D("\tvalid : %s\n", to_hex_string(hash, 32, hash_hex));
   }
   #endif
   return valid;
@@ -180,6 +186,20 @@ void getNextExtranonce2(int extranonce2_size, char *extranonce2) {
   sprintf(extranonce2, format, extranonce2_number);
 }
 
+//Compact nbits to the 256 bit target, little endian like the hashes: mantissa (3 bytes)
+//followed by exponent-3 zero bytes
+void target_from_nbits(uint32_t nbits, uint8_t* target)
+{
+  memset(target, 0, 32);
+  int exponent = nbits >> 24;
+  for (int i = 0; i < 3; ++i)
+  {
+    int pos = exponent - 3 + i;
+    if (pos >= 0 && pos < 32)
+      target[pos] = (nbits >> (8 * i)) & 0xFF;
+  }
+}
+
 miner_data init_miner_data(void){
   
   miner_data newMinerData; 
@@ -191,37 +211,37 @@ miner_data calculateMiningData(mining_subscribe& mWorker, mining_job mJob){
   miner_data mMiner = init_miner_data();
 
   // calculate target - target = (nbits[2:]+'00'*(int(nbits[:2],16) - 3)).zfill(64)
-    
-    char target[TARGET_BUFFER_SIZE+1];
-    memset(target, '0', TARGET_BUFFER_SIZE);
-    int zeros = (int) strtol(mJob.nbits.substring(0, 2).c_str(), 0, 16) - 3;
-    memcpy(target + zeros - 2, mJob.nbits.substring(2).c_str(), mJob.nbits.length() - 2);
-    target[TARGET_BUFFER_SIZE] = 0;
-    Serial.print("    target: "); Serial.println(target);
-    
-    // bytearray target
-    size_t size_target = to_byte_array(target, 32, mMiner.bytearray_target);
-
-    for (size_t j = 0; j < 8; j++) {
-      mMiner.bytearray_target[j] ^= mMiner.bytearray_target[size_target - 1 - j];
-      mMiner.bytearray_target[size_target - 1 - j] ^= mMiner.bytearray_target[j];
-      mMiner.bytearray_target[j] ^= mMiner.bytearray_target[size_target - 1 - j];
-    }
+    target_from_nbits(strtoul(mJob.nbits.c_str(), NULL, 16), mMiner.bytearray_target);
+    char target_hex[65];
+    for (int i = 0; i < 32; ++i)
+      snprintf(&target_hex[i*2], 3, "%02x", mMiner.bytearray_target[31 - i]);
+    LOG_I("    target: %s\n", target_hex);
 
     // get extranonce2 - extranonce2 = hex(random.randint(0,2**32-1))[2:].zfill(2*extranonce2_size)
     //To review
     //char extranonce2_char[2 * mWorker.extranonce2_size+1];	
 	//mWorker.extranonce2.toCharArray(extranonce2_char, 2 * mWorker.extranonce2_size + 1);
     //getNextExtranonce2(mWorker.extranonce2_size, extranonce2_char);
-    if (mWorker.extranonce2_size == 2)
+    //An extranonce2 of the right size is kept, the local proxy checks shares of other extranonce2
+    if (mWorker.extranonce2.length() == 2 * mWorker.extranonce2_size && mWorker.extranonce2_size > 0)
+        ;
+    else if (mWorker.extranonce2_size == 2)
         mWorker.extranonce2 = "0001";
     else if (mWorker.extranonce2_size == 4)
         mWorker.extranonce2 = "00000001";
     else if (mWorker.extranonce2_size == 8)
         mWorker.extranonce2 = "0000000000000001";
+    else if (mWorker.extranonce2_size > 0 && mWorker.extranonce2_size <= 16)
+    {
+        //Proxies hand out odd sizes (pool size minus their own slice)
+        mWorker.extranonce2 = "";
+        for (int i = 1; i < mWorker.extranonce2_size; i++)
+            mWorker.extranonce2 += "00";
+        mWorker.extranonce2 += "01";
+    }
     else
     {
-        Serial.println("Unknown extranonce2");
+        LOG_W("Unknown extranonce2\n");
         mWorker.extranonce2 = "00000001";
     }
     //mWorker.extranonce2 = "00000002";
@@ -232,20 +252,15 @@ miner_data calculateMiningData(mining_subscribe& mWorker, mining_job mJob){
     snprintf(coinbase_buffer, sizeof(coinbase_buffer), "%s%s%s%s", 
              mJob.coinb1.c_str(), mWorker.extranonce1.c_str(), 
              mWorker.extranonce2.c_str(), mJob.coinb2.c_str());
-    Serial.print("    coinbase: "); Serial.println(coinbase_buffer);
+    LOG_I("    coinbase: %s\n", coinbase_buffer);
     size_t str_len = strlen(coinbase_buffer)/2;
     uint8_t bytearray[str_len];
 
     size_t res = to_byte_array(coinbase_buffer, str_len*2, bytearray);
 
-    #ifdef DEBUG_MINING
-    Serial.print("    extranonce2: "); Serial.println(mWorker.extranonce2);
-    Serial.print("    coinbase: "); Serial.println(coinbase_buffer);
-    Serial.print("    coinbase bytes - size: "); Serial.println(res);
-    for (size_t i = 0; i < res; i++)
-        Serial.printf("%02x", bytearray[i]);
-    Serial.println("---");
-    #endif
+    LOG_D("    extranonce2: %s\n", mWorker.extranonce2.c_str());
+    LOG_D("    coinbase: %s\n", coinbase_buffer);
+    LOG_D("    coinbase bytes - size: %u\n", (unsigned int)res);
 
     mbedtls_sha256_context ctx;
     mbedtls_sha256_init(&ctx);
@@ -262,11 +277,9 @@ miner_data calculateMiningData(mining_subscribe& mWorker, mining_job mJob){
     mbedtls_sha256_finish_ret(&ctx, shaResult);
     mbedtls_sha256_free(&ctx);
 
-    #ifdef DEBUG_MINING
-    Serial.print("    coinbase double sha: ");
-    for (size_t i = 0; i < 32; i++)
-        Serial.printf("%02x", shaResult[i]);
-    Serial.println("");
+    #if LOGGER_LEVEL >= LOGGER_DEBUG
+    char sha_hex[65];
+    LOG_D("    coinbase double sha: %s\n", to_hex_string(shaResult, 32, sha_hex));
     #endif
 
     
@@ -275,24 +288,19 @@ miner_data calculateMiningData(mining_subscribe& mWorker, mining_job mJob){
     
     byte merkle_concatenated[32 * 2];
     for (size_t k=0; k < mJob.merkle_branch.size(); k++) {
-        const char* merkle_element = (const char*) mJob.merkle_branch[k];
+        const char* merkle_element = mJob.merkle_branch[k].c_str();
         uint8_t bytearray[32];
         size_t res = to_byte_array(merkle_element, 64, bytearray);
 
-        #ifdef DEBUG_MINING
-        Serial.print("    merkle element    "); Serial.print(k); Serial.print(": "); Serial.println(merkle_element);
-        #endif
+        LOG_D("    merkle element    %u: %s\n", (unsigned int)k, merkle_element);
         for (size_t i = 0; i < 32; i++) {
           merkle_concatenated[i] = mMiner.merkle_result[i];
           merkle_concatenated[32 + i] = bytearray[i];
         }
 
-        #ifdef DEBUG_MINING
-        Serial.print("    merkle element    "); Serial.print(k); Serial.print(": "); Serial.println(merkle_element);
-        Serial.print("    merkle concatenated: ");
-        for (size_t i = 0; i < 64; i++)
-            Serial.printf("%02x", merkle_concatenated[i]);
-        Serial.println("");
+        #if LOGGER_LEVEL >= LOGGER_DEBUG
+        char concatenated_hex[129];
+        LOG_D("    merkle concatenated: %s\n", to_hex_string(merkle_concatenated, 64, concatenated_hex));
         #endif
 
         mbedtls_sha256_context ctx;
@@ -306,23 +314,16 @@ miner_data calculateMiningData(mining_subscribe& mWorker, mining_job mJob){
         mbedtls_sha256_finish_ret(&ctx, mMiner.merkle_result);
         mbedtls_sha256_free(&ctx);
 
-        #ifdef DEBUG_MINING
-        Serial.print("    merkle sha         : ");
-        for (size_t i = 0; i < 32; i++)
-            Serial.printf("%02x", mMiner.merkle_result[i]);
-        Serial.println("");
+        #if LOGGER_LEVEL >= LOGGER_DEBUG
+        char merkle_hex[65];
+        LOG_D("    merkle sha         : %s\n", to_hex_string(mMiner.merkle_result, 32, merkle_hex));
         #endif
     }
     // merkle root from merkle_result
     
-    Serial.print("    merkle sha         : ");
     char merkle_root[65];
-    for (int i = 0; i < 32; i++) {
-      Serial.printf("%02x", mMiner.merkle_result[i]);
-      snprintf(&merkle_root[i*2], 3, "%02x", mMiner.merkle_result[i]);
-    }
-    merkle_root[65] = 0;
-    Serial.println("");
+    to_hex_string(mMiner.merkle_result, 32, merkle_root);
+    LOG_I("    merkle sha         : %s\n", merkle_root);
 
     // calculate blockheader
     // j.block_header = ''.join([j.version, j.prevhash, merkle_root, j.ntime, j.nbits])
@@ -332,10 +333,8 @@ miner_data calculateMiningData(mining_subscribe& mWorker, mining_job mJob){
     //uint8_t bytearray_blockheader[str_len];
     res = to_byte_array(blockheader.c_str(), str_len*2, mMiner.bytearray_blockheader);
 
-    #ifdef DEBUG_MINING
-    Serial.println("    blockheader: "); Serial.print(blockheader);
-    Serial.println("    blockheader bytes "); Serial.print(str_len); Serial.print(" -> ");
-    #endif
+    LOG_D("    blockheader: %s\n", blockheader.c_str());
+    LOG_D("    blockheader bytes %u\n", (unsigned int)str_len);
 
     // reverse version
     uint8_t buff;
@@ -394,44 +393,40 @@ miner_data calculateMiningData(mining_subscribe& mWorker, mining_job mJob){
     }
 
 
-    #ifdef DEBUG_MINING
-    Serial.print(" >>> bytearray_blockheader     : "); 
-    for (size_t i = 0; i < 4; i++)
-        Serial.printf("%02x", mMiner.bytearray_blockheader[i]);
-    Serial.println("");
-    Serial.print("version     ");
-    for (size_t i = 0; i < 4; i++)
-        Serial.printf("%02x", mMiner.bytearray_blockheader[i]);
-    Serial.println("");
-    Serial.print("prev hash   ");
-    for (size_t i = 4; i < 4+32; i++)
-        Serial.printf("%02x", mMiner.bytearray_blockheader[i]);
-    Serial.println("");
-    Serial.print("merkle root ");
-    for (size_t i = 36; i < 36+32; i++)
-        Serial.printf("%02x", mMiner.bytearray_blockheader[i]);
-    Serial.println("");
-    Serial.print("ntime       ");
-    for (size_t i = 68; i < 68+4; i++)
-        Serial.printf("%02x", mMiner.bytearray_blockheader[i]);
-    Serial.println("");
-    Serial.print("nbits       ");
-    for (size_t i = 72; i < 72+4; i++)
-        Serial.printf("%02x", mMiner.bytearray_blockheader[i]);
-    Serial.println("");
-    Serial.print("nonce       ");
-    for (size_t i = 76; i < 76+4; i++)
-        Serial.printf("%02x", mMiner.bytearray_blockheader[i]);
-    Serial.println("");
-    Serial.println("bytearray_blockheader: ");
-    for (size_t i = 0; i < str_len; i++) {
-      Serial.printf("%02x", mMiner.bytearray_blockheader[i]);
-    }
-    Serial.println("");
+    #if LOGGER_LEVEL >= LOGGER_DEBUG
+    char header_hex[2 * 80 + 1];
+    LOG_D("version     %s\n", to_hex_string(&mMiner.bytearray_blockheader[0], 4, header_hex));
+    LOG_D("prev hash   %s\n", to_hex_string(&mMiner.bytearray_blockheader[4], 32, header_hex));
+    LOG_D("merkle root %s\n", to_hex_string(&mMiner.bytearray_blockheader[36], 32, header_hex));
+    LOG_D("ntime       %s\n", to_hex_string(&mMiner.bytearray_blockheader[68], 4, header_hex));
+    LOG_D("nbits       %s\n", to_hex_string(&mMiner.bytearray_blockheader[72], 4, header_hex));
+    LOG_D("nonce       %s\n", to_hex_string(&mMiner.bytearray_blockheader[76], 4, header_hex));
+    LOG_D("bytearray_blockheader: %s\n", to_hex_string(mMiner.bytearray_blockheader, 80, header_hex));
     #endif
   return mMiner;
 }
 
+//Difficulty of a share submitted against job, extranonce2 is the full one of the submit
+double calculateShareDifficulty(const String& extranonce1, int extranonce2_size, const mining_job& job, const mining_submit& submit,
+                                uint32_t version_mask, uint8_t* hash)
+{
+  mining_subscribe worker = init_mining_subscribe();
+  worker.extranonce1 = extranonce1;
+  worker.extranonce2 = submit.extranonce2;
+  worker.extranonce2_size = extranonce2_size;
+  miner_data data = calculateMiningData(worker, job);
+
+  uint32_t* header = (uint32_t*)data.bytearray_blockheader;
+  header[0] = (header[0] & ~version_mask) | (submit.version_bits & version_mask);
+  header[17] = strtoul(submit.ntime.c_str(), NULL, 16);
+  header[19] = strtoul(submit.nonce.c_str(), NULL, 16);
+
+  uint8_t inter[32];
+  mbedtls_sha256_ret(data.bytearray_blockheader, 80, inter, 0);
+  mbedtls_sha256_ret(inter, 32, hash, 0);
+  return diff_from_target(hash);
+}
+
 /* Convert a double value into a truncated string for displaying with its
  * associated suitable for Mega, Giga etc. Buf array needs to be long enough */
 void suffix_string(double val, char *buf, size_t bufsiz, int sigdigits)
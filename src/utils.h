@@ -18,11 +18,15 @@
 uint8_t hex(char ch);
 
 int to_byte_array(const char *in, size_t in_size, uint8_t *out);
+const char* to_hex_string(const uint8_t* data, size_t size, char* out);
 double le256todouble(const void *target);
 double diff_from_target(void *target);
 bool isSha256Valid(const void* sha256);
 miner_data calculateMiningData(mining_subscribe& mWorker, mining_job mJob);
+double calculateShareDifficulty(const String& extranonce1, int extranonce2_size, const mining_job& job, const mining_submit& submit,
+                                uint32_t version_mask, uint8_t* hash);
 bool checkValid(unsigned char* hash, unsigned char* target);
+void target_from_nbits(uint32_t nbits, uint8_t* target);
 void suffix_string(double val, char *buf, size_t bufsiz, int sigdigits);
 
 uint32_t crc32_reset();
@@ -213,6 +213,9 @@ void init_WifiManager()
     // Text box (Number) - 7 characters maximum
     WiFiManagerParameter port_text_box_num("Poolport", "Pool port", convertedValue, 7);
 
+    // Text box (String) - 160 characters maximum
+    WiFiManagerParameter backup_text_box("Backuppools", "Backup pools (host:port, comma separated) - Optional", Settings.BackupPools.c_str(), 160);
+
     // Text box (String) - 80 characters maximum
     //WiFiManagerParameter password_text_box("Poolpassword", "Pool password (Optional)", Settings.PoolPassword, 80);
 
@@ -238,6 +241,7 @@ void init_WifiManager()
   // Add all defined parameters
   wm.addParameter(&pool_text_box);
   wm.addParameter(&port_text_box_num);
+  wm.addParameter(&backup_text_box);
   wm.addParameter(&password_text_box);
   wm.addParameter(&addr_text_box);
   wm.addParameter(&time_text_box_num);
@@ -276,6 +280,7 @@ void init_WifiManager()
             Serial.println("failed to connect and hit timeout");
             Settings.PoolAddress = pool_text_box.getValue();
             Settings.PoolPort = atoi(port_text_box_num.getValue());
+            Settings.BackupPools = backup_text_box.getValue();
             strncpy(Settings.PoolPassword, password_text_box.getValue(), sizeof(Settings.PoolPassword));
             strncpy(Settings.BtcWallet, addr_text_box.getValue(), sizeof(Settings.BtcWallet));
             Settings.Timezone = atoi(time_text_box_num.getValue());
@@ -309,6 +314,8 @@ void init_WifiManager()
                 // Save new config            
                 Settings.PoolAddress = pool_text_box.getValue();
                 Settings.PoolPort = atoi(port_text_box_num.getValue());
+                Settings.BackupPools = backup_text_box.getValue();
+            Settings.BackupPools = backup_text_box.getValue();
                 strncpy(Settings.PoolPassword, password_text_box.getValue(), sizeof(Settings.PoolPassword));
                 strncpy(Settings.BtcWallet, addr_text_box.getValue(), sizeof(Settings.BtcWallet));
                 Settings.Timezone = atoi(time_text_box_num.getValue());
@@ -349,6 +356,11 @@ void init_WifiManager()
         Serial.print("portNumber: ");
         Serial.println(Settings.PoolPort);
 
+        // Copy the string value
+        Settings.BackupPools = backup_text_box.getValue();
+        Serial.print("backupPools: ");
+        Serial.println(Settings.BackupPools);
+
         // Copy the string value
         strncpy(Settings.PoolPassword, password_text_box.getValue(), sizeof(Settings.PoolPassword));
         Serial.print("poolPassword: ");
@@ -391,6 +403,11 @@ void init_WifiManager()
     Serial.print("portNumber: ");
     Serial.println(Settings.PoolPort);
 
+    // Copy the string value
+    Settings.BackupPools = backup_text_box.getValue();
+    Serial.print("backupPools: ");
+    Serial.println(Settings.BackupPools);
+
     // Copy the string value
     strncpy(Settings.PoolPassword, password_text_box.getValue(), sizeof(Settings.PoolPassword));
     Serial.print("poolPassword: ");